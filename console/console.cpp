@@ -94,6 +94,10 @@ int main(int argc, const char *argv[]) {
     Array2D<float>    river_mask;
     ImageIO           image_io;
     ModelIO           model_io;
+    // Shared executor writes output files while modules go on.
+    IOExecutor        io_executor;
+    image_io.SetExecutor(&io_executor);
+    model_io.SetExecutor(&io_executor);
 
     // Link data to modules.
     basis_module.height_map_        = &height_map;
@@ -140,6 +144,9 @@ int main(int argc, const char *argv[]) {
     logger.AddLogWriter(&file_log_writer);
     logger.AddLogWriter(&stdout_log_writer);
     generator.SetLogger(&logger);
+    // Generator waits for files after the last module and reports write
+    // errors as errors of module that saved file.
+    generator.SetIOExecutor(&io_executor);
 
     // There is unlimited count of modules that can be attached to generator's
     // pipeline. Order of addition is significant and describes steps order.
@@ -175,9 +182,22 @@ int main(int argc, const char *argv[]) {
     generator.LoadSettings(config_filename);
     // After that settings can be overwritten using API. In that example
     // there is no need to change them.
+    const size_t kMegabyte = 1 << 20;
+    const auto& io = system_settings.io;
+    io_executor.Start(io.thread_count, io.queue_size,
+                      static_cast<size_t>(io.memory_budget) * kMegabyte);
+    // Big maps are stored in temporary files, so world can be bigger than
+    // physical memory.
+    const auto& storage = system_settings.storage;
+    MappedBufferParams storage_params;
+    storage_params.threshold =
+        static_cast<size_t>(storage.mapped_threshold) * kMegabyte;
+    storage_params.directory = storage.directory;
+    storage_params.huge_pages = storage.huge_pages;
+    MappedBuffer::SetParams(storage_params);
 
     // Launch generator pipeline.
-    bool success = generator.Generate();
+    const bool success = generator.Generate();
 
     return !success;
 }
@@ -1,7 +1,9 @@
 #include "generator.h"
 
 #include <chrono>
+#include <exception>
 #include <fstream>
+#include <new>
 
 #include "utils/array2d.h"
 
@@ -68,6 +70,16 @@ void Generator::SetLogger(Logger* logger) {
         logger_ = logger;
 }
 
+void Generator::SetIOExecutor(utils::IOExecutor* executor) {
+    if (io_executor_) {
+        io_executor_->SetWaitDeferred(false);
+    }
+    io_executor_ = executor;
+    if (io_executor_) {
+        io_executor_->SetWaitDeferred(true);
+    }
+}
+
 void Generator::PushBackModule(IModule* module) {
     modules_.push_back(module);
 }
@@ -112,16 +124,22 @@ bool Generator::Generate() {
     logger_->LogMessage("Generation started.");
     auto time_beg = std::chrono::high_resolution_clock::now();
 
+    bool is_generated = true;
     for (auto& module : modules_) {
         if (!module) {
             logger_->LogError(module, "Module didn't found.");
-            return false;
+            is_generated = false;
+            break;
         }
 
         logger_->ModuleStarted(module);
 
         if (!ApplySettings(module)) {
-            return false;
+            is_generated = false;
+            break;
+        }
+        if (io_executor_) {
+            io_executor_->SetOwner(module);
         }
         module->Init();
         try {
@@ -130,13 +148,28 @@ bool Generator::Generate() {
         catch (const LogicException& e) {
             logger_->LogError(module, e.what());
             module->Deinit();
-            return false;
+            is_generated = false;
+            break;
+        }
+        catch (const std::bad_alloc&) {
+            logger_->LogError(module, "Not enough memory or temporary file "
+                              "space for maps. Big maps can be stored in "
+                              "files by system.storage settings.");
+            module->Deinit();
+            is_generated = false;
+            break;
         }
         module->Deinit();
 
         logger_->ModuleEnded(module);
     }
 
+    // Files of modules are written while next modules go on, so they are
+    // waited once after the pipeline.
+    if (!WaitIO(is_generated) || !is_generated) {
+        return false;
+    }
+
     logger_->LogMessage("Generation ended.");
     auto time_end = std::chrono::high_resolution_clock::now();
     double seconds = (time_end - time_beg).count() / 1000000000.0;
@@ -144,6 +177,30 @@ bool Generator::Generate() {
     return true;
 }
 
+bool Generator::WaitIO(bool is_reported) {
+    if (!io_executor_) {
+        return true;
+    }
+    io_executor_->SetOwner(nullptr);
+    const void* owner = nullptr;
+    try {
+        io_executor_->Wait(&owner);
+    }
+    catch (const std::exception& e) {
+        if (is_reported) {
+            IModule* module = nullptr;
+            for (auto& added : modules_) {
+                if (added == owner) {
+                    module = added;
+                }
+            }
+            logger_->LogError(module, e.what());
+        }
+        return false;
+    }
+    return true;
+}
+
 bool Generator::ApplySettings(IModule* module) {
     const list<string> settings_keys = module->GetNeededSettings();
     for (const auto& i : settings_keys) {
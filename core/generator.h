@@ -4,6 +4,7 @@
 #include "logger.h"
 #include "module_interface.h"
 #include "settings_interface.h"
+#include "utils/io_executor.h"
 
 namespace prowogene {
 
@@ -29,6 +30,13 @@ class Generator {
     @param [in] logger - Instance that will be used for logging. */
     void SetLogger(Logger* logger);
 
+    /** Attach executor that writes output files of modules. Files are
+    written while next modules go on, generator waits for them after the
+    last module and reports write error as error of module that submitted
+    it.
+    @param [in] executor - Executor, @c nullptr to not wait. */
+    void SetIOExecutor(utils::IOExecutor* executor);
+
     /** Add module to the end of pipeline.
     @param [in] storage - Module instance that will be pushed to the end of
                           pipeline. */
@@ -66,9 +74,18 @@ class Generator {
             needed to module wasn't attached to generator. */
     virtual bool ApplySettings(IModule* module);
 
+    /** Wait for all I/O tasks and log their error as error of module that
+    submitted failed task.
+    @param [in] is_reported - Log error, @c false when pipeline is already
+                              failed and only pending files are completed.
+    @return @c true if all tasks are succeeded, @c false otherwise. */
+    virtual bool WaitIO(bool is_reported);
+
 
     /** Instance for logging. */
     Logger*                                  logger_ = nullptr;
+    /** Executor of I/O tasks, @c nullptr if there is nothing to wait. */
+    utils::IOExecutor*                       io_executor_ = nullptr;
     /** Information about settings and stored flag about execution of
     IsCorrect was already completed. Access by names. */
     std::map<std::string, LazySettingsCheck> settings_;
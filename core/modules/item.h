@@ -126,6 +126,9 @@ struct ExportChunkSettings : ISettings {
         int         x = 0;
         /** Y index of chunk. */
         int         y = 0;
+        /** 3D model filenames of lower levels of detail, from the most
+        detailed one. */
+        std::vector<std::string> levels;
     } info;
     /** Information about items placed on that chunk. */
     std::list<ExportItemSettings> items;
@@ -158,6 +161,9 @@ struct ExportWorldSettings : ISettings {
         int   count_x = 0;
         /** Chunks count per Y coord. */
         int   count_y = 0;
+        /** Texture atlas filename with textures and normal maps of all
+        chunks. Empty when chunk textures are separate images. */
+        std::string atlas;
         /** Chunks export data. */
         std::list<ExportChunkSettings> data;
     } chunks;
@@ -1,6 +1,7 @@
 #include "item.h"
 
 #include "utils/array2d_tools.h"
+#include "utils/texture_atlas.h"
 #include "utils/types_converter.h"
 
 namespace prowogene {
@@ -372,16 +373,32 @@ ExportWorldSettings ItemModule::CreateExportInfo() {
     world_info.chunks.size = real_chunk_size;
     world_info.chunks.count_x = size / chunk_size;
     world_info.chunks.count_y = size / chunk_size;
+    const auto& texture = settings_.texture;
+    const bool in_atlas = texture.chunks_enabled && texture.atlas.enabled;
+    if (in_atlas) {
+        world_info.chunks.atlas = settings_.names.atlas + "." +
+                                  utils::TextureAtlas::kExtension;
+    }
     for (int x = 0; x < world_info.chunks.count_x; ++x) {
         for (int y = 0; y < world_info.chunks.count_y; ++y) {
             ExportChunkSettings chunk_info;
             const auto& names = settings_.names;
-            const bool chunks_enabled = settings_.texture.chunks_enabled;
             FillExportFiles(chunk_info.info.files, names.chunk.Apply(x, y),
-                chunks_enabled, names.texture.Apply(x, y),
-                names.normal.Apply(x, y));
+                texture.chunks_enabled && !in_atlas,
+                names.texture.Apply(x, y), names.normal.Apply(x, y));
+            if (in_atlas) {
+                // Normal map is in atlas too.
+                chunk_info.info.files.normal.clear();
+            }
             chunk_info.info.x = x;
             chunk_info.info.y = y;
+            const string& model_ext = settings_.system.extensions.model;
+            for (int level = 1; level <= settings_.model.levels.count;
+                    ++level) {
+                const string level_name = settings_.model.GetLevelName(
+                    names.chunk.Apply(x, y), level);
+                chunk_info.info.levels.push_back(level_name + "." + model_ext);
+            }
 
             for (auto& item : placed_objects_) {
                 const int item_chunk_x = static_cast<int>(
@@ -126,6 +126,7 @@ static const string kExpChunkInfoTexture = "texture";
 static const string kExpChunkInfoNormal =  "normal";
 static const string kExpChunkInfoX =       "x";
 static const string kExpChunkInfoY =       "y";
+static const string kExpChunkInfoLevels =  "levels";
 static const string kExpChunkItems =       "items";
 
 void ExportChunkSettings::Deserialize(JsonObject config) {
@@ -135,6 +136,10 @@ void ExportChunkSettings::Deserialize(JsonObject config) {
     info.files.normal =  info_config[kExpChunkInfoNormal].Str();
     info.x =             info_config[kExpChunkInfoX];
     info.y =             info_config[kExpChunkInfoY];
+    JsonArray json_levels = info_config[kExpChunkInfoLevels];
+    for (const auto& level : json_levels) {
+        info.levels.push_back(level.Str());
+    }
 
     JsonArray json_items = config[kExpChunkItems];
     for (const auto& item : json_items) {
@@ -152,6 +157,14 @@ JsonObject ExportChunkSettings::Serialize() const {
     json_info[kExpChunkInfoNormal] =  info.files.normal;
     json_info[kExpChunkInfoX] =       info.x;
     json_info[kExpChunkInfoY] =       info.y;
+    if (!info.levels.empty()) {
+        JsonArray json_levels;
+        json_levels.reserve(info.levels.size());
+        for (const auto& level : info.levels) {
+            json_levels.push_back(level);
+        }
+        json_info[kExpChunkInfoLevels] = json_levels;
+    }
     config[kExpChunkInfo] = json_info;
 
     JsonArray json_items;
@@ -179,6 +192,7 @@ static const string kExpWorldChunks =              "chunks";
 static const string kExpWorldChunksSize =          "size";
 static const string kExpWorldChunksCountX =        "count_x";
 static const string kExpWorldChunksCountY =        "count_y";
+static const string kExpWorldChunksAtlas =         "atlas";
 static const string kExpWorldChunksData =          "data";
 static const string kExpWorldWaterLevel =          "water_level";
 
@@ -201,6 +215,7 @@ void ExportWorldSettings::Deserialize(JsonObject config) {
     chunks.size =    chunks_config[kExpWorldChunksSize];
     chunks.count_x = chunks_config[kExpWorldChunksCountX];
     chunks.count_y = chunks_config[kExpWorldChunksCountY];
+    chunks.atlas =   chunks_config[kExpWorldChunksAtlas].Str();
 
     JsonArray json_data = chunks_config[kExpWorldChunksData];
     for (const auto& item : json_data) {
@@ -230,6 +245,7 @@ JsonObject ExportWorldSettings::Serialize() const {
     chunks_config[kExpWorldChunksSize] =   chunks.size;
     chunks_config[kExpWorldChunksCountX] = chunks.count_x;
     chunks_config[kExpWorldChunksCountY] = chunks.count_y;
+    chunks_config[kExpWorldChunksAtlas] =  chunks.atlas;
     JsonArray json_data;
     json_data.reserve(chunks.data.size());
     for (const auto& data : chunks.data) {
@@ -32,6 +32,8 @@ struct LocationSettings : ISettings {
     float forest_ratio = 0.5f;
     /** Save locations map to image. Any. */
     bool  map_enable = false;
+    /** File format of locations map. */
+    LocationMapFormat map_format = LocationMapFormat::Rgb;
     /** Colors for location map image. */
     struct {
         /** Undefined location color. */
@@ -67,8 +69,9 @@ class LocationModule : public IModule {
     std::string GetName() const override;
 
  protected:
-    /** Save location map as image
-    @param [in] filename - Image filename. */
+    /** Save location map in format from settings. Writing is done
+    asynchronously by I/O executor.
+    @param [in] filename - Filename without extension. */
     virtual void SaveMap(const std::string& filename);
 
     /** Mark locations according to height. */
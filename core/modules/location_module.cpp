@@ -1,24 +1,31 @@
 #include "location.h"
 
 #include <cmath>
+#include <memory>
 
 #include "utils/array2d_tools.h"
+#include "utils/bmp.h"
 #include "utils/random.h"
+#include "utils/rle_map.h"
 
 namespace prowogene {
 namespace modules {
 
 using std::list;
-using std::map;
 using std::pair;
 using std::string;
 using std::vector;
 using utils::Array2D;
+using utils::Bmp;
 using utils::ImageIOParams;
 using utils::Random;
 using utils::RgbaPixel;
+using utils::RleMap;
 using AT = utils::Array2DTools;
 
+static const int kLocationsCount = static_cast<int>(Location::Sea) + 1;
+static const string kRleExtension = "rle";
+
 void LocationModule::Process() {
     if (!settings_.location.enabled) {
         return;
@@ -62,32 +69,61 @@ void LocationModule::ApplySettings(ISettings* settings) {
 }
 
 void LocationModule::SaveMap(const std::string& filename) {
+    const auto& colors = settings_.location.colors;
     const int size = location_map_->Width();
-    Array2D<RgbaPixel> image(size, size);
 
-    map<Location, RgbaPixel> colors = {
-        { Location::None,     settings_.location.colors.none },
-        { Location::Forest,   settings_.location.colors.forest },
-        { Location::Glade,    settings_.location.colors.glade },
-        { Location::Mountain, settings_.location.colors.mountain },
-        { Location::River,    settings_.location.colors.river },
-        { Location::Beach,    settings_.location.colors.beach },
-        { Location::Sea,      settings_.location.colors.sea }
-    };
+    // Palette is indexed by location values, so location map is the
+    // indexed image itself.
+    vector<RgbaPixel> palette(kLocationsCount);
+    palette[static_cast<int>(Location::None)] =     colors.none;
+    palette[static_cast<int>(Location::Forest)] =   colors.forest;
+    palette[static_cast<int>(Location::Glade)] =    colors.glade;
+    palette[static_cast<int>(Location::Mountain)] = colors.mountain;
+    palette[static_cast<int>(Location::River)] =    colors.river;
+    palette[static_cast<int>(Location::Beach)] =    colors.beach;
+    palette[static_cast<int>(Location::Sea)] =      colors.sea;
+    const uint8_t* indices = reinterpret_cast<const uint8_t*>(
+        location_map_->Data());
+
+    // Map is written by I/O executor while module goes on, so task
+    // owns copy of indices.
+    const LocationMapFormat format = settings_.location.map_format;
+    if (format == LocationMapFormat::Indexed ||
+            format == LocationMapFormat::Rle) {
+        const auto owned = std::make_shared<vector<uint8_t> >(
+            indices, indices + location_map_->Size());
+        image_io_->GetExecutor()->Submit(
+            [owned, format, filename, size, palette]() {
+                string path;
+                bool is_written = false;
+                if (format == LocationMapFormat::Indexed) {
+                    path = filename + ".bmp";
+                    is_written = Bmp::EncodeIndexed(path, owned->data(),
+                                                    size, size, palette);
+                } else {
+                    path = filename + "." + kRleExtension;
+                    is_written = RleMap::Encode(path, owned->data(), size,
+                                                size, palette);
+                }
+                if (!is_written) {
+                    throw LogicException("Can't write location map '" +
+                                         path + "'.");
+                }
+            }, owned->size());
+        return;
+    }
 
-    for (int x = 0; x < size; ++x) {
-        for (int y = 0; y < size; ++y) {
-            const auto& iter = colors.find((*location_map_)(x, y));
-            if (iter != colors.end()) {
-                image(x, y) = iter->second;
-            }
-        }
+    Array2D<RgbaPixel> image(size, size);
+    RgbaPixel* pixels = image.Data();
+    const size_t count = image.Size();
+    for (size_t i = 0; i < count; ++i) {
+        pixels[i] = palette[indices[i]];
     }
     ImageIOParams params;
     params.bit_depth = 24;
     params.filename = filename;
     params.format = "bmp";
-    image_io_->Save(image, params);
+    image_io_->SaveAsync(std::move(image), params);
 }
 
 void LocationModule::CreateBasedOnHeight() {
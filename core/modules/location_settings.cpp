@@ -1,5 +1,7 @@
 #include "location.h"
 
+#include "utils/types_converter.h"
+
 namespace prowogene {
 namespace modules {
 
@@ -7,11 +9,13 @@ using std::string;
 using utils::JsonValue;
 using utils::JsonObject;
 using utils::RgbaPixel;
+using TC = utils::TypesConverter;
 
 static const string kEnabled =       "enabled";
 static const string kForestOctaves = "forest_octaves";
 static const string kForestRatio =   "forest_ratio";
 static const string kExportMap =     "export_map";
+static const string kExportFormat =  "export_format";
 static const string kColors =        "colors";
 static const string kColorsNone =     "none";
 static const string kColorsForest =   "forest";
@@ -26,6 +30,7 @@ void LocationSettings::Deserialize(JsonObject config) {
     forest_octaves = config[kForestOctaves];
     forest_ratio =   config[kForestRatio];
     map_enable =     config[kExportMap];
+    map_format =     TC::To<LocationMapFormat>(config[kExportFormat]);
     JsonObject json_colors = config[kColors];
     colors.none =     RgbaPixel(json_colors[kColorsNone].Str());
     colors.forest =   RgbaPixel(json_colors[kColorsForest].Str());
@@ -42,6 +47,7 @@ JsonObject LocationSettings::Serialize() const {
     config[kForestOctaves] = forest_octaves;
     config[kForestRatio] =   forest_ratio;
     config[kExportMap] =     map_enable;
+    config[kExportFormat] =  TC::ToString(map_format);
     JsonObject json_colors;
     json_colors[kColorsNone] =     colors.none.ToString();
     json_colors[kColorsForest] =   colors.forest.ToString();
@@ -29,18 +29,73 @@ struct ModelSettings : ISettings {
     bool  chunks_enabled = false;
     /** Enable complex map 3D model saving. */
     bool  complex_enabled = false;
-    /** Add materials for all saved models. */
+    /** Add materials for all saved models. Chunk models have no materials
+    when chunk textures are saved to texture atlas. */
     bool  materials_enabled = false;
     /** Add UV coordinates for all saved models. */
     bool  uv_enabled = false;
+    /** Count UV of chunk models from corner of chunk texture, so they are
+    in [0.0, 1.0]. Otherwise UV are counted from map origin and textures
+    must be repeated. Always used for quantized models. */
+    bool  uv_local = false;
     /** Add normal vectors for verticies for all saved models. */
     bool  normals_enabled = false;
+    /** Keep normal vectors of whole map as unit vectors packed to 4 bytes
+    instead of 12 bytes. Saved normals are unit vectors in this case. */
+    bool  normals_packed = false;
     /** Distance between 2 nearest points on heightmap in 3D units. */
     float edge_size = 1.0f;
     /** Distance between lowest and highest points of map. */
     float map_height = 20.0f;
     /** Coordinates order in model. Can store negative values. */
     std::string coord_format = "x z y";
+    /** Store vertex attributes as integers (only for glTF models). */
+    bool  quantization_enabled = false;
+    /** Faces storing in memory. Strips need 3 times less memory. */
+    MeshTopology topology = MeshTopology::Triangles;
+    /** Adaptive level of detail settings. */
+    struct {
+        /** Replace full resolution grid by right triangulated irregular
+        network. Models of neighbour chunks have no cracks between them. */
+        bool  enabled = false;
+        /** Maximal vertical distance between model and height map in 3D
+        units. */
+        float max_error = 0.1f;
+    } lod;
+    /** Discrete levels of detail of chunk models. */
+    struct {
+        /** Count of lower levels saved for every chunk in addition to full
+        resolution level 0. Every next level has 2 times less points per
+        side. [0, log2(chunk_size)]. */
+        int   count = 0;
+        /** Depth of skirts along chunk borders in 3D units. Skirts hide
+        cracks between neighbour chunks of different levels. 0.0 disables
+        skirts. */
+        float skirt_depth = 0.0f;
+    } levels;
+    /** Count of height map columns in single part of complex model. Parts
+    are created and saved one by one, so memory usage is bounded for big
+    maps. 0 means whole model is created at once. Not used with adaptive
+    level of detail. */
+    int   stream_band_size = 0;
+    /** Raw 16bit heightfield tiles. */
+    struct {
+        /** Save heightfield tile for every chunk. It doesn't depend on
+        chunk models saving. */
+        bool  enabled = false;
+        /** Store heights as half precision floats instead of 16bit
+        unsigned normalized integers. */
+        bool  half_float = false;
+        /** Add first row and column of next chunks, so tile has
+        chunk_size + 1 samples per side like chunk model. */
+        bool  overlap = false;
+    } heightfield;
+
+    /** Get model filename of chunk's level of detail.
+    @param [in] name  - Full resolution model filename without extension.
+    @param [in] level - Level of detail.
+    @return Model filename without extension. */
+    std::string GetLevelName(const std::string& name, int level) const;
 };
 
 
@@ -59,42 +114,110 @@ class ModelModule : public IModule {
     std::string GetName() const override;
 
  protected:
+    /** Create and save all levels of detail of chunk 3D model. Method is
+    called from several threads at once, files are written asynchronously
+    by I/O executor.
+    @param [in] x      - X index of chunk.
+    @param [in] y      - Y index of chunk.
+    @param [in] params - Saving params without filenames. */
+    virtual void SaveChunk(int x, int y, utils::ModelIOParams params) const;
+
+    /** Create complex 3D model and save it by bands of height map columns,
+    so whole model is never stored in memory.
+    @param [in] params - Saving params. */
+    virtual void SaveComplexByBands(const utils::ModelIOParams& params) const;
+
+    /** Save heightfield tile of chunk. Method is called from several
+    threads at once.
+    @param [in] x - X index of chunk.
+    @param [in] y - Y index of chunk. */
+    virtual void SaveHeightfield(int x, int y) const;
+
     /** Create 3D model for part of height map. Only square areas supported.
     @param [in] x    - X coordinate of top left corner of the area.
     @param [in] y    - Y coordinate of top left corner of the area.
     @param [in] side - side size of area in points.
+    @param [in] step - Distance between used height map points. Power of 2.
     @return 3D model for selected part of height map. */
-    virtual utils::Model3d CreateArea(int x, int y, int side) const;
+    virtual utils::Model3d CreateArea(int x, int y, int side,
+                                      int step = 1) const;
 
-    /** Fill 3D model's vertexes according to height map.
+    /** Fill 3D model's vertexes according to height map. Fill* methods
+    support rectangular areas.
     @param [in, out] model - Model for filling.
-    @param [in] r          - Area ranges. */
+    @param [in] r          - Area ranges.
+    @param [in] step       - Distance between used height map points. */
     virtual void FillAreaVertexes(utils::Model3d& model,
-                                  const utils::Range& r) const;
+                                  const utils::Range& r,
+                                  int step) const;
 
     /** Fill 3D model's UV.
-    @param [in, out] model - Model for filling.
-    @param [in] r          - Area ranges. */
+    @param [in, out] model      - Model for filling.
+    @param [in] r               - Area ranges.
+    @param [in] step            - Distance between used height map points.
+    @param [in] texture_side    - Count of height map points along texture
+                                  side. Textures are placed from map
+                                  origin without gaps. UV are counted from
+                                  map origin unless local UV are used. */
     virtual void FillAreaUV(utils::Model3d& model,
-                            const utils::Range& r) const;
-
-    /** Fill 3D model's normal vectors according to height map.
+                            const utils::Range& r,
+                            int step,
+                            int texture_side) const;
+
+    /** Compute normal vectors for all height map points in parallel.
+    Normals of map borders are computed as for tiled map. */
+    virtual void InitNormals();
+
+    /** Get normal vector of height map point. InitNormals must be called
+    before it.
+    @param [in] x - X coordinate of point, wrapped around map size.
+    @param [in] y - Y coordinate of point, wrapped around map size.
+    @return Normal vector. */
+    virtual utils::Vector3D GetNormal(int x, int y) const;
+
+    /** Fill 3D model's normal vectors from normals of height map. All
+    levels of detail get normals of full resolution map.
     @param [in, out] model - Model for filling.
-    @param [in] r          - Area ranges. */
+    @param [in] r          - Area ranges.
+    @param [in] step       - Distance between used height map points. */
     virtual void FillAreaNormals(utils::Model3d& model,
-                                 const utils::Range& r) const;
+                                 const utils::Range& r,
+                                 int step) const;
 
-    /** Fill 3D model's faces according to height map.
+    /** Fill 3D model's faces according to height map. Triangles or
+    triangle strips are created according to model topology.
     @param [in, out] model - Model for filling.
-    @param [in] r          - Area ranges. */
+    @param [in] r          - Area ranges.
+    @param [in] step       - Distance between used height map points. */
     virtual void FillAreaFaces(utils::Model3d& model,
-                               const utils::Range& r) const;
-
-    /** Fill 3D model's vertexes according to height map.
-    @param [in] face   - Indexes of vertexes.
-    @param [out] group - Tris to fill. */
-    static void FillTris(const std::vector<int>& face,
-                         utils::VertexGroup (&group)[3]);
+                               const utils::Range& r,
+                               int step) const;
+
+    /** Add skirts to all border edges of 3D model. Skirt is vertical strip
+    that goes down from border edge, it has the same UV and normal vectors
+    as edge.
+    @param [in, out] model - Model for changing.
+    @param [in] depth      - Skirt depth in 3D units. */
+    static void AddSkirts(utils::Model3d& model, float depth);
+
+    /** Compute errors of right triangulated irregular network for whole
+    height map. Error of vertex is the maximal vertical distance between
+    height map and triangles with hypotenuse middle in this vertex, errors
+    of their children are included too. Map is split to square tiles with
+    the same triangles hierarchy, errors of vertexes on tile borders are
+    taken from both tiles, so neighbour tiles are split equally along
+    common border.
+    @param [in] tile_size - Side of tile in points. Power of 2. */
+    virtual void InitLodErrors(int tile_size);
+
+    /** Fill 3D model's faces with adaptive level of detail. Triangle is
+    split while error of it's hypotenuse middle is greater than maximal
+    error. InitLodErrors must be called with area side before it. Unused
+    vertexes are left in model.
+    @param [in, out] model - Model for filling.
+    @param [in] r          - Area ranges. */
+    virtual void FillAreaLodFaces(utils::Model3d& model,
+                                  const utils::Range& r) const;
 
  public:
     /** Height map from data storage. */
@@ -116,6 +239,12 @@ class ModelModule : public IModule {
         /** Texture settings. */
         TextureSettings texture;
     } settings_;
+    /** Errors of height map points for adaptive level of detail. */
+    utils::Array2D<float> lod_errors_;
+    /** Normal vectors of height map points. */
+    utils::Array2D<utils::Vector3D> normals_;
+    /** Packed normal vectors of height map points. */
+    utils::Array2D<utils::PackedNormal> packed_normals_;
 };
 
 } // namespace modules
@@ -1,5 +1,13 @@
 #include "model.h"
 
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "utils/parallel_for.h"
+
 namespace prowogene {
 namespace modules {
 
@@ -7,17 +15,24 @@ using std::list;
 using std::string;
 using std::vector;
 using utils::Array2D;
+using utils::Heightfield;
+using utils::HeightfieldParams;
 using utils::Model3d;
 using utils::ModelIO;
 using utils::ModelIOParams;
+using utils::ModelWriter;
+using utils::PackedNormal;
+using utils::ParallelFor;
+using utils::TextureCoord;
 using utils::Vector3D;
+using utils::Vertex;
 using utils::Range;
-using utils::VertexGroup;
 
 void ModelModule::Process() {
     const bool chunks_enabled = settings_.model.chunks_enabled;
     const bool complex_enabled = settings_.model.complex_enabled;
-    if (!chunks_enabled && !complex_enabled) {
+    const bool heightfield_enabled = settings_.model.heightfield.enabled;
+    if (!chunks_enabled && !complex_enabled && !heightfield_enabled) {
         return;
     }
 
@@ -30,53 +45,65 @@ void ModelModule::Process() {
     params.add_uv =       settings_.model.uv_enabled;
     params.coord_format = settings_.model.coord_format;
     params.format =       settings_.system.extensions.model;
+    params.quantize =     settings_.model.quantization_enabled;
 
-    if (chunks_enabled) {
+    if (settings_.model.normals_enabled &&
+            (chunks_enabled || complex_enabled)) {
+        InitNormals();
+    }
+
+    if (chunks_enabled || heightfield_enabled) {
         const int chunk_size = settings_.general.chunk_size;
         const int chunk_count = size / chunk_size;
+        // Heightfields have no levels of detail.
+        if (chunks_enabled &&
+                (1 << settings_.model.levels.count) > chunk_size) {
+            throw LogicException("Levels of detail count is greater than "
+                                 "log2(chunk_size).");
+        }
+        if (chunks_enabled && settings_.model.lod.enabled) {
+            InitLodErrors(chunk_size);
+        }
 
-        for (int x = 0; x < chunk_count; ++x) {
-            for (int y = 0; y < chunk_count; ++y) {
-                const int x_beg = x * chunk_size;
-                const int y_beg = y * chunk_size;
-                const Model3d chunk = CreateArea(x_beg, y_beg, chunk_size);
-
-                const auto& chunk_templ = settings_.names.chunk;
-                const string mesh_name = chunk_templ.Apply(x, y);
-
-                params.filename = mesh_name;
-                if (!settings_.texture.chunks_enabled || !materials_enabled) {
-                    model_io_->Save(chunk, params);
-                    params.filename = "";
-                    continue;
+        // Every chunk is created and saved by single thread, so output
+        // files don't depend on threads count. Only writing goes to I/O
+        // executor.
+        ParallelFor(chunk_count * chunk_count, settings_.system.thread_count,
+                    [&](int beg, int end) {
+            for (int i = beg; i < end; ++i) {
+                const int x = i / chunk_count;
+                const int y = i % chunk_count;
+                if (heightfield_enabled) {
+                    SaveHeightfield(x, y);
+                }
+                if (chunks_enabled) {
+                    SaveChunk(x, y, params);
                 }
-
-                const auto& texture_name = settings_.names.texture;
-                const string texture =     texture_name.Apply(x, y, img_ext);
-                const auto& normal_name = settings_.names.texture;
-                const string normal =     normal_name.Apply(x, y, img_ext);
-                params.texture =    texture;
-                params.normal_map = normal;
-                model_io_->Save(chunk, params);
-                params.texture =    "";
-                params.normal_map = "";
-                params.filename =   "";
             }
-        }
+        });
     }
 
     if (complex_enabled) {
         const auto& minimap_name = settings_.names.minimap;
-        const Model3d complex = CreateArea(0, 0, size);
         params.filename = minimap_name.model;
         if (settings_.texture.minimap.enabled && materials_enabled) {
             params.texture =    minimap_name.texture + "." + img_ext;
-            params.normal_map = minimap_name.normal  + "." + img_ext;
-            model_io_->Save(complex, params);
+            if (settings_.texture.normals.enabled) {
+                params.normal_map = minimap_name.normal + "." + img_ext;
+            }
+        }
+        if (settings_.model.stream_band_size && !settings_.model.lod.enabled) {
+            SaveComplexByBands(params);
         } else {
-            model_io_->Save(complex, params);
+            if (settings_.model.lod.enabled) {
+                InitLodErrors(size);
+            }
+            model_io_->SaveAsync(CreateArea(0, 0, size), params);
         }
     }
+    lod_errors_.Clear();
+    normals_.Clear();
+    packed_normals_.Clear();
 }
 
 list<string> ModelModule::GetNeededSettings() const {
@@ -101,32 +128,145 @@ std::string ModelModule::GetName() const {
     return "Model";
 }
 
-Model3d ModelModule::CreateArea(int x_beg, int y_beg, int side) const {
+void ModelModule::SaveChunk(int x, int y, ModelIOParams params) const {
+    const int    chunk_size = settings_.general.chunk_size;
+    const string mesh_name = settings_.names.chunk.Apply(x, y);
+    const float  skirt_depth = settings_.model.levels.skirt_depth;
+
+    // Tiles of texture atlas can't be referenced by model materials.
+    const auto& texture = settings_.texture;
+    if (texture.chunks_enabled && !texture.atlas.enabled &&
+            settings_.model.materials_enabled) {
+        const string& img_ext = settings_.system.extensions.image;
+        params.texture = settings_.names.texture.Apply(x, y, img_ext);
+        if (settings_.texture.normals.enabled) {
+            params.normal_map = settings_.names.normal.Apply(x, y, img_ext);
+        }
+    }
+
+    for (int level = 0; level <= settings_.model.levels.count; ++level) {
+        Model3d chunk = CreateArea(x * chunk_size, y * chunk_size, chunk_size,
+                                   1 << level);
+        if (skirt_depth > 0.0f) {
+            AddSkirts(chunk, skirt_depth);
+        }
+        params.filename = settings_.model.GetLevelName(mesh_name, level);
+        model_io_->SaveAsync(std::move(chunk), params);
+    }
+}
+
+void ModelModule::SaveHeightfield(int x, int y) const {
+    const int   size = settings_.general.size;
+    const int   chunk_size = settings_.general.chunk_size;
+    const float edge = settings_.model.edge_size;
+    const float real_half_size = size / 2.0f * edge;
+    const int   last = settings_.model.heightfield.overlap ? chunk_size
+                                                          : chunk_size - 1;
+    const int   x_beg = x * chunk_size;
+    const int   y_beg = y * chunk_size;
+    const Range range(x_beg, x_beg + last, y_beg, y_beg + last);
+
+    HeightfieldParams params;
+    params.filename = settings_.names.chunk.Apply(x, y);
+    params.half_float = settings_.model.heightfield.half_float;
+    params.origin_x = x_beg * edge - real_half_size;
+    params.origin_y = y_beg * edge - real_half_size;
+    params.edge_size = edge;
+    params.height_scale = settings_.model.map_height;
+    if (!model_io_->SaveHeightfield(*height_map_, range, params)) {
+        throw LogicException("Can't write heightfield '" + params.filename +
+                             "." + Heightfield::kExtension + "'.");
+    }
+}
+
+void ModelModule::SaveComplexByBands(const ModelIOParams& params) const {
+    const int size = settings_.general.size;
+    const int band_size = settings_.model.stream_band_size;
+    const uint32_t column_size = size + 1;
+    std::unique_ptr<ModelWriter> writer = model_io_->CreateWriter(params);
+    if (!writer) {
+        throw LogicException("Model format '" + params.format +
+                             "' isn't supported.");
+    }
+
+    for (int x_beg = 0; x_beg < size; x_beg += band_size) {
+        const int x_end = std::min(x_beg + band_size, size);
+        const Range range(x_beg, x_end, 0, size);
+        Model3d band;
+        band.topology = settings_.model.topology;
+        FillAreaVertexes(band, range, 1);
+        if (settings_.model.uv_enabled) {
+            FillAreaUV(band, range, 1, size);
+        }
+        if (settings_.model.normals_enabled) {
+            FillAreaNormals(band, range, 1);
+        }
+        FillAreaFaces(band, range, 1);
+
+        // First column of band is already saved with previous band, faces
+        // use indices of the whole model.
+        const uint32_t first_index = x_beg * column_size;
+        for (auto& index : band.indices) {
+            if (index != Model3d::kRestartIndex) {
+                index += first_index;
+            }
+        }
+        if (x_beg) {
+            band.vertexes.erase(band.vertexes.begin(),
+                                band.vertexes.begin() + column_size);
+            if (!band.uv.empty()) {
+                band.uv.erase(band.uv.begin(),
+                              band.uv.begin() + column_size);
+            }
+            if (!band.normals.empty()) {
+                band.normals.erase(band.normals.begin(),
+                                   band.normals.begin() + column_size);
+            }
+        }
+        writer->Write(band);
+    }
+    if (!writer->Close()) {
+        throw LogicException("Can't write 3D model '" + params.filename +
+                             "." + params.format + "'.");
+    }
+}
+
+Model3d ModelModule::CreateArea(int x_beg, int y_beg, int side,
+        int step) const {
     Model3d model;
+    model.topology = settings_.model.topology;
     const Range range(x_beg, x_beg + side, y_beg, y_beg + side);
-    FillAreaVertexes(model, range);
+    FillAreaVertexes(model, range, step);
     if (settings_.model.uv_enabled) {
-        FillAreaUV(model, range);
+        FillAreaUV(model, range, step, side);
     }
     if (settings_.model.normals_enabled) {
-        FillAreaNormals(model, range);
+        FillAreaNormals(model, range, step);
+    }
+    if (settings_.model.lod.enabled && step == 1) {
+        model.topology = MeshTopology::Triangles;
+        FillAreaLodFaces(model, range);
+        model.RemoveUnusedVertexes();
+    } else {
+        FillAreaFaces(model, range, step);
     }
-    FillAreaFaces(model, range);
     return model;
 }
 
-void ModelModule::FillAreaVertexes(Model3d& model, const Range& range) const {
+void ModelModule::FillAreaVertexes(Model3d& model, const Range& range,
+        int step) const {
     const int   size = settings_.general.size;
     const float edge = settings_.model.edge_size;
     const float height = settings_.model.map_height;
-    const int   side = range.right - range.left;
-    const int   vertex_count = (side + 1) * (side + 1);
+    const int   side_x = (range.right - range.left) / step;
+    const int   side_y = (range.bottom - range.top) / step;
+    const int   vertex_count = (side_x + 1) * (side_y + 1);
     const float real_half_size = size / 2.0f * edge;
 
     int vertex_idx = 0;
     model.vertexes.resize(vertex_count);
-    for (int x = range.left; x <= range.right; ++x) {
-        for (int y = range.top; y <= range.bottom; ++y) {
+    for (int x = range.left; x <= range.right; x += step) {
+        for (int y = range.top; y <= range.bottom; y += step) {
             auto& vertex = model.vertexes[vertex_idx];
             vertex.x = x * edge - real_half_size;
             vertex.y = y * edge - real_half_size;
@@ -136,93 +276,340 @@ void ModelModule::FillAreaVertexes(Model3d& model, const Range& range) const {
     }
 }
 
-void ModelModule::FillAreaUV(Model3d& model, const Range& range) const {
-    const int side = range.right - range.left;
-    const int vertex_count = (side + 1) * (side + 1);
+void ModelModule::FillAreaUV(Model3d& model, const Range& range,
+        int step, int texture_side) const {
+    const int side = texture_side;
+    const int side_x = (range.right - range.left) / step;
+    const int side_y = (range.bottom - range.top) / step;
+    const int vertex_count = (side_x + 1) * (side_y + 1);
+    // Local UV are in [0.0, 1.0] inside texture that contains top left
+    // corner. Quantized UV can't be out of that range.
+    const bool is_local = settings_.model.uv_local ||
+                          settings_.model.quantization_enabled;
+    const int tex_left = is_local ? range.left - range.left % side : 0;
+    const int tex_top = is_local ? range.top - range.top % side : 0;
 
     int vertex_idx = 0;
     model.uv.resize(vertex_count);
-    for (int x = range.left; x <= range.right; ++x) {
-        for (int y = range.top; y <= range.bottom; ++y) {
+    for (int x = range.left; x <= range.right; x += step) {
+        for (int y = range.top; y <= range.bottom; y += step) {
             auto& tex = model.uv[vertex_idx];
-            tex.u = static_cast<float>(x) / side;
-            tex.v = static_cast<float>(side - y) / side;
+            tex.u = static_cast<float>(x - tex_left) / side;
+            tex.v = static_cast<float>(side - (y - tex_top)) / side;
             ++vertex_idx;
         }
     }
 }
 
-void ModelModule::FillAreaNormals(Model3d& model, const Range& range) const {
-    const int   size = settings_.general.size;
-    const float edge = settings_.model.edge_size;
-    const int   side = range.right - range.left;
-    const int   vertex_count = (side + 1) * (side + 1);
+void ModelModule::FillAreaNormals(Model3d& model, const Range& range,
+        int step) const {
+    const int side_x = (range.right - range.left) / step;
+    const int side_y = (range.bottom - range.top) / step;
+    const int vertex_count = (side_x + 1) * (side_y + 1);
     int vertex_idx = 0;
     model.normals.resize(vertex_count);
 
-    Vector3D right_minus_left;
-    right_minus_left.x = 0;
-    right_minus_left.y = -2 * edge;
-    Vector3D top_minus_bottom;
-    top_minus_bottom.x = 2 * edge;
-    top_minus_bottom.y = 0;
-
-    for (int x = range.left; x <= range.right; ++x) {
-        for (int y = range.top; y <= range.bottom; ++y) {
-            const float h_l = (*height_map_)((x - 1 + size) % size, y);
-            const float h_r = (*height_map_)((x + 1) % size, y);
-            const float h_t = (*height_map_)(x, (y - 1 + size) % size);
-            const float h_b = (*height_map_)(x, (y + 1) % size);
-
-            right_minus_left.z = h_r - h_l;
-            right_minus_left.z *= settings_.model.map_height;
-            top_minus_bottom.z = h_b - h_t;
-            top_minus_bottom.z *= settings_.model.map_height;
-
-            auto& vertex = model.normals[vertex_idx];
-            vertex = right_minus_left.Multiply(top_minus_bottom);
+    for (int x = range.left; x <= range.right; x += step) {
+        for (int y = range.top; y <= range.bottom; y += step) {
+            model.normals[vertex_idx] = GetNormal(x, y);
             ++vertex_idx;
         }
     }
 }
 
-void ModelModule::FillAreaFaces(Model3d& model, const Range& range) const {
-    const int side = range.right - range.left;
-    const int faces_count = side * side * 2;
+void ModelModule::InitNormals() {
+    const int   size = settings_.general.size;
+    const float edge = settings_.model.edge_size;
+    const float map_height = settings_.model.map_height;
+    const bool  packed = settings_.model.normals_packed;
+    if (packed) {
+        packed_normals_.Resize(size, size);
+    } else {
+        normals_.Resize(size, size);
+    }
+
+    ParallelFor(size, settings_.system.thread_count, [&](int beg, int end) {
+        Vector3D right_minus_left;
+        right_minus_left.x = 0;
+        right_minus_left.y = -2 * edge;
+        Vector3D top_minus_bottom;
+        top_minus_bottom.x = 2 * edge;
+        top_minus_bottom.y = 0;
+
+        for (int y = beg; y < end; ++y) {
+            const int top = (y - 1 + size) % size;
+            const int bottom = (y + 1) % size;
+            for (int x = 0; x < size; ++x) {
+                const int left = (x - 1 + size) % size;
+                const int right = (x + 1) % size;
+                const float h_l = (*height_map_)(left, y);
+                const float h_r = (*height_map_)(right, y);
+                const float h_t = (*height_map_)(x, top);
+                const float h_b = (*height_map_)(x, bottom);
+
+                right_minus_left.z = (h_r - h_l) * map_height;
+                top_minus_bottom.z = (h_b - h_t) * map_height;
+
+                const Vector3D normal =
+                    right_minus_left.Multiply(top_minus_bottom);
+                if (packed) {
+                    packed_normals_(x, y) = PackedNormal::Pack(normal);
+                } else {
+                    normals_(x, y) = normal.Normalize();
+                }
+            }
+        }
+    });
+}
+
+Vector3D ModelModule::GetNormal(int x, int y) const {
+    const int size = settings_.general.size;
+    x %= size;
+    y %= size;
+    if (settings_.model.normals_packed) {
+        return packed_normals_(x, y).Unpack();
+    }
+    return normals_(x, y);
+}
+
+void ModelModule::FillAreaFaces(Model3d& model, const Range& range,
+        int step) const {
+    const uint32_t side_x = (range.right - range.left) / step;
+    const uint32_t side_y = (range.bottom - range.top) / step;
+    const uint32_t column_size = side_y + 1;
+    auto& indices = model.indices;
 
-    model.faces.resize(faces_count);
-    int face_idx = 0;
-    const int rect_side = side + 1;
-    for (int yi = range.top; yi < range.bottom; ++yi) {
-        for (int xi = range.left; xi < range.right; ++xi) {
-            const int y = yi - range.top;
-            const int x = xi - range.left;
+    if (model.topology == MeshTopology::TriangleStrip) {
+        // Strip goes along one row band of quads between y and y + 1, so it
+        // gives the same triangles as the list below: { tl, tr, bl },
+        // { bl, tr, br }.
+        indices.resize(side_y * ((side_x + 1) * 2 + 1));
+        size_t idx = 0;
+        for (uint32_t y = 0; y < side_y; ++y) {
+            for (uint32_t x = 0; x <= side_x; ++x) {
+                indices[idx++] = x * column_size + y;
+                indices[idx++] = x * column_size + y + 1;
+            }
+            indices[idx++] = Model3d::kRestartIndex;
+        }
+        return;
+    }
+
+    indices.resize(side_x * side_y * 6);
+    size_t idx = 0;
+    for (uint32_t x = 0; x < side_x; ++x) {
+        for (uint32_t y = 0; y < side_y; ++y) {
+            const uint32_t tl = x * column_size + y;
+            const uint32_t tr = tl + 1;
+            const uint32_t bl = (x + 1) * column_size + y;
+            const uint32_t br = bl + 1;
 
-            const int tl = y * rect_side + x;
-            const int tr = tl + 1;
-            const int bl = (y + 1) * rect_side + x;
-            const int br = bl + 1;
+            indices[idx++] = tl;
+            indices[idx++] = tr;
+            indices[idx++] = bl;
+            indices[idx++] = bl;
+            indices[idx++] = tr;
+            indices[idx++] = br;
+        }
+    }
+}
 
-            const vector<vector<int> > faces = {
-                { tl, tr, bl },
-                { bl, tr, br }
-            };
-            for (const auto& face : faces) {
-                FillTris(face, model.faces[face_idx].groups);
-                ++face_idx;
+void ModelModule::AddSkirts(Model3d& model, float depth) {
+    auto edge_key = [](uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    };
+    vector<uint64_t> edges;
+    edges.reserve(model.TrianglesCount() * 3);
+    model.ForEachTriangle([&](uint32_t a, uint32_t b, uint32_t c) {
+        edges.push_back(edge_key(a, b));
+        edges.push_back(edge_key(b, c));
+        edges.push_back(edge_key(c, a));
+    });
+    vector<uint64_t> sorted_edges = edges;
+    std::sort(sorted_edges.begin(), sorted_edges.end());
+
+    const size_t vertexes_count = model.vertexes.size();
+    const bool has_uv = model.uv.size() == vertexes_count;
+    const bool has_normals = model.normals.size() == vertexes_count;
+    vector<uint32_t> skirt_idx(vertexes_count, Model3d::kRestartIndex);
+    auto get_skirt_vertex = [&](uint32_t idx) {
+        if (skirt_idx[idx] == Model3d::kRestartIndex) {
+            skirt_idx[idx] = static_cast<uint32_t>(model.vertexes.size());
+            Vertex vertex = model.vertexes[idx];
+            vertex.z -= depth;
+            model.vertexes.push_back(vertex);
+            if (has_uv) {
+                const TextureCoord uv = model.uv[idx];
+                model.uv.push_back(uv);
+            }
+            if (has_normals) {
+                const Vector3D normal = model.normals[idx];
+                model.normals.push_back(normal);
+            }
+        }
+        return skirt_idx[idx];
+    };
+
+    // Border edge belongs to single triangle, so there is no edge with
+    // opposite direction. Skirt continues that triangle with same winding.
+    auto& indices = model.indices;
+    const bool is_strip = model.topology == MeshTopology::TriangleStrip;
+    for (uint64_t edge : edges) {
+        const uint32_t a = static_cast<uint32_t>(edge >> 32);
+        const uint32_t b = static_cast<uint32_t>(edge);
+        if (std::binary_search(sorted_edges.begin(), sorted_edges.end(),
+                               edge_key(b, a))) {
+            continue;
+        }
+        const uint32_t skirt_a = get_skirt_vertex(a);
+        const uint32_t skirt_b = get_skirt_vertex(b);
+        if (is_strip) {
+            if (!indices.empty() && indices.back() != Model3d::kRestartIndex) {
+                indices.push_back(Model3d::kRestartIndex);
+            }
+            indices.insert(indices.end(), { b, a, skirt_b, skirt_a });
+            indices.push_back(Model3d::kRestartIndex);
+        } else {
+            indices.insert(indices.end(), { b, a, skirt_b });
+            indices.insert(indices.end(), { skirt_b, a, skirt_a });
+        }
+    }
+}
+
+void ModelModule::InitLodErrors(int tile_size) {
+    const int   size = settings_.general.size;
+    const float height = settings_.model.map_height;
+    const int   grid_size = size + 1;
+    const int   tile_count = size / tile_size;
+    const float* heights = height_map_->Data();
+    lod_errors_.Resize(grid_size, grid_size, 0.0f);
+    float* errors = lod_errors_.Data();
+
+    // Triangles are enumerated like nodes of binary heap, so all children
+    // are processed before their parents. Same triangle is processed in all
+    // tiles before going to the next one, so errors of border vertexes are
+    // complete when they are propagated to parents.
+    const int triangles_count = tile_size * tile_size * 2 - 2;
+    const int parents_count = triangles_count - tile_size * tile_size;
+    for (int i = triangles_count - 1; i >= 0; --i) {
+        int id = i + 2;
+        int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+        if (id & 1) {
+            bx = by = cx = tile_size;
+        } else {
+            ax = ay = cy = tile_size;
+        }
+        while ((id >>= 1) > 1) {
+            const int mx = (ax + bx) / 2;
+            const int my = (ay + by) / 2;
+            if (id & 1) {
+                bx = ax;
+                by = ay;
+                ax = cx;
+                ay = cy;
+            } else {
+                ax = bx;
+                ay = by;
+                bx = cx;
+                by = cy;
+            }
+            cx = mx;
+            cy = my;
+        }
+        const int mx = (ax + bx) / 2;
+        const int my = (ay + by) / 2;
+        const int x_min = std::min(ax, std::min(bx, cx));
+        const int x_max = std::max(ax, std::max(bx, cx));
+        const int y_min = std::min(ay, std::min(by, cy));
+        const int y_max = std::max(ay, std::max(by, cy));
+        const int det = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+
+        for (int tile_x = 0; tile_x < tile_count; ++tile_x) {
+            for (int tile_y = 0; tile_y < tile_count; ++tile_y) {
+                const int x0 = tile_x * tile_size;
+                const int y0 = tile_y * tile_size;
+                auto height_at = [&](int x, int y) {
+                    return heights[((y0 + y) % size) * size +
+                                   (x0 + x) % size] * height;
+                };
+
+                // Distance between triangle plane and all points inside it.
+                const float ha = height_at(ax, ay);
+                const float hb = height_at(bx, by);
+                const float hc = height_at(cx, cy);
+                float error = 0.0f;
+                for (int y = y_min; y <= y_max; ++y) {
+                    for (int x = x_min; x <= x_max; ++x) {
+                        const int wb = (x - ax) * (cy - ay) -
+                                       (y - ay) * (cx - ax);
+                        const int wc = (bx - ax) * (y - ay) -
+                                       (by - ay) * (x - ax);
+                        const int wa = det - wb - wc;
+                        if ((det > 0 && (wa < 0 || wb < 0 || wc < 0)) ||
+                            (det < 0 && (wa > 0 || wb > 0 || wc > 0))) {
+                            continue;
+                        }
+                        const float plane = (wa * ha + wb * hb + wc * hc) /
+                                            det;
+                        error = std::max(error,
+                                         std::fabs(plane - height_at(x, y)));
+                    }
+                }
+                if (i < parents_count) {
+                    const int lx = x0 + (ax + cx) / 2;
+                    const int ly = y0 + (ay + cy) / 2;
+                    const int rx = x0 + (bx + cx) / 2;
+                    const int ry = y0 + (by + cy) / 2;
+                    error = std::max(error, errors[ly * grid_size + lx]);
+                    error = std::max(error, errors[ry * grid_size + rx]);
+                }
+                float& middle = errors[(y0 + my) * grid_size + x0 + mx];
+                middle = std::max(middle, error);
             }
         }
     }
 }
 
-inline void ModelModule::FillTris(const vector<int>& face,
-        VertexGroup (&group)[3]) {
-    for (int i = 0; i < 3; ++i) {
-        const int vertex_idx = face[i];
-        auto& vertex = group[i];
-        vertex.v_idx =  vertex_idx;
-        vertex.vt_idx = vertex_idx;
-        vertex.vn_idx = vertex_idx;
+void ModelModule::FillAreaLodFaces(Model3d& model, const Range& range) const {
+    const int   side = range.right - range.left;
+    const int   column_size = side + 1;
+    const float max_error = settings_.model.lod.max_error;
+    auto& indices = model.indices;
+
+    struct Triangle {
+        int ax, ay, bx, by, cx, cy;
+    };
+    vector<Triangle> stack = {
+        { side, side, 0, 0, 0, side },
+        { 0, 0, side, side, side, 0 }
+    };
+    while (!stack.empty()) {
+        const Triangle t = stack.back();
+        stack.pop_back();
+        const int mx = (t.ax + t.bx) / 2;
+        const int my = (t.ay + t.by) / 2;
+        const bool is_smallest = std::abs(t.ax - t.cx) +
+                                 std::abs(t.ay - t.cy) <= 1;
+        if (!is_smallest &&
+                lod_errors_(range.left + mx, range.top + my) > max_error) {
+            stack.push_back({ t.bx, t.by, t.cx, t.cy, mx, my });
+            stack.push_back({ t.cx, t.cy, t.ax, t.ay, mx, my });
+            continue;
+        }
+
+        // Vertexes are stored column by column, winding is the same as in
+        // full resolution faces.
+        const uint32_t a = t.ax * column_size + t.ay;
+        uint32_t b = t.bx * column_size + t.by;
+        uint32_t c = t.cx * column_size + t.cy;
+        const int orientation = (t.bx - t.ax) * (t.cy - t.ay) -
+                                (t.by - t.ay) * (t.cx - t.ax);
+        if (orientation > 0) {
+            std::swap(b, c);
+        }
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
     }
 }
 
@@ -1,52 +1,120 @@
 #include "model.h"
 
+#include "utils/types_converter.h"
+
 namespace prowogene {
 namespace modules {
 
 using std::string;
 using utils::JsonValue;
 using utils::JsonObject;
+using TC = utils::TypesConverter;
 
 static const string kChunksEnabled =    "chunks_enabled";
 static const string kMinimapEnabled =   "complex_enabled";
 static const string kMaterialsEnabled = "materials_enabled";
 static const string kUVEnabled =        "uv_enabled";
+static const string kUVLocal =          "uv_local";
 static const string kNormalsEnabled =   "normals_enabled";
+static const string kNormalsPacked =    "normals_packed";
 static const string kEdgeSize =         "edge_size";
 static const string kMapHeight =        "map_height";
 static const string kCoordFormat =      "coord_format";
+static const string kQuantization =     "quantization_enabled";
+static const string kTopology =         "topology";
+static const string kLod =              "lod";
+static const string kLodEnabled =       "enabled";
+static const string kLodMaxError =      "max_error";
+static const string kLevels =           "levels";
+static const string kLevelsCount =      "count";
+static const string kLevelsSkirtDepth = "skirt_depth";
+static const string kStreamBandSize =   "stream_band_size";
+static const string kHeightfield =      "heightfield";
+static const string kFieldEnabled =     "enabled";
+static const string kFieldHalfFloat =   "half_float";
+static const string kFieldOverlap =     "overlap";
+static const string kLevelPostfix =     "_lod";
 
 void ModelSettings::Deserialize(JsonObject config) {
+    JsonObject sub_config;
     chunks_enabled =    config[kChunksEnabled];
     uv_enabled =        config[kUVEnabled];
+    uv_local =          config[kUVLocal];
     normals_enabled =   config[kNormalsEnabled];
+    normals_packed =    config[kNormalsPacked];
     materials_enabled = config[kMaterialsEnabled];
     complex_enabled =   config[kMinimapEnabled];
     edge_size =         config[kEdgeSize];
     map_height =        config[kMapHeight];
     coord_format =      config[kCoordFormat].Str();
+    quantization_enabled = config[kQuantization];
+    topology =          TC::To<MeshTopology>(config[kTopology]);
+    sub_config = config[kLod];
+    lod.enabled =   sub_config[kLodEnabled];
+    lod.max_error = sub_config[kLodMaxError];
+    sub_config = config[kLevels];
+    levels.count =       sub_config[kLevelsCount];
+    levels.skirt_depth = sub_config[kLevelsSkirtDepth];
+    stream_band_size =   config[kStreamBandSize];
+    sub_config = config[kHeightfield];
+    heightfield.enabled =    sub_config[kFieldEnabled];
+    heightfield.half_float = sub_config[kFieldHalfFloat];
+    heightfield.overlap =    sub_config[kFieldOverlap];
 }
 
 JsonObject ModelSettings::Serialize() const {
     JsonObject config;
     config[kChunksEnabled] =    chunks_enabled;
     config[kUVEnabled] =        uv_enabled;
+    config[kUVLocal] =          uv_local;
     config[kNormalsEnabled] =   normals_enabled;
+    config[kNormalsPacked] =    normals_packed;
     config[kMaterialsEnabled] = materials_enabled;
     config[kMinimapEnabled] =   complex_enabled;
     config[kEdgeSize] =         edge_size;
     config[kMapHeight] =        map_height;
     config[kCoordFormat] =      coord_format;
+    config[kQuantization] =     quantization_enabled;
+    config[kTopology] =         TC::ToString(topology);
+    JsonObject json_lod;
+    json_lod[kLodEnabled] =  lod.enabled;
+    json_lod[kLodMaxError] = lod.max_error;
+    config[kLod] = json_lod;
+    JsonObject json_levels;
+    json_levels[kLevelsCount] =      levels.count;
+    json_levels[kLevelsSkirtDepth] = levels.skirt_depth;
+    config[kLevels] = json_levels;
+    config[kStreamBandSize] = stream_band_size;
+    JsonObject json_heightfield;
+    json_heightfield[kFieldEnabled] =   heightfield.enabled;
+    json_heightfield[kFieldHalfFloat] = heightfield.half_float;
+    json_heightfield[kFieldOverlap] =   heightfield.overlap;
+    config[kHeightfield] = json_heightfield;
     return config;
 }
 
 void ModelSettings::Check() const {
     CheckCondition(map_height > 0.0f - kEps, "map_height is less than 0.0");
+    if (lod.enabled) {
+        CheckCondition(lod.max_error > 0.0f - kEps,
+                       "lod.max_error is less than 0.0");
+    }
+    CheckCondition(levels.count >= 0, "levels.count is less than 0");
+    CheckCondition(levels.skirt_depth > 0.0f - kEps,
+                   "levels.skirt_depth is less than 0.0");
+    CheckCondition(stream_band_size >= 0, "stream_band_size is less than 0");
 }
 
 string ModelSettings::GetName() const {
     return kConfigModel;
 }
 
+string ModelSettings::GetLevelName(const string& name, int level) const {
+    if (!level) {
+        return name;
+    }
+    return name + kLevelPostfix + std::to_string(level);
+}
+
 } // namespace modules
 } // namespace prowogene
@@ -16,6 +16,7 @@ static const string kMinimapModel =   "model";
 static const string kMinimapNormal =  "normal";
 static const string kLocationMap =    "location_map";
 static const string kComplexMap =     "complex_map";
+static const string kAtlas =          "atlas";
 
 void NamesSettings::Deserialize(JsonObject config) {
     heightmap = config[kHeightMap].Str();
@@ -27,12 +28,14 @@ void NamesSettings::Deserialize(JsonObject config) {
     minimap.model =   sub_config[kMinimapModel].Str();
     minimap.normal =  sub_config[kMinimapNormal].Str();
     location_map = config[kLocationMap].Str();
+    atlas = config[kAtlas].Str();
 }
 
 JsonObject NamesSettings::Serialize() const {
     JsonObject config;
     config[kHeightMap] =   heightmap;
     config[kLocationMap] = location_map;
+    config[kAtlas] =       atlas;
     config[kTexture] = texture.Serialize();
     config[kNormal] =  normal.Serialize();
     config[kChunk] =   chunk.Serialize();
@@ -38,6 +38,8 @@ struct NamesSettings : ISettings {
     } minimap;
     /** Location map image filename. */
     std::string location_map = "locations";
+    /** Texture atlas filename. */
+    std::string atlas = "atlas";
 };
 
 } // namespace modules
@@ -14,6 +14,14 @@ static const string kThreadCount =     "thread_count";
 static const string kExtensions =      "extensions";
 static const string kExtensionsImage = "image";
 static const string kExtensionsModel = "model";
+static const string kIO =              "io";
+static const string kIOThreadCount =   "thread_count";
+static const string kIOQueueSize =     "queue_size";
+static const string kIOMemoryBudget =  "memory_budget";
+static const string kStorage =         "storage";
+static const string kStorageMapped =   "mapped_threshold";
+static const string kStorageDir =      "directory";
+static const string kStorageHuge =     "huge_pages";
 
 void SystemSettings::Deserialize(JsonObject config) {
     search_depth = config[kSearchDepth];
@@ -22,6 +30,14 @@ void SystemSettings::Deserialize(JsonObject config) {
     JsonObject json_ext = config[kExtensions];
     extensions.image = json_ext[kExtensionsImage].Str();
     extensions.model = json_ext[kExtensionsModel].Str();
+    JsonObject json_io = config[kIO];
+    io.thread_count =  json_io[kIOThreadCount];
+    io.queue_size =    json_io[kIOQueueSize];
+    io.memory_budget = json_io[kIOMemoryBudget];
+    JsonObject json_storage = config[kStorage];
+    storage.mapped_threshold = json_storage[kStorageMapped];
+    storage.directory =        json_storage[kStorageDir].Str();
+    storage.huge_pages =       json_storage[kStorageHuge];
 }
 
 JsonObject SystemSettings::Serialize() const {
@@ -32,9 +48,29 @@ JsonObject SystemSettings::Serialize() const {
     json_ext[kExtensionsImage] = extensions.image;
     json_ext[kExtensionsModel] = extensions.model;
     config[kExtensions] = json_ext;
+    JsonObject json_io;
+    json_io[kIOThreadCount] =  io.thread_count;
+    json_io[kIOQueueSize] =    io.queue_size;
+    json_io[kIOMemoryBudget] = io.memory_budget;
+    config[kIO] = json_io;
+    JsonObject json_storage;
+    json_storage[kStorageMapped] = storage.mapped_threshold;
+    json_storage[kStorageDir] =    storage.directory;
+    json_storage[kStorageHuge] =   storage.huge_pages;
+    config[kStorage] = json_storage;
     return config;
 }
 
+void SystemSettings::Check() const {
+    CheckCondition(io.thread_count >= 0, "io.thread_count is less than 0");
+    if (io.thread_count) {
+        CheckCondition(io.queue_size > 0, "io.queue_size is less than 1");
+    }
+    CheckCondition(io.memory_budget >= 0, "io.memory_budget is less than 0");
+    CheckCondition(storage.mapped_threshold >= 0,
+                   "storage.mapped_threshold is less than 0");
+}
+
 string SystemSettings::GetName() const {
     return kConfigSystem;
 }
@@ -17,6 +17,8 @@ struct SystemSettings : ISettings {
     utils::JsonObject Serialize() const override;
     /** @copydoc ISettings::GetName */
     std::string GetName() const override;
+    /** @copydoc ISettings::Check */
+    void Check() const override;
     /** Detects when thread_count is set to 0 and set it to real thread count
     on device and set their count. That function is called inside Deserialize
     method, but when filling this settings manually, That method must be
@@ -36,6 +38,35 @@ struct SystemSettings : ISettings {
         /** File extensions for models. */
         std::string model = "obj";
     } extensions;
+    /** Output files writing settings. */
+    struct {
+        /** Count of threads that write output files while computing threads
+        go on. 0 means files are written by computing threads themselves.
+        [0, ...). */
+        int thread_count = 0;
+        /** Maximal count of files waiting for writing. When queue is full,
+        computing threads wait for I/O threads. [1, ...). */
+        int queue_size = 16;
+        /** Maximal size of data waiting for writing and being written in
+        megabytes. When it's exceeded, computing threads wait for I/O
+        threads. 0 means no limit. [0, ...). */
+        int memory_budget = 0;
+    } io;
+
+    /** Storage of big maps. */
+    struct {
+        /** Maps of that size in megabytes or bigger are stored in
+        temporary files mapped to memory, so world can be bigger than
+        physical memory. 0 means all maps are stored in memory. [0, ...). */
+        int         mapped_threshold = 0;
+        /** Directory for temporary files of maps. Empty means system
+        temporary directory. */
+        std::string directory = "";
+        /** Ask the OS to use huge pages for mapped maps. Has effect only
+        on Linux when directory is on tmpfs and transparent huge pages are
+        enabled for shared memory, other file systems ignore it. */
+        bool        huge_pages = false;
+    } storage;
 };
 
 } // namespace modules
@@ -1,11 +1,17 @@
 #ifndef PROGOGENE_CORE_TEXTURE_H_
 #define PROGOGENE_CORE_TEXTURE_H_
 
+#include <future>
+#include <memory>
+#include <mutex>
+
 #include "names_settings.h"
 #include "system_settings.h"
 #include "modules/basis.h"
 #include "utils/image_io.h"
 #include "utils/random.h"
+#include "utils/texture_atlas.h"
+#include "utils/texture_cache.h"
 
 namespace prowogene {
 namespace modules {
@@ -39,6 +45,10 @@ struct TextureSettings : ISettings {
 
     /** Save height map. */
     bool height_map_enabled = false;
+    /** Height map file format. Empty means image format from system
+    settings with 8 bit per height. Also @c "pgm" , @c "r16" , @c "r16f"
+    and @c "r32" are allowed, see utils::ImageIOParams::format. */
+    std::string height_map_format;
     /** Save images for all chunks. */
     bool chunks_enabled = false;
     /** Minimap settings. */
@@ -52,6 +62,24 @@ struct TextureSettings : ISettings {
         smooth, but that requiers more time to process. */
         bool clear_edges = true;
     } minimap;
+    /** Mipmaps settings for chunk textures. */
+    struct {
+        /** Save mip chain for every chunk texture or not. */
+        bool      enabled = false;
+        /** Filter for downscaling each next level. */
+        MipFilter filter = MipFilter::Box;
+        /** Save all levels to single image or to separate files. Packed
+        image has level 0 on the left side and all next levels placed one
+        under another on the right side. */
+        bool      packed = false;
+    } mipmaps;
+    /** Texture atlas settings. */
+    struct {
+        /** Save chunk textures, normal maps and mipmaps as tiles of single
+        atlas file instead of separate images. Minimap is saved as usual
+        image. See utils::TextureAtlas for file format. */
+        bool enabled = false;
+    } atlas;
     /** Normal map settings. */
     struct {
         /** Save normal maps for all textures or not. */
@@ -60,6 +88,9 @@ struct TextureSettings : ISettings {
         float strength = 0.5f;
         /** Invert vectors directions on normal maps. */
         bool  invert = false;
+        /** Data used for normal maps creation. Height map gives normals
+        that match on chunk borders. */
+        NormalSource source = NormalSource::Texture;
     } normals;
     /** Texture splatting settings. */
     struct {
@@ -92,6 +123,13 @@ struct TextureSettings : ISettings {
         float strength = 0.0f;
         /** Angle from that light point will shine. [0, 360]. */
         int   angle = 0;
+        /** Shadow creation method. */
+        ShadowMethod method = ShadowMethod::Simple;
+        /** Sun elevation above horizon in degrees for hillshade method.
+        (0, 90]. */
+        float elevation = 45.0f;
+        /** Add shadows cast by hills for hillshade method. */
+        bool  horizon = false;
     } shadow;
     /** Output images bitdepth. */
     int target_bitdepth = 24;
@@ -128,6 +166,16 @@ struct TextureSettings : ISettings {
             /** Beach biome decals. */
             std::vector<std::string> beach = { };
         } decals;
+        /** Cache of decoded and resized images with their heights. Entries
+        are reused by next runs while images and scaling settings are the
+        same. */
+        struct {
+            /** Use cache or not. */
+            bool        enabled = false;
+            /** Directory for cache entries, it's created when missing.
+            Empty string means current directory. */
+            std::string directory = "";
+        } cache;
     } images;
 };
 
@@ -136,7 +184,10 @@ struct TextureSettings : ISettings {
 Creates minimap, chunk textures, normal maps and height map. */
 class TextureModule : public IModule {
  public:
-    /** @copydoc IModule::Deinit. */
+    /** @copydoc IModule::Deinit.
+
+    Waits until all queued images are written, unless generator waits for
+    I/O executor. */
     virtual void Deinit();
     /** @copydoc IModule::Process */
     void Process() override;
@@ -148,16 +199,34 @@ class TextureModule : public IModule {
     std::string GetName() const override;
 
  protected:
-    /** Read input images according to selected filenames.
-    @return @c true when all images are loaded, @c false otherwise. */
+    /** Read input images according to selected filenames. Uses images
+    cache when it is enabled. */
     virtual void ReadReferenceTextures();
 
+    /** Read and prepare single reference texture with it's decals.
+    @param [in] filename         - Texture filename.
+    @param [in] decal_filenames  - Decals filenames.
+    @param [out] texture         - Prepared texture.
+    @param [out] decals          - Prepared decals.
+    @param [out] heights         - Heights of prepared texture. */
+    virtual void PrepareReferenceTexture(
+            const std::string& filename,
+            const std::vector<std::string>& decal_filenames,
+            utils::Image& texture,
+            std::vector<utils::Image>& decals,
+            utils::Array2D<float>& heights) const;
+
     /** Init bands for splatting textures according to biomes. */
     virtual void InitAlphaBands();
 
     /** Init gradient. */
     virtual void InitGradient();
 
+    /** Init shade map for hillshade shadows. Computed once for whole
+    height map, so shadow creation cost doesn't depend on textures
+    resolution. */
+    virtual void InitShadeMap();
+
     /** Get height of pixel from selected chunk.
     @param [in] ch_x - Chunk X coordinate.
     @param [in] ch_x - Chunk Y coordinate.
@@ -201,6 +270,12 @@ class TextureModule : public IModule {
     @param [in] x            - chunk X coordinate.
     @param [in] y            - chunk Y coordinate. */
     virtual void AddShadow(utils::Image& texture, int x, int y);
+
+    /** Add shadow from shade map to texture.
+    @param [in, out] texture - Texture to add shadow.
+    @param [in] x            - chunk X coordinate.
+    @param [in] y            - chunk Y coordinate. */
+    virtual void AddHillshade(utils::Image& texture, int x, int y) const;
     
     /** Draw chunk on minimap.
     @param [in] img   - Texture to draw.
@@ -254,11 +329,77 @@ class TextureModule : public IModule {
     /** Save height map to file. */
     virtual void SaveHeightMap();
 
-    /** Save chunk to file.
-    @param [in] texture - Chunk texture to save.
+    /** Save chunk texture and it's normal map to files. Writing is done
+    asynchronously by I/O executor.
+    @param [in] texture - Chunk texture to save. Pass moved value when
+                          texture isn't needed by caller anymore.
+    @param [in] x       - chunk X coordinate.
+    @param [in] y       - chunk Y coordinate. */
+    virtual void SaveChunk(utils::Image texture, int x, int y) const;
+
+    /** Submit image saving to I/O executor. Image is owned by task until
+    it's saved.
+    @param [in] image  - Image to save.
+    @param [in] params - Saving params. */
+    virtual void QueueImage(utils::Image&& image,
+                            const utils::ImageIOParams& params) const;
+
+    /** Submit writing of chunk image to texture atlas to I/O executor.
+    @param [in] image - Image to save.
+    @param [in] layer - Atlas layer, texture or normal map.
+    @param [in] x     - chunk X coordinate.
+    @param [in] y     - chunk Y coordinate.
+    @param [in] level - Mip level. */
+    virtual void QueueTile(utils::Image&& image,
+                           int layer, int x, int y, int level) const;
+
+    /** Create texture atlas for all chunks.
+    @param [in] resolution - Chunk texture resolution. */
+    virtual void OpenAtlas(int resolution);
+
+    /** Wait for atlas tile tasks and write offset table of texture atlas. */
+    virtual void CloseAtlas();
+
+    /** Wait for all I/O tasks when nobody else waits for them, that is
+    when wait isn't deferred to owner of I/O executor. */
+    virtual void WaitImages();
+
+    /** Get resolution of chunk textures.
+    @return Width and height of chunk texture in pixels. */
+    virtual int GetChunkResolution() const;
+
+    /** Save mip chain of chunk texture. Level 0 isn't saved, because it's
+    the texture itself.
+    @param [in] texture - Chunk texture.
     @param [in] x       - chunk X coordinate.
     @param [in] y       - chunk Y coordinate. */
-    virtual void SaveChunk(const utils::Image& texture, int x, int y) const;
+    virtual void SaveMipmaps(const utils::Image& texture, int x, int y) const;
+
+    /** Create full mip chain for image.
+    @param [in] texture - Level 0 image.
+    @param [in] filter  - Downscaling filter.
+    @param [out] levels - All levels from 1 to 1x1 pixel image. */
+    static void CreateMipChain(const utils::Image& texture,
+                               MipFilter filter,
+                               std::vector<utils::Image>& levels);
+
+    /** Downscale image twice with box filter.
+    @param [in] src  - Source image.
+    @param [out] dst - Downscaled image. */
+    static void MipBox(const utils::Image& src, utils::Image& dst);
+
+    /** Downscale image twice with Kaiser-windowed sinc filter.
+    @param [in] src  - Source image.
+    @param [out] dst - Downscaled image. */
+    static void MipKaiser(const utils::Image& src, utils::Image& dst);
+
+    /** Pack mip chain to single image.
+    @param [in] texture - Level 0 image.
+    @param [in] levels  - Next levels.
+    @param [out] packed - Packed image. */
+    static void PackMipChain(const utils::Image& texture,
+                             const std::vector<utils::Image>& levels,
+                             utils::Image& packed);
 
     /** Scale image up.
     @param [in] texture - Texture to scale.
@@ -346,6 +487,26 @@ class TextureModule : public IModule {
                              float coef,
                              utils::Image& normal);
 
+    /** Create normal map for square part of height map. Height map is
+    bilinearly upscaled to normal map resolution, gradients are taken by
+    Sobel operator. Values outside of height map are wrapped, so normal maps
+    of neighbour parts match on their borders.
+    @param [in] height_map - Height map.
+    @param [in] left       - Left border of part on height map.
+    @param [in] top        - Top border of part on height map.
+    @param [in] cells      - Size of part on height map.
+    @param [in] resolution - Size of normal map in pixels.
+    @param [in] invert     - Invert normals or not.
+    @param [in] coef       - Normal map coeficient.
+    @param [out] normal    - result normal map. */
+    static void CreateHeightNormal(const utils::Array2D<float>& height_map,
+                                   int left,
+                                   int top,
+                                   int cells,
+                                   int resolution,
+                                   bool invert,
+                                   float coef,
+                                   utils::Image& normal);
 
     /** Gradient pixel table. */
     std::vector<utils::RgbaPixel>           grad_table_;
@@ -359,6 +520,14 @@ class TextureModule : public IModule {
     std::vector<std::vector<utils::Image> > reference_decals_;
     /** Minimap image. */
     utils::Image                            minimap_;
+    /** Shadow opacity for every height map cell. */
+    utils::Array2D<float>                   shade_map_;
+    /** Atlas for chunk textures, @c nullptr when atlas is disabled. */
+    std::shared_ptr<utils::AtlasWriter>     atlas_;
+    /** Results of atlas tile tasks. */
+    mutable std::vector<std::future<void> > atlas_writes_;
+    /** Guard for atlas_writes_. */
+    mutable std::mutex                      atlas_mutex_;
 
  public:
     /** Height map from data storage. */
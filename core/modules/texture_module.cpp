@@ -2,14 +2,17 @@
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <string>
 #include <functional>
+#include <future>
 #include <thread>
 #include <tuple>
 #include <utility>
 
 #include "utils/array2d.h"
 #include "utils/array2d_tools.h"
+#include "utils/parallel_for.h"
 #include "utils/types_converter.h"
 #include "utils/range.h"
 
@@ -24,16 +27,116 @@ using std::thread;
 using std::tuple;
 using std::vector;
 using utils::Array2D;
+using utils::AtlasLayout;
+using utils::AtlasWriter;
 using utils::Image;
+using utils::ImageCodec;
 using utils::ImageIO;
 using utils::ImageIOParams;
+using utils::ParallelFor;
 using utils::Random;
 using utils::Range;
 using utils::RgbaPixel;
+using utils::TextureAtlas;
+using utils::TextureCache;
 using AT = utils::Array2DTools;
 using TC = utils::TypesConverter;
 
 static const int kAlphaBandAccuracy = 4096;
+static const string kMipPostfix = "_mip";
+static const string kPackedMipPostfix = "_mips";
+static const int kAtlasTextureLayer = 0;
+static const int kAtlasNormalLayer = 1;
+static const int kKaiserTaps = 8;
+static const float kKaiserAlpha = 4.0f;
+static const float kKaiserWidth = 2.0f;
+
+// Modified Bessel function of the first kind of order 0.
+static float BesselI0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    const float half_sqr = x * x / 4.0f;
+    for (int k = 1; k < 32; ++k) {
+        term *= half_sqr / static_cast<float>(k * k);
+        sum += term;
+        if (term < sum * kEps) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Weights of Kaiser-windowed sinc for downscaling twice. Tap i is applied
+// to source pixel (2 * x - kKaiserTaps / 2 + 1 + i) of destination pixel x.
+static const vector<float>& KaiserWeights() {
+    static const vector<float> weights = [] {
+        const float pi = 3.14159265358979f;
+        vector<float> out(kKaiserTaps);
+        float sum = 0.0f;
+        for (int i = 0; i < kKaiserTaps; ++i) {
+            const float dist = (i - (kKaiserTaps - 1) / 2.0f) / 2.0f;
+            const float sinc = std::sin(pi * dist) / (pi * dist);
+            const float ratio = dist / kKaiserWidth;
+            const float window = BesselI0(kKaiserAlpha *
+                                          std::sqrt(1.0f - ratio * ratio)) /
+                                 BesselI0(kKaiserAlpha);
+            out[i] = sinc * window;
+            sum += out[i];
+        }
+        for (auto& weight : out) {
+            weight /= sum;
+        }
+        return out;
+    }();
+    return weights;
+}
+
+// Position of pixel on height map for bilinear upscaling.
+struct UpscaleSample {
+    // Cell before pixel center.
+    int   low;
+    // Cell after pixel center.
+    int   high;
+    // Distance from low cell center to pixel center.
+    float coef;
+};
+
+// Get positions of pixels [first_px, first_px + count) on wrapped height map
+// line when the line part starting from first_cell is upscaled px_per_cell
+// times.
+static vector<UpscaleSample> GetUpscaleSamples(int first_cell, int map_size,
+        int first_px, int count, float px_per_cell) {
+    vector<UpscaleSample> samples(count);
+    for (int i = 0; i < count; ++i) {
+        const float pos = first_cell +
+                          (first_px + i + 0.5f) / px_per_cell - 0.5f;
+        const float low = std::floor(pos);
+        int idx = static_cast<int>(low) % map_size;
+        idx = idx < 0 ? idx + map_size : idx;
+        samples[i].low = idx;
+        samples[i].high = idx + 1 < map_size ? idx + 1 : 0;
+        samples[i].coef = pos - low;
+    }
+    return samples;
+}
+
+// Bilinearly upscale one row of height map.
+static void UpscaleRow(const Array2D<float>& map,
+        const vector<UpscaleSample>& cols, const UpscaleSample& row,
+        float* out) {
+    const int map_width = map.Width();
+    const float* low = map.Data() + row.low * map_width;
+    const float* high = map.Data() + row.high * map_width;
+    const int count = static_cast<int>(cols.size());
+    for (int i = 0; i < count; ++i) {
+        const UpscaleSample& col = cols[i];
+        const float h_low = low[col.low] +
+                            (low[col.high] - low[col.low]) * col.coef;
+        const float h_high = high[col.low] +
+                             (high[col.high] - high[col.low]) * col.coef;
+        out[i] = h_low + (h_high - h_low) * row.coef;
+    }
+}
 
 void TextureModule::Process() {
     const int size = settings_.general.size;
@@ -48,6 +151,16 @@ void TextureModule::Process() {
             !settings_.texture.minimap.enabled) {
         return;
     }
+    const auto& texture = settings_.texture;
+    const bool in_atlas = texture.chunks_enabled && texture.atlas.enabled;
+    if (texture.minimap.enabled || !in_atlas) {
+        const string& format = settings_.system.extensions.image;
+        const ImageCodec* codec = image_io_->GetCodec(format);
+        if (!codec || !codec->Caps().encode) {
+            throw LogicException("Image format '" + format +
+                                 "' can't be used for textures.");
+        }
+    }
     try {
         ReadReferenceTextures();
     }
@@ -60,10 +173,18 @@ void TextureModule::Process() {
         }
     }
 
+    if (in_atlas) {
+        OpenAtlas(GetChunkResolution());
+    }
+
     InitAlphaBands();
     if (settings_.texture.gradient.enabled) {
         InitGradient();
     }
+    const auto& shadow = settings_.texture.shadow;
+    if (shadow.enabled && shadow.method == ShadowMethod::Hillshade) {
+        InitShadeMap();
+    }
     if (settings_.texture.minimap.enabled) {
         int minimap_size = settings_.texture.minimap.tile_size;
         minimap_size *= chunks_count;
@@ -81,20 +202,35 @@ void TextureModule::Process() {
         block_size = 1;
     }
 
+    // Exception can't leave thread, so it's rethrown after all threads are
+    // joined.
     vector<thread> threads(treads_count);
+    vector<std::exception_ptr> errors(treads_count);
     for (int i = 0; i < treads_count; ++i) {
         const int beg = i * block_size;
         int end = (i + 1) * block_size;
         if (i == threads.size() - 1) {
             end = chunks_count;
         }
-        threads[i] = thread(&TextureModule::ProcessTiles, this, beg, end);
+        threads[i] = thread([this, beg, end, i, &errors]() {
+            try {
+                ProcessTiles(beg, end);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
     }
     for (int i = 0; i < treads_count; ++i) {
         if (threads[i].joinable()) {
             threads[i].join();
         }
     }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
 
     if (settings_.texture.minimap.enabled) {
         ImageIOParams params;
@@ -102,24 +238,49 @@ void TextureModule::Process() {
         params.bit_depth = settings_.texture.target_bitdepth;
         params.format = settings_.system.extensions.image;
         params.quality = 0;
-        image_io_->Save(minimap_, params);
-        if (settings_.texture.normals.enabled) {
+        params.thread_count = settings_.system.thread_count;
+        const auto& normals = settings_.texture.normals;
+        if (normals.enabled) {
             Image normal;
-            CreateNormal(minimap_, settings_.texture.normals.invert,
-                         settings_.texture.normals.strength, normal);
-            params.filename = settings_.names.minimap.normal;
-            image_io_->Save(normal, params);
+            if (normals.source == NormalSource::HeightMap) {
+                CreateHeightNormal(*height_map_, 0, 0, size,
+                                   minimap_.Width(), normals.invert,
+                                   normals.strength, normal);
+            } else {
+                CreateNormal(minimap_, normals.invert, normals.strength,
+                             normal);
+            }
+            ImageIOParams normal_params = params;
+            normal_params.filename = settings_.names.minimap.normal;
+            normal_params.is_normal_map = true;
+            QueueImage(std::move(normal), normal_params);
         }
+        QueueImage(std::move(minimap_), params);
+    }
+
+    if (atlas_) {
+        CloseAtlas();
     }
+    WaitImages();
 }
 
 void TextureModule::Deinit() {
+    try {
+        WaitImages();
+    }
+    catch (const std::exception&) {
+        // Process is already failed and its error is reported.
+    }
+    atlas_writes_.clear();
+    atlas_.reset();
+
     grad_table_.clear();
     alpha_bands_.clear();
     reference_textures_.clear();
     reference_textures_heights_.clear();
     reference_decals_.clear();
     minimap_.Clear();
+    shade_map_.Clear();
 }
 
 list<string> TextureModule::GetNeededSettings() const {
@@ -145,9 +306,10 @@ std::string TextureModule::GetName() const {
 }
 
 void TextureModule::ReadReferenceTextures() {
-    const int tile_size = settings_.texture.minimap.tile_size;
+    const auto& minimap = settings_.texture.minimap;
     const auto& img_bases = settings_.texture.images.bases;
     const auto& img_decals = settings_.texture.images.decals;
+    const auto& img_cache = settings_.texture.images.cache;
 
     const int biomes_count = TC::ToInt(Biome::Count);
     reference_textures_.resize(biomes_count);
@@ -163,55 +325,199 @@ void TextureModule::ReadReferenceTextures() {
     };
     const int info_count = static_cast<int>(info.size());
 
+    std::unique_ptr<TextureCache> cache;
+    string cache_params;
+    if (img_cache.enabled) {
+        cache.reset(new TextureCache(img_cache.directory));
+        if (!cache->MakeDirectory()) {
+            throw LogicException("Can't create texture cache directory '" +
+                                 img_cache.directory + "'.");
+        }
+        const bool scaled = !settings_.texture.chunks_enabled &&
+                            minimap.enabled;
+        cache_params = scaled ? std::to_string(minimap.tile_size) + "_" +
+                                std::to_string(minimap.clear_edges) :
+                                "original";
+    }
+
     for (int i = 0; i < info_count; ++i) {
         const int idx = TC::ToInt(std::get<0>(info[i]));
         auto& texture = reference_textures_[idx];
         auto& decals = reference_decals_[idx];
+        auto& heights = reference_textures_heights_[idx];
 
-        texture = image_io_->Load(std::get<1>(info[idx]));
-        if (!texture.Size()) {
-            throw LogicException("Can't load image '" + std::get<1>(info[idx]) + "'.");
+        const string& filename = std::get<1>(info[idx]);
+        vector<string> decal_filenames;
+        if (img_decals.enabled) {
+            decal_filenames = std::get<2>(info[idx]);
         }
 
-        const auto& decal_list = std::get<2>(info[idx]);
-        const int decals_count = settings_.texture.images.decals.enabled ?
-                                 static_cast<int>(decal_list.size()) :
-                                 0;
-        decals.resize(decals_count);
-        for (int j = 0; j < decals_count; ++j) {
-            decals[j] = image_io_->Load(decal_list[j]);
-            if (!decals[j].Size()) {
-                throw LogicException("Can't load image '" + decal_list[j] + "'.");
+        string key;
+        if (cache) {
+            vector<string> files = decal_filenames;
+            files.insert(files.begin(), filename);
+            if (cache->GetKey(files, cache_params, key) &&
+                    cache->Load(key, texture, decals, heights)) {
+                continue;
             }
         }
 
-        int resolution = texture.Width();
-        if (!settings_.texture.chunks_enabled &&
-            settings_.texture.minimap.enabled) {
-            const bool clear_edges = settings_.texture.minimap.clear_edges;
-            int scale_coef = resolution / tile_size;
-            if (!scale_coef) {
-                ScaleUpImage(texture, tile_size / resolution);
-                resolution = texture.Width();
-                scale_coef = 1;
-            } else {
-                ScaleDownImage(texture, scale_coef, clear_edges);
-                resolution /= scale_coef;
-            }
+        PrepareReferenceTexture(filename, decal_filenames,
+                                texture, decals, heights);
+        if (!key.empty()) {
+            cache->Store(key, texture, decals, heights);
+        }
+    }
+}
 
-            for (int j = 0; j < decals_count; ++j) {
-                ScaleDownImage(decals[j], scale_coef, clear_edges);
-            }
+void TextureModule::PrepareReferenceTexture(const string& filename,
+        const vector<string>& decal_filenames, Image& texture,
+        vector<Image>& decals, Array2D<float>& heights) const {
+    const int tile_size = settings_.texture.minimap.tile_size;
+    // Decals are decoded by I/O executor while texture is loaded.
+    vector<std::future<Image> > loading;
+    for (const string& decal_filename : decal_filenames) {
+        loading.push_back(image_io_->LoadAsync(decal_filename));
+    }
+    texture = image_io_->Load(filename);
+    if (!texture.Size()) {
+        throw LogicException("Can't load image '" + filename + "'.");
+    }
+
+    const int decals_count = static_cast<int>(decal_filenames.size());
+    decals.resize(decals_count);
+    for (int j = 0; j < decals_count; ++j) {
+        decals[j] = loading[j].get();
+        if (!decals[j].Size()) {
+            throw LogicException("Can't load image '" + decal_filenames[j] + "'.");
         }
+    }
 
-        auto& heights = reference_textures_heights_[idx];
-        heights.Resize(resolution, resolution);
-        for (int x = 0; x < resolution; ++x) {
-            for (int y = 0; y < resolution; ++y) {
-                heights(x, y) = static_cast<float>(GetHeight(texture(x, y)));
+    int resolution = texture.Width();
+    if (!settings_.texture.chunks_enabled &&
+        settings_.texture.minimap.enabled) {
+        const bool clear_edges = settings_.texture.minimap.clear_edges;
+        int scale_coef = resolution / tile_size;
+        if (!scale_coef) {
+            ScaleUpImage(texture, tile_size / resolution);
+            resolution = texture.Width();
+            scale_coef = 1;
+        } else {
+            ScaleDownImage(texture, scale_coef, clear_edges);
+            resolution /= scale_coef;
+        }
+
+        for (int j = 0; j < decals_count; ++j) {
+            ScaleDownImage(decals[j], scale_coef, clear_edges);
+        }
+    }
+
+    heights.Resize(resolution, resolution);
+    for (int x = 0; x < resolution; ++x) {
+        for (int y = 0; y < resolution; ++y) {
+            heights(x, y) = static_cast<float>(GetHeight(texture(x, y)));
+        }
+    }
+}
+
+void TextureModule::InitShadeMap() {
+    const auto& shadow = settings_.texture.shadow;
+    const Array2D<float>& hm = *height_map_;
+    const int width = hm.Width();
+    const int height = hm.Height();
+    const int thread_count = settings_.system.thread_count;
+    shade_map_.Resize(width, height, 0.0f);
+    if (!width || !height) {
+        return;
+    }
+
+    // Heights are measured in height map cells, height 1.0 is map width.
+    const float pi = 3.14159265358979f;
+    const float azimuth = shadow.angle * pi / 180.0f;
+    const float elevation = shadow.elevation * pi / 180.0f;
+    const float light_x = std::cos(elevation) * std::cos(azimuth);
+    const float light_y = -std::cos(elevation) * std::sin(azimuth);
+    const float light_z = std::sin(elevation);
+    const float scale = width / 2.0f;
+
+    // Flat surface has no shadow, surface turned away from sun has full one.
+    ParallelFor(height, thread_count, [&](int beg, int end) {
+        for (int y = beg; y < end; ++y) {
+            const float* top = hm.Data() + ((y + height - 1) % height) * width;
+            const float* row = hm.Data() + y * width;
+            const float* bot = hm.Data() + ((y + 1) % height) * width;
+            float* out = shade_map_.Data() + y * width;
+            for (int x = 0; x < width; ++x) {
+                const int l = x ? x - 1 : width - 1;
+                const int r = x + 1 < width ? x + 1 : 0;
+                const float nx = (row[l] - row[r]) * scale;
+                const float ny = (top[x] - bot[x]) * scale;
+                const float light = (nx * light_x + ny * light_y + light_z) /
+                                    std::sqrt(nx * nx + ny * ny + 1.0f);
+                out[x] = std::max(0.0f, std::min(1.0f, 1.0f - light / light_z));
             }
         }
+    });
+
+    if (!shadow.horizon) {
+        return;
     }
+
+    // Cells are swept by parallel lines going away from sun. Every line
+    // keeps upper convex hull of passed cells, so it's top is the highest
+    // horizon point for current cell. Lines are shifted by one cell across
+    // main direction, so every cell is visited exactly once.
+    const float away_x = -std::cos(azimuth);
+    const float away_y = std::sin(azimuth);
+    const bool major_x = std::fabs(away_x) >= std::fabs(away_y);
+    const float major = major_x ? away_x : away_y;
+    const float slope = (major_x ? away_y : away_x) / std::fabs(major);
+    const int major_step = major > 0.0f ? 1 : -1;
+    const int major_size = major_x ? width : height;
+    const int minor_size = major_x ? height : width;
+    const int major_first = major_step > 0 ? 0 : major_size - 1;
+    const int extra = static_cast<int>(std::ceil(std::fabs(slope) *
+                                                 major_size)) + 1;
+    const float step_length = std::sqrt(1.0f + slope * slope);
+    const float tan_elevation = std::tan(elevation);
+    const float height_scale = static_cast<float>(width);
+
+    ParallelFor(minor_size + 2 * extra, thread_count, [&](int beg, int end) {
+        vector<pair<float, float> > hull;
+        for (int line = beg; line < end; ++line) {
+            hull.clear();
+            const float minor_first = static_cast<float>(line - extra);
+            for (int k = 0; k < major_size; ++k) {
+                const int minor = static_cast<int>(
+                    std::floor(minor_first + slope * k + 0.5f));
+                if (minor < 0 || minor >= minor_size) {
+                    continue;
+                }
+                const int pos = major_first + major_step * k;
+                const int x = major_x ? pos : minor;
+                const int y = major_x ? minor : pos;
+                const float dist = k * step_length;
+                const float h = hm(x, y) * height_scale;
+
+                while (hull.size() > 1) {
+                    const auto& a = hull[hull.size() - 2];
+                    const auto& b = hull.back();
+                    if ((a.second - h) * (dist - b.first) <
+                            (b.second - h) * (dist - a.first)) {
+                        break;
+                    }
+                    hull.pop_back();
+                }
+                if (!hull.empty()) {
+                    const auto& b = hull.back();
+                    if (b.second - h > tan_elevation * (dist - b.first)) {
+                        shade_map_(x, y) = 1.0f;
+                    }
+                }
+                hull.push_back({ dist, h });
+            }
+        }
+    });
 }
 
 void TextureModule::InitAlphaBands() {
@@ -326,13 +632,18 @@ void TextureModule::ProcessTiles(int line_beg, int line_end) {
     const int tile_size = settings_.texture.minimap.tile_size;
 
     Random rand(settings_.general.seed + line_beg);
-    const int resolution = settings_.texture.gradient.opacity < 1.0f - kEps ?
-                           reference_textures_[0].Width() :
-                           settings_.texture.minimap.tile_size;
+    const int resolution = GetChunkResolution();
     Image texture(resolution, resolution);
 
+    // Chunk texture is needed after saving only for minimap drawing. In other
+    // cases it's moved to output queue without copying.
+    const bool keep_saved = settings_.texture.minimap.enabled;
+
     for (int x = line_beg; x < line_end; ++x) {
         for (int y = 0; y < chunks_count; ++y) {
+            if (texture.Width() != resolution) {
+                texture.Resize(resolution, resolution);
+            }
             if (!gradient.enabled || gradient.opacity < 1.0f - kEps) {
                 TextureSplatting(texture, x, y);
             }
@@ -344,18 +655,20 @@ void TextureModule::ProcessTiles(int line_beg, int line_end) {
 
             AddDecal(cur_biome, texture, rand);
             if (gradient.only_minimap) {
-                SaveChunk(texture, x, y);
+                SaveChunk(keep_saved ? Image(texture) : std::move(texture),
+                          x, y);
             }
             if (gradient.enabled && gradient.opacity > kEps) {
                 AddGradient(texture, x, y);
             }
             if (!gradient.only_minimap) {
-                SaveChunk(texture, x, y);
+                SaveChunk(keep_saved ? Image(texture) : std::move(texture),
+                          x, y);
             }
             if (settings_.texture.shadow.enabled) {
                 AddShadow(texture, x, y);
             }
-            DrawOnMinimap(texture, resolution / tile_size, x, y);
+            DrawOnMinimap(std::move(texture), resolution / tile_size, x, y);
         }
     }
 }
@@ -452,6 +765,10 @@ void TextureModule::AddGradient(Image &tex, int x, int y) const {
 }
 
 void TextureModule::AddShadow(Image& texture, int x, int y) {
+    if (settings_.texture.shadow.method == ShadowMethod::Hillshade) {
+        AddHillshade(texture, x, y);
+        return;
+    }
     const float strength = settings_.texture.shadow.strength;
     const int angle = settings_.texture.shadow.angle % 360;
 
@@ -493,6 +810,29 @@ void TextureModule::AddShadow(Image& texture, int x, int y) {
     }
 }
 
+void TextureModule::AddHillshade(Image& texture, int x, int y) const {
+    const float strength = settings_.texture.shadow.strength;
+    const int chunk_size = settings_.general.chunk_size;
+    const int resolution = texture.Width();
+    const float px_per_cell = static_cast<float>(resolution) / chunk_size;
+
+    const vector<UpscaleSample> cols = GetUpscaleSamples(
+        x * chunk_size, shade_map_.Width(), 0, resolution, px_per_cell);
+    const vector<UpscaleSample> rows = GetUpscaleSamples(
+        y * chunk_size, shade_map_.Height(), 0, resolution, px_per_cell);
+    vector<float> shade(resolution);
+
+    RgbaPixel pixel(0, 0, 0, 0);
+    for (int v = 0; v < resolution; ++v) {
+        UpscaleRow(shade_map_, cols, rows[v], shade.data());
+        RgbaPixel* row = texture.Data() + v * resolution;
+        for (int u = 0; u < resolution; ++u) {
+            pixel.alpha = static_cast<uint8_t>(shade[u] * strength * 255.0f);
+            row[u] = AlphaBlendPixel(row[u], pixel);
+        }
+    }
+}
+
 void TextureModule::DrawOnMinimap(Image texture, int scale,
         int chunk_x, int chunk_y) {
     if (settings_.texture.minimap.enabled) {
@@ -599,12 +939,26 @@ void TextureModule::SaveHeightMap() {
     ImageIOParams params;
     params.filename = settings_.names.heightmap;
     params.bit_depth = settings_.texture.target_bitdepth;
-    params.format = settings_.system.extensions.image;
+    params.format = settings_.texture.height_map_format;
+    if (params.format.empty()) {
+        params.format = settings_.system.extensions.image;
+    }
+    const ImageCodec* codec = image_io_->GetCodec(params.format);
+    if (!codec || !codec->Caps().encode_height_map) {
+        throw LogicException("Image format '" + params.format +
+                             "' can't be used for height map.");
+    }
     params.quality = 0;
-    image_io_->SaveHeightMap(*height_map_, params);
+    params.thread_count = settings_.system.thread_count;
+    // Height codecs stream rows, so map is written right away instead of
+    // copying it for I/O executor.
+    if (!image_io_->SaveHeightMap(*height_map_, params)) {
+        throw LogicException("Can't write height map '" + params.filename +
+                             "." + params.format + "'.");
+    }
 }
 
-void TextureModule::SaveChunk(const Image &tex, int x, int y) const {
+void TextureModule::SaveChunk(Image tex, int x, int y) const {
     const auto& names = settings_.names;
     const auto& texture = settings_.texture;
     const auto& normals = texture.normals;
@@ -615,16 +969,268 @@ void TextureModule::SaveChunk(const Image &tex, int x, int y) const {
         params.format = settings_.system.extensions.image;
         params.bit_depth = 24;
         params.quality = 0;
-        image_io_->Save(tex, params);
         if (normals.enabled) {
             Image normal_map;
-            CreateNormal(tex, normals.invert, normals.strength, normal_map);
-            params.filename = names.normal.Apply(x, y);
-            image_io_->Save(normal_map, params);
+            if (normals.source == NormalSource::HeightMap) {
+                const int chunk_size = settings_.general.chunk_size;
+                CreateHeightNormal(*height_map_, x * chunk_size,
+                                   y * chunk_size, chunk_size, tex.Width(),
+                                   normals.invert, normals.strength,
+                                   normal_map);
+            } else {
+                CreateNormal(tex, normals.invert, normals.strength,
+                             normal_map);
+            }
+            if (atlas_) {
+                QueueTile(std::move(normal_map), kAtlasNormalLayer, x, y, 0);
+            } else {
+                ImageIOParams normal_params = params;
+                normal_params.filename = names.normal.Apply(x, y);
+                normal_params.is_normal_map = true;
+                QueueImage(std::move(normal_map), normal_params);
+            }
+        }
+        if (texture.mipmaps.enabled) {
+            SaveMipmaps(tex, x, y);
+        }
+        if (atlas_) {
+            QueueTile(std::move(tex), kAtlasTextureLayer, x, y, 0);
+        } else {
+            QueueImage(std::move(tex), params);
+        }
+    }
+}
+
+void TextureModule::QueueImage(Image&& image,
+        const ImageIOParams& params) const {
+    image_io_->SaveAsync(std::move(image), params);
+}
+
+void TextureModule::QueueTile(Image&& image, int layer, int x, int y,
+        int level) const {
+    const std::shared_ptr<AtlasWriter> atlas = atlas_;
+    const size_t bytes = static_cast<size_t>(image.Width()) *
+                         image.Height() * sizeof(RgbaPixel);
+    const std::shared_ptr<Image> owned = std::make_shared<Image>(
+        std::move(image));
+    std::future<void> write = image_io_->GetExecutor()->Submit(
+        [atlas, owned, layer, x, y, level]() {
+            if (!atlas->Write(*owned, layer, x, y, level)) {
+                throw LogicException("Can't write chunk " +
+                                     std::to_string(x) + "x" +
+                                     std::to_string(y) +
+                                     " to texture atlas.");
+            }
+        }, bytes);
+    std::lock_guard<std::mutex> lock(atlas_mutex_);
+    atlas_writes_.push_back(std::move(write));
+}
+
+void TextureModule::OpenAtlas(int resolution) {
+    const auto& texture = settings_.texture;
+    AtlasLayout layout;
+    layout.count_x = settings_.general.size / settings_.general.chunk_size;
+    layout.count_y = layout.count_x;
+    layout.tile_size = resolution;
+    layout.layers = texture.normals.enabled ? 2 : 1;
+    layout.channels = 3;
+    layout.levels = 1;
+    if (texture.mipmaps.enabled) {
+        for (int side = resolution; side > 1; side >>= 1) {
+            ++layout.levels;
+        }
+    }
+
+    const string filename = settings_.names.atlas + "." +
+                            TextureAtlas::kExtension;
+    atlas_ = std::make_shared<AtlasWriter>();
+    if (!atlas_->Open(filename, layout)) {
+        atlas_.reset();
+        throw LogicException("Can't create texture atlas '" + filename +
+                             "'.");
+    }
+}
+
+void TextureModule::CloseAtlas() {
+    // Offset table marks written tiles, so all tile tasks must be completed.
+    // Other files are still written while next modules go on.
+    for (auto& write : atlas_writes_) {
+        write.get();
+    }
+    atlas_writes_.clear();
+    const bool is_closed = atlas_->Close();
+    atlas_.reset();
+    if (!is_closed) {
+        throw LogicException("Can't write texture atlas '" +
+                             settings_.names.atlas + "." +
+                             TextureAtlas::kExtension + "'.");
+    }
+}
+
+void TextureModule::WaitImages() {
+    utils::IOExecutor* executor = image_io_->GetExecutor();
+    if (!executor->IsWaitDeferred()) {
+        executor->Wait();
+    }
+}
+
+int TextureModule::GetChunkResolution() const {
+    return settings_.texture.gradient.opacity < 1.0f - kEps ?
+           reference_textures_[0].Width() :
+           settings_.texture.minimap.tile_size;
+}
+
+void TextureModule::SaveMipmaps(const Image& tex, int x, int y) const {
+    const auto& mipmaps = settings_.texture.mipmaps;
+    vector<Image> levels;
+    CreateMipChain(tex, mipmaps.filter, levels);
+    const int levels_count = static_cast<int>(levels.size());
+    if (atlas_) {
+        for (int i = 0; i < levels_count; ++i) {
+            QueueTile(std::move(levels[i]), kAtlasTextureLayer, x, y, i + 1);
+        }
+        return;
+    }
+
+    ImageIOParams params;
+    params.format = settings_.system.extensions.image;
+    params.bit_depth = 24;
+    params.quality = 0;
+    const string name = settings_.names.texture.Apply(x, y);
+    if (mipmaps.packed) {
+        Image packed;
+        PackMipChain(tex, levels, packed);
+        params.filename = name + kPackedMipPostfix;
+        QueueImage(std::move(packed), params);
+        return;
+    }
+
+    for (int i = 0; i < levels_count; ++i) {
+        params.filename = name + kMipPostfix + std::to_string(i + 1);
+        QueueImage(std::move(levels[i]), params);
+    }
+}
+
+void TextureModule::CreateMipChain(const Image& texture, MipFilter filter,
+        vector<Image>& levels) {
+    int count = 0;
+    int side = std::max(texture.Width(), texture.Height());
+    while (side > 1) {
+        side >>= 1;
+        ++count;
+    }
+
+    levels.clear();
+    levels.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const Image& src = i ? levels[i - 1] : texture;
+        if (filter == MipFilter::Kaiser) {
+            MipKaiser(src, levels[i]);
+        } else {
+            MipBox(src, levels[i]);
         }
     }
 }
 
+void TextureModule::MipBox(const Image& src, Image& dst) {
+    const int src_width = src.Width();
+    const int src_height = src.Height();
+    const int width = std::max(1, src_width / 2);
+    const int height = std::max(1, src_height / 2);
+    dst.Resize(width, height);
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src.Data());
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst.Data());
+    for (int y = 0; y < height; ++y) {
+        const int y_top = std::min(2 * y,     src_height - 1);
+        const int y_bot = std::min(2 * y + 1, src_height - 1);
+        const uint8_t* top = in + y_top * src_width * 4;
+        const uint8_t* bot = in + y_bot * src_width * 4;
+        uint8_t* row = out + y * width * 4;
+        for (int x = 0; x < width; ++x) {
+            const int l = std::min(2 * x,     src_width - 1) * 4;
+            const int r = std::min(2 * x + 1, src_width - 1) * 4;
+            for (int c = 0; c < 4; ++c) {
+                const int sum = top[l + c] + top[r + c] +
+                                bot[l + c] + bot[r + c];
+                row[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+void TextureModule::MipKaiser(const Image& src, Image& dst) {
+    const vector<float>& weights = KaiserWeights();
+    const int first_tap = 1 - kKaiserTaps / 2;
+    const int src_width = src.Width();
+    const int src_height = src.Height();
+    const int width = std::max(1, src_width / 2);
+    const int height = std::max(1, src_height / 2);
+    dst.Resize(width, height);
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src.Data());
+    vector<float> horizontal(width * src_height * 4, 0.0f);
+    for (int y = 0; y < src_height; ++y) {
+        const uint8_t* src_row = in + y * src_width * 4;
+        float* row = horizontal.data() + y * width * 4;
+        for (int x = 0; x < width; ++x) {
+            for (int i = 0; i < kKaiserTaps; ++i) {
+                int pos = 2 * x + first_tap + i;
+                pos = std::min(src_width - 1, std::max(0, pos)) * 4;
+                for (int c = 0; c < 4; ++c) {
+                    row[x * 4 + c] += src_row[pos + c] * weights[i];
+                }
+            }
+        }
+    }
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst.Data());
+    const int row_size = width * 4;
+    vector<float> sum(row_size);
+    for (int y = 0; y < height; ++y) {
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (int i = 0; i < kKaiserTaps; ++i) {
+            int pos = 2 * y + first_tap + i;
+            pos = std::min(src_height - 1, std::max(0, pos));
+            const float* row = horizontal.data() + pos * row_size;
+            for (int j = 0; j < row_size; ++j) {
+                sum[j] += row[j] * weights[i];
+            }
+        }
+        uint8_t* dst_row = out + y * row_size;
+        for (int j = 0; j < row_size; ++j) {
+            const float val = std::min(255.0f, std::max(0.0f, sum[j] + 0.5f));
+            dst_row[j] = static_cast<uint8_t>(val);
+        }
+    }
+}
+
+void TextureModule::PackMipChain(const Image& texture,
+        const vector<Image>& levels, Image& packed) {
+    const int width = texture.Width();
+    const int height = texture.Height();
+    const int right_width = levels.empty() ? 0 : levels[0].Width();
+    packed.Resize(width + right_width, height);
+
+    const int packed_width = packed.Width();
+    auto copy = [&packed, packed_width](const Image& img, int x, int y) {
+        const int img_width = img.Width();
+        const int rows = std::min(img.Height(), packed.Height() - y);
+        for (int j = 0; j < rows; ++j) {
+            const RgbaPixel* src = img.Data() + j * img_width;
+            RgbaPixel* dst = packed.Data() + (y + j) * packed_width + x;
+            std::copy(src, src + img_width, dst);
+        }
+    };
+
+    copy(texture, 0, 0);
+    int y = 0;
+    for (const auto& level : levels) {
+        copy(level, width, y);
+        y += level.Height();
+    }
+}
+
 void TextureModule::ScaleUpImage(Image& texture, int n) {
     if (n < 2) {
         return;
@@ -784,5 +1390,76 @@ void TextureModule::CreateNormal(const Image& img, bool invert,
     }
 }
 
+void TextureModule::CreateHeightNormal(const Array2D<float>& height_map,
+        int left, int top, int cells, int resolution, bool invert,
+        float coef, Image& normal) {
+    if (normal.Width() != resolution || normal.Height() != resolution) {
+        normal.Resize(resolution, resolution);
+    }
+    const int map_width = height_map.Width();
+    const int map_height = height_map.Height();
+    if (!resolution || !cells || !map_width || !map_height) {
+        return;
+    }
+
+    // Sobel operator gives gradient multiplied by 8 in pixels, it's
+    // converted to height map cells. Height 1.0 is treated as height map
+    // width, so normals don't depend on textures resolution.
+    const float px_per_cell = static_cast<float>(resolution) / cells;
+    float scale = coef * map_width * px_per_cell / 8.0f;
+    if (invert) {
+        scale *= -1;
+    }
+
+    // Upscaled heights are computed for one extra pixel from every side.
+    const int row_size = resolution + 2;
+    const vector<UpscaleSample> cols =
+        GetUpscaleSamples(left, map_width, -1, row_size, px_per_cell);
+    const vector<UpscaleSample> rows =
+        GetUpscaleSamples(top, map_height, -1, row_size, px_per_cell);
+    auto upscale_row = [&](int idx, float* out) {
+        UpscaleRow(height_map, cols, rows[idx], out);
+    };
+
+    // Only three upscaled rows are kept at once.
+    vector<float> buffer(row_size * 3);
+    float* prev = buffer.data();
+    float* cur = prev + row_size;
+    float* next = cur + row_size;
+    upscale_row(0, prev);
+    upscale_row(1, cur);
+
+    vector<float> dx(resolution);
+    vector<float> dy(resolution);
+    vector<float> inv_len(resolution);
+    for (int v = 0; v < resolution; ++v) {
+        upscale_row(v + 2, next);
+        for (int u = 0; u < resolution; ++u) {
+            const float gx = (prev[u + 2] + 2.0f * cur[u + 2] + next[u + 2]) -
+                             (prev[u] +     2.0f * cur[u] +     next[u]);
+            const float gy = (next[u] + 2.0f * next[u + 1] + next[u + 2]) -
+                             (prev[u] + 2.0f * prev[u + 1] + prev[u + 2]);
+            dx[u] = -gx * scale;
+            dy[u] = -gy * scale;
+            inv_len[u] = 1.0f / std::sqrt(dx[u] * dx[u] + dy[u] * dy[u] + 1.0f);
+        }
+
+        RgbaPixel* pixels = normal.Data() + v * resolution;
+        for (int u = 0; u < resolution; ++u) {
+            RgbaPixel& pixel = pixels[u];
+            const float inv = inv_len[u];
+            pixel.red =   static_cast<uint8_t>(128.0f + 127.0f * dx[u] * inv);
+            pixel.green = static_cast<uint8_t>(128.0f - 127.0f * dy[u] * inv);
+            pixel.blue =  static_cast<uint8_t>(128.0f + 127.0f * inv);
+            pixel.alpha = 255;
+        }
+
+        float* tmp = prev;
+        prev = cur;
+        cur = next;
+        next = tmp;
+    }
+}
+
 } // namespace modules
 } // namespace prowogene
@@ -1,5 +1,7 @@
 #include "texture.h"
 
+#include "utils/types_converter.h"
+
 namespace prowogene {
 namespace modules {
 
@@ -10,17 +12,26 @@ using utils::JsonObject;
 using utils::JsonArray;
 using utils::RgbaPixel;
 using GradientPoint = std::pair<RgbaPixel, float>;
+using TC = utils::TypesConverter;
 
 static const string kHeightmapEnabled =     "heightmap_enabled";
+static const string kHeightmapFormat =      "heightmap_format";
 static const string kChunksEnabled =        "chunks_enabled";
 static const string kMinimap =              "minimap";
 static const string kMinimapEnabled =       "enabled";
 static const string kMinimapTileSize =      "tile_size";
 static const string kMinimapClearEdges =    "clear_edges";
+static const string kMipmaps =              "mipmaps";
+static const string kMipmapsEnabled =       "enabled";
+static const string kMipmapsFilter =        "filter";
+static const string kMipmapsPacked =        "packed";
+static const string kAtlas =                "atlas";
+static const string kAtlasEnabled =         "enabled";
 static const string kNormals =              "normals";
 static const string kNormalsEnabled =       "enabled";
 static const string kNormalsInvert =        "invert";
 static const string kNormalsStrength =      "strength";
+static const string kNormalsSource =        "source";
 static const string kSplatting =            "splatting";
 static const string kSplattingDepth =       "depth";
 static const string kSplattingBandwidth =   "bandwidth";
@@ -34,6 +45,9 @@ static const string kShadow =               "shadow";
 static const string kShadowEnabled =        "enabled";
 static const string kShadowStrength =       "strength";
 static const string kShadowAngle =          "angle";
+static const string kShadowMethod =         "method";
+static const string kShadowElevation =      "elevation";
+static const string kShadowHorizon =        "horizon";
 static const string kTargetBitDepth =       "target_bitdepth";
 static const string kImages =               "images";
 static const string kImagesBases =          "bases";
@@ -50,20 +64,31 @@ static const string kImagesDecalsBasis =    "basis";
 static const string kImagesDecalsSea =      "sea";
 static const string kImagesDecalsRiver =    "river";
 static const string kImagesDecalsBeach =    "beach";
+static const string kImagesCache =          "cache";
+static const string kImagesCacheEnabled =   "enabled";
+static const string kImagesCacheDirectory = "directory";
 
 void TextureSettings::Deserialize(JsonObject config) {
     JsonObject sub_config;
     height_map_enabled = config[kHeightmapEnabled];
+    height_map_format =  config[kHeightmapFormat].Str();
     chunks_enabled =     config[kChunksEnabled];
     target_bitdepth =    config[kTargetBitDepth];
     sub_config = config[kMinimap];
     minimap.enabled =     sub_config[kMinimapEnabled];
     minimap.tile_size =   sub_config[kMinimapTileSize];
     minimap.clear_edges = sub_config[kMinimapClearEdges];
+    sub_config = config[kMipmaps];
+    mipmaps.enabled = sub_config[kMipmapsEnabled];
+    mipmaps.filter =  TC::To<MipFilter>(sub_config[kMipmapsFilter]);
+    mipmaps.packed =  sub_config[kMipmapsPacked];
+    sub_config = config[kAtlas];
+    atlas.enabled = sub_config[kAtlasEnabled];
     sub_config = config[kNormals];
     normals.enabled =  sub_config[kNormalsEnabled];
     normals.strength = sub_config[kNormalsStrength];
     normals.invert =   sub_config[kNormalsInvert];
+    normals.source =   TC::To<NormalSource>(sub_config[kNormalsSource]);
     sub_config = config[kSplatting];
     splatting.depth =      sub_config[kSplattingDepth];
     splatting.bandwidth =  sub_config[kSplattingBandwidth];
@@ -77,6 +102,9 @@ void TextureSettings::Deserialize(JsonObject config) {
     shadow.enabled =  sub_config[kShadowEnabled];
     shadow.strength = sub_config[kShadowStrength];
     shadow.angle =    sub_config[kShadowAngle];
+    shadow.method =   TC::To<ShadowMethod>(sub_config[kShadowMethod]);
+    shadow.elevation = sub_config[kShadowElevation];
+    shadow.horizon =  sub_config[kShadowHorizon];
     sub_config = config[kImages];
     JsonObject json_images = sub_config[kImagesBases];
     auto& bases = images.bases;
@@ -94,11 +122,15 @@ void TextureSettings::Deserialize(JsonObject config) {
     decals.sea =      GetDecals(json_images[kImagesDecalsSea]);
     decals.river =    GetDecals(json_images[kImagesDecalsRiver]);
     decals.beach =    GetDecals(json_images[kImagesDecalsBeach]);
+    json_images = sub_config[kImagesCache];
+    images.cache.enabled =   json_images[kImagesCacheEnabled];
+    images.cache.directory = json_images[kImagesCacheDirectory].Str();
 }
 
 JsonObject TextureSettings::Serialize() const {
     JsonObject config;
     config[kHeightmapEnabled] = height_map_enabled;
+    config[kHeightmapFormat] = height_map_format;
     config[kChunksEnabled] = chunks_enabled;
     config[kTargetBitDepth] = target_bitdepth;
     JsonObject json_minimap;
@@ -106,10 +138,19 @@ JsonObject TextureSettings::Serialize() const {
     json_minimap[kMinimapEnabled] =    minimap.tile_size;
     json_minimap[kMinimapClearEdges] = minimap.clear_edges;
     config[kMinimap] = json_minimap;
+    JsonObject json_mipmaps;
+    json_mipmaps[kMipmapsEnabled] = mipmaps.enabled;
+    json_mipmaps[kMipmapsFilter] =  TC::ToString(mipmaps.filter);
+    json_mipmaps[kMipmapsPacked] =  mipmaps.packed;
+    config[kMipmaps] = json_mipmaps;
+    JsonObject json_atlas;
+    json_atlas[kAtlasEnabled] = atlas.enabled;
+    config[kAtlas] = json_atlas;
     JsonObject json_normals;
     json_normals[kNormalsEnabled] =  normals.enabled;
     json_normals[kNormalsStrength] = normals.strength;
     json_normals[kNormalsInvert] =   normals.invert;
+    json_normals[kNormalsSource] =   TC::ToString(normals.source);
     config[kNormals] = json_normals;
     JsonObject json_splatting;
     json_splatting[kSplattingDepth] =      splatting.depth;
@@ -126,6 +167,9 @@ JsonObject TextureSettings::Serialize() const {
     json_shadow[kShadowEnabled] =  shadow.enabled;
     json_shadow[kShadowStrength] = shadow.strength;
     json_shadow[kShadowAngle] =    shadow.angle;
+    json_shadow[kShadowMethod] =   TC::ToString(shadow.method);
+    json_shadow[kShadowElevation] = shadow.elevation;
+    json_shadow[kShadowHorizon] =  shadow.horizon;
     config[kShadow] = json_shadow;
     JsonObject json_images;
     JsonObject json_bases;
@@ -145,6 +189,10 @@ JsonObject TextureSettings::Serialize() const {
     json_decals[kImagesDecalsRiver] =    SetDecals(decals.river);
     json_decals[kImagesDecalsBeach] =    SetDecals(decals.beach);
     json_images[kImagesDecals] = json_decals;
+    JsonObject json_cache;
+    json_cache[kImagesCacheEnabled] =   images.cache.enabled;
+    json_cache[kImagesCacheDirectory] = images.cache.directory;
+    json_images[kImagesCache] = json_cache;
     config[kImages] = json_images;
     return config;
 }
@@ -157,6 +205,10 @@ void TextureSettings::Check() const {
     CheckInRange(gradient.opacity,     0.f, 1.f, "gradient.opacity");
     CheckInRange(shadow.strength,      0.f, 1.f, "shadow.strength");
     CheckInRange(images.decals.chance, 0.f, 1.f, "normals.strength");
+    if (shadow.enabled && shadow.method == ShadowMethod::Hillshade) {
+        CheckCondition(shadow.elevation > 0.f && shadow.elevation <= 90.f,
+                       "shadow.elevation isn't in range (0, 90]");
+    }
     if (!minimap.enabled)
         return;
     CheckCondition(minimap.tile_size > 0, "minimap.tile_size is less than 1");
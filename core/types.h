@@ -157,6 +157,56 @@ typedef enum class _Location : unsigned char {
     Sea
 } Location;
 
+
+/** @brief File format of location map. */
+typedef enum class _LocationMapFormat : unsigned char {
+    /** 24 bit BMP image. */
+    Rgb,
+    /** 8 bit BMP image with palette of location colors. */
+    Indexed,
+    /** Run-length encoded locations with palette, see utils::RleMap. */
+    Rle
+} LocationMapFormat;
+
+
+/** @brief Type of filter for mipmaps creation. */
+typedef enum class _MipFilter : unsigned char {
+    /** Average of 2x2 pixels. */
+    Box,
+    /** Kaiser-windowed sinc. Keeps details sharper than box filter. */
+    Kaiser
+} MipFilter;
+
+
+/** @brief Source of data for normal maps creation. */
+typedef enum class _NormalSource : unsigned char {
+    /** Brightness of texture pixels. */
+    Texture,
+    /** Height map upscaled to texture resolution. */
+    HeightMap
+} NormalSource;
+
+
+/** @brief Method of minimap shadow creation. */
+typedef enum class _ShadowMethod : unsigned char {
+    /** Compare height with the same pixel of neighbour chunk. Supports only
+    angles that are multiple of 45 degrees. */
+    Simple,
+    /** Hillshade computed once for whole height map with any sun position,
+    optionally with shadows cast by hills. */
+    Hillshade
+} ShadowMethod;
+
+
+/** @brief Order of vertex indexes in 3D model. */
+typedef enum class _MeshTopology : unsigned char {
+    /** Every 3 indexes form separate triangle. */
+    Triangles,
+    /** Every index forms triangle with 2 previous ones. Strips are separated
+    by restart index. */
+    TriangleStrip
+} MeshTopology;
+
 } // namespace prowogene
 
 #endif // PROWOGENE_CORE_TYPES_H_
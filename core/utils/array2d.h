@@ -1,35 +1,66 @@
 #ifndef PROWOGENE_CORE_UTILS_ARRAY2D_H_
 #define PROWOGENE_CORE_UTILS_ARRAY2D_H_
 
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
 #include <vector>
 
+#include "utils/mapped_buffer.h"
+
 namespace prowogene {
 namespace utils {
 
-/** @brief 2D data storage. */
+/** @brief 2D data storage.
+
+Data is stored in heap memory. When size of trivially copyable data
+reaches MappedBuffer threshold, it's stored in temporary file mapped to
+memory, so array can be bigger than physical memory. Both storages are
+accessed the same way. */
 template<typename T>
 class Array2D {
  public:
     /** Constructor.
     @param [in] width - Width of 2D array.
     @param [in] height - Height of 2D array.
-    @param [in] val - Default value. */
+    @param [in] val - Default value.
+    @throw std::bad_alloc when memory can't be allocated. */
     Array2D(int width = 0, int height = 0, const T val = T()) {
         default_val_ = val;
         if (width || height) {
             Resize(width, height, val);
-        } else {
-            width_ =  0;
-            height_ = 0;
         }
     }
 
-    /** Copy constructor. */
+    /** Copy constructor.
+    @throw std::bad_alloc when memory can't be allocated. */
     Array2D(const Array2D& src) {
-        default_val_ = src.default_val_;
-        width_  = src.width_;
-        height_ = src.height_;
-        data_   = src.data_;
+        CopyFrom(src);
+    }
+
+    /** Move constructor. Source array becomes empty. */
+    Array2D(Array2D&& src) {
+        MoveFrom(src);
+    }
+
+    /** Copy assignment operator.
+    @throw std::bad_alloc when memory can't be allocated. */
+    Array2D& operator=(const Array2D& src) {
+        if (this != &src) {
+            CopyFrom(src);
+        }
+        return *this;
+    }
+
+    /** Move assignment operator. Source array becomes empty. */
+    Array2D& operator=(Array2D&& src) {
+        if (this != &src) {
+            MoveFrom(src);
+        }
+        return *this;
     }
 
     /** Get element in array by coordinates.
@@ -37,8 +68,8 @@ class Array2D {
     @param [in] h - Vertical position from left.*/
     virtual T& operator()(int w, int h) {
         if (w < width_ && h < height_) {
-            const int idx = h * width_ + w;
-            return data_[idx];
+            const size_t idx = static_cast<size_t>(h) * width_ + w;
+            return data_ptr_[idx];
         }
         return default_val_;
     }
@@ -46,8 +77,8 @@ class Array2D {
     /** @copydoc Array2D::operator()(int,int) */
     virtual const T& operator()(int w, int h) const {
         if (w < width_ && h < height_) {
-            const int idx = h * width_ + w;
-            return data_[idx];
+            const size_t idx = static_cast<size_t>(h) * width_ + w;
+            return data_ptr_[idx];
         }
         return default_val_;
     }
@@ -67,85 +98,173 @@ class Array2D {
     /** Get elements count.
     @return Elements count. */
     virtual size_t Size() const {
-        return data_.size();
+        return size_;
     }
 
     /** Get raw 2D array data. */
     virtual T* Data() {
-        return data_.data();
+        return data_ptr_;
     }
 
     /** @copydoc Array2D::Data() */
     virtual const T* Data() const {
-        return data_.data();
+        return data_ptr_;
+    }
+
+    /** Check that data is stored in temporary file.
+    @return @c true if data is mapped file, @c false if it's in heap. */
+    virtual bool IsMapped() const {
+        return mapped_.Data() != nullptr;
+    }
+
+    /** Tell the OS how data will be accessed. Does nothing for heap
+    storage.
+    @param [in] access - Expected access pattern. */
+    virtual void Advise(MemoryAccess access) const {
+        mapped_.Advise(access);
     }
 
     /** Resize array.
     @param [in] width  - Width of 2D array.
-    @param [in] height - Height of 2D array. */
+    @param [in] height - Height of 2D array.
+    @throw std::bad_alloc when memory can't be allocated. */
     virtual void Resize(int w, int h) {
         Resize(w, h, default_val_);
     }
 
-    /** Resize array with default value.
+    /** Resize array with default value. Array becomes empty when memory
+    can't be allocated.
     @param [in] width  - Width of 2D array.
     @param [in] height - Height of 2D array.
-    @param [in] val    - Default value. */
+    @param [in] val    - Default value.
+    @throw std::bad_alloc when memory can't be allocated. */
     virtual void Resize(int w, int h, T val) {
-        try {
-            if (w < 0) {
-                w = 0;
-            }
-            if (h < 0) {
-                h = 0;
+        if (w < 0) {
+            w = 0;
+        }
+        if (h < 0) {
+            h = 0;
+        }
+        Clear();
+        const size_t size = static_cast<size_t>(w) * h;
+        if (IsMappedSize(size)) {
+            AllocateMapped(size);
+            // Mapped file is already filled by zeros.
+            if (!IsZero(val)) {
+                std::fill(data_ptr_, data_ptr_ + size, val);
             }
-            data_.clear();
-            const int size = w * h;
+        } else {
             data_.resize(size, val);
-            width_ =  w;
-            height_ = h;
-        } catch (std::bad_alloc ba) {
-            width_ =  0;
-            height_ = 0;
+            data_ptr_ = data_.data();
         }
+        size_ = size;
+        width_ =  w;
+        height_ = h;
     }
 
     /** Clear array data. */
     virtual void Clear() {
         data_.clear();
+        mapped_.Release();
+        data_ptr_ = nullptr;
+        size_ = 0;
         width_ = 0;
         height_ = 0;
     }
 
     /** Get first iterator.
     @return First iterator. */
-    virtual typename std::vector<T>::iterator begin() {
-        return data_.begin();
+    virtual T* begin() {
+        return data_ptr_;
     }
 
     /** @copydoc Array2D::begin() */
-    virtual typename std::vector<T>::const_iterator begin() const {
-        return data_.begin();
+    virtual const T* begin() const {
+        return data_ptr_;
     }
 
     /** Get last iterator.
     @return Last iterator. */
-    virtual typename std::vector<T>::iterator end() {
-        return data_.end();
+    virtual T* end() {
+        return data_ptr_ + size_;
     }
 
     /** @copydoc Array2D::end() */
-    virtual typename std::vector<T>::const_iterator end() const {
-        return data_.end();
+    virtual const T* end() const {
+        return data_ptr_ + size_;
     }
 
  protected:
+    /** Check that elements must be stored in mapped file.
+    @param [in] size - Count of elements.
+    @return @c true if mapped file must be used, @c false otherwise. */
+    static bool IsMappedSize(size_t size) {
+        return std::is_trivially_copyable<T>::value &&
+               MappedBuffer::IsWanted(size * sizeof(T));
+    }
+
+    /** Check that all bytes of value are zero.
+    @param [in] val - Value to check.
+    @return @c true if value is zero, @c false otherwise. */
+    static bool IsZero(const T& val) {
+        static const unsigned char kZero[sizeof(T)] = {0};
+        return !memcmp(&val, kZero, sizeof(T));
+    }
+
+    /** Allocate mapped file for elements, heap memory is released.
+    @param [in] size - Count of elements. */
+    void AllocateMapped(size_t size) {
+        std::vector<T>().swap(data_);
+        if (!mapped_.Allocate(size * sizeof(T))) {
+            throw std::bad_alloc();
+        }
+        data_ptr_ = reinterpret_cast<T*>(mapped_.Data());
+    }
+
+    /** Copy data and sizes of other array.
+    @param [in] src - Source array. */
+    void CopyFrom(const Array2D& src) {
+        Clear();
+        default_val_ = src.default_val_;
+        if (IsMappedSize(src.size_)) {
+            AllocateMapped(src.size_);
+            std::copy(src.data_ptr_, src.data_ptr_ + src.size_, data_ptr_);
+        } else {
+            data_.assign(src.data_ptr_, src.data_ptr_ + src.size_);
+            data_ptr_ = data_.data();
+        }
+        size_ = src.size_;
+        width_ = src.width_;
+        height_ = src.height_;
+    }
+
+    /** Take data and sizes of other array, source array becomes empty.
+    @param [in] src - Source array. */
+    void MoveFrom(Array2D& src) {
+        default_val_ = src.default_val_;
+        data_ = std::move(src.data_);
+        mapped_ = std::move(src.mapped_);
+        data_ptr_ = src.data_ptr_;
+        size_ = src.size_;
+        width_ = src.width_;
+        height_ = src.height_;
+        src.data_ptr_ = nullptr;
+        src.Clear();
+    }
+
+
     /** Width of array. */
-    int            width_;
+    int            width_ = 0;
     /** Height of array. */
-    int            height_;
-    /** Array data. */
+    int            height_ = 0;
+    /** Count of elements. */
+    size_t         size_ = 0;
+    /** Array data in heap memory. */
     std::vector<T> data_;
+    /** Array data in mapped file. */
+    MappedBuffer   mapped_;
+    /** First element of data_ or mapped_. */
+    T*             data_ptr_ = nullptr;
     /** Default array value. */
     T              default_val_;
 };
@@ -4,6 +4,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <exception>
 #include <functional>
 #include <thread>
 
@@ -16,6 +17,37 @@ using std::thread;
 using std::vector;
 using Band = std::pair<size_t, size_t>;
 
+// Process every band by own thread. Exception can't leave thread, so the
+// first one is rethrown after all threads are joined.
+static void ProcessBands(const vector<Band>& bands,
+                         const std::function<void(int, int)>& func) {
+    const size_t count = bands.size();
+    vector<thread> threads(count);
+    vector<std::exception_ptr> errors(count);
+    for (size_t i = 0; i < count; ++i) {
+        const int beg = static_cast<int>(bands[i].first);
+        const int end = static_cast<int>(bands[i].second);
+        threads[i] = thread([&func, &errors, i, beg, end]() {
+            try {
+                func(beg, end);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& th : threads) {
+        if (th.joinable()) {
+            th.join();
+        }
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
 bool Array2DTools::DiamondSquare(Array2D<float> &arr, int size, int seed,
         int octave, float min_value, float max_value) {
     if ((size & (size - 1)) || octave > size) {
@@ -234,21 +266,11 @@ bool Array2DTools::ApplyFilter(Array2D<float> &arr, Operation overflow,
         return false;
     }
 
-    const vector<Band> bands = SplitIndices(thread_count, first.Size());
-    const int thread_size = static_cast<int>(bands.size());
-
-    vector<thread> threads(thread_size);
-    for (int i = 0; i < thread_size; ++i) {
-        threads[i] = thread(__ApplyFilter__, first.Data(), second.Data(),
-                            overflow, arr.Data(),
-                            static_cast<int>(bands[i].first),
-                            static_cast<int>(bands[i].second));
-    }
-    for (auto& th : threads) {
-        if (th.joinable()) {
-            th.join();
-        }
-    }
+    ProcessBands(SplitIndices(thread_count, first.Size()),
+                 [&](int beg, int end) {
+        __ApplyFilter__(first.Data(), second.Data(), overflow, arr.Data(),
+                        beg, end);
+    });
     return true;
 }
 
@@ -378,23 +400,15 @@ void Array2DTools::ToRange(Array2D<float> &arr, float min_v, float max_v,
         int thread_count) {
     float min = arr(0, 0);
     float max = arr(0, 0);
+    arr.Advise(MemoryAccess::Sequential);
     Array2DTools::GetMinMax(arr, min, max);
     max -= min;
 
-    const vector<Band> bands = SplitIndices(thread_count, arr.Size());
-    const int thread_size = static_cast<int>(bands.size());
-
-    vector<thread> threads(thread_size);
-    for (int i = 0; i < thread_size; ++i) {
-        threads[i] = thread(__ToRange__, arr.Data(), min_v, max_v, min, max,
-                                         static_cast<int>(bands[i].first),
-                                         static_cast<int>(bands[i].second));
-    }
-    for (auto& th : threads) {
-        if (th.joinable()) {
-            th.join();
-        }
-    }
+    ProcessBands(SplitIndices(thread_count, arr.Size()),
+                 [&](int beg, int end) {
+        __ToRange__(arr.Data(), min_v, max_v, min, max, beg, end);
+    });
+    arr.Advise(MemoryAccess::Normal);
 }
 
 void Array2DTools::ChangeRes(Array2D<float>& arr, int x, int y, float val) {
@@ -494,20 +508,10 @@ void Array2DTools::Smooth(Array2D<float>& arr, int radius, int thread_count) {
 
     Array2D<float> buffer = arr;
 
-    const vector<Band> bands = SplitIndices(thread_count, arr.Width());
-    const int thread_size = static_cast<int>(bands.size());
-
-    vector<thread> threads(thread_size);
-    for (int i = 0; i < thread_size; ++i) {
-        threads[i] = thread(__Smooth__, &arr, &buffer, &coefs, coef_sum, radius,
-                                        static_cast<int>(bands[i].first),
-                                        static_cast<int>(bands[i].second));
-    }
-    for (auto& th : threads) {
-        if (th.joinable()) {
-            th.join();
-        }
-    }
+    ProcessBands(SplitIndices(thread_count, arr.Width()),
+                 [&](int beg, int end) {
+        __Smooth__(&arr, &buffer, &coefs, coef_sum, radius, beg, end);
+    });
     arr = buffer;
 }
 
@@ -1,7 +1,14 @@
 #include "bmp.h"
 
+#include <limits.h>
 #include <string.h>
+
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
+#include <new>
+
+#include "utils/mapped_file.h"
 
 namespace prowogene {
 namespace utils {
@@ -16,8 +23,8 @@ using prowogene::utils::RgbaPixel;
 
 
 template <typename Type>
-static void Read(const vector<uint8_t>& data, int &pos, Type &result) {
-    memcpy(reinterpret_cast<char*>(&result), data.data() + pos, sizeof(Type));
+static void Read(const uint8_t* data, size_t &pos, Type &result) {
+    memcpy(reinterpret_cast<char*>(&result), data + pos, sizeof(Type));
     pos += sizeof(Type);
 }
 
@@ -35,180 +42,350 @@ static inline int GetPadding(int width, int bit_depth) {
     }
 }
 
+static void ConvertRow8(const uint8_t* src,
+                        const RgbaPixel* palette,
+                        int width,
+                        RgbaPixel* dst) {
+    for (int x = 0; x < width; ++x) {
+        dst[x] = palette[src[x]];
+    }
+}
+
+// Pixels are swizzled as whole 32bit words (BGRA to RGBA and back is swap
+// of the first and the third bytes), compiler vectorizes these loops.
+static inline uint32_t SwapRedBlue(uint32_t color) {
+    return (color & 0xFF00FF00U) |
+           ((color >> 16) & 0x000000FFU) |
+           ((color & 0x000000FFU) << 16);
+}
+
+static void ConvertRow24(const uint8_t* src, int width, RgbaPixel* dst) {
+    // 4 bytes are loaded for each pixel except the last one, so reading
+    // never goes outside of the row.
+    for (int x = 0; x < width - 1; ++x) {
+        uint32_t bgr = 0;
+        memcpy(&bgr, src + x * 3, sizeof(bgr));
+        const uint32_t rgba = SwapRedBlue(bgr) | 0xFF000000U;
+        memcpy(reinterpret_cast<uint8_t*>(dst) + x * 4, &rgba, sizeof(rgba));
+    }
+    const uint8_t* last = src + (width - 1) * 3;
+    dst[width - 1] = RgbaPixel(last[2], last[1], last[0], 255);
+}
+
+static void EncodeRow24(const RgbaPixel* src, int width, uint8_t* dst) {
+    // 4 bytes are stored for each pixel, extra byte is overwritten by the
+    // next pixel. The last one is stored by bytes to keep row padding.
+    for (int x = 0; x < width - 1; ++x) {
+        uint32_t rgba = 0;
+        memcpy(&rgba, src + x, sizeof(rgba));
+        const uint32_t bgra = SwapRedBlue(rgba);
+        memcpy(dst + x * 3, &bgra, sizeof(bgra));
+    }
+    uint8_t* last = dst + (width - 1) * 3;
+    last[0] = src[width - 1].blue;
+    last[1] = src[width - 1].green;
+    last[2] = src[width - 1].red;
+}
+
+static void EncodeRow32(const RgbaPixel* src, int width, uint8_t* dst) {
+    for (int x = 0; x < width; ++x) {
+        uint32_t rgba = 0;
+        memcpy(&rgba, src + x, sizeof(rgba));
+        const uint32_t bgra = SwapRedBlue(rgba);
+        memcpy(dst + x * 4, &bgra, sizeof(bgra));
+    }
+}
+
+static void ConvertRow32(const uint8_t* src, int width, RgbaPixel* dst) {
+    for (int x = 0; x < width; ++x) {
+        uint32_t bgra = 0;
+        memcpy(&bgra, src + x * 4, sizeof(bgra));
+        const uint32_t rgba = SwapRedBlue(bgra);
+        memcpy(reinterpret_cast<uint8_t*>(dst) + x * 4, &rgba, sizeof(rgba));
+    }
+}
+
 
-void Bmp::Encode(const string& file, const Image &data, int bits) {
+bool Bmp::Encode(const string& file, const Image &data, int bits) {
     switch (bits) {
     case 32:
-        WriteBmp<32>(file, data);
-        break;
+        return WriteBmp<32>(file, data);
     case 24:
     default:
-        WriteBmp<24>(file, data);
-        break;
+        return WriteBmp<24>(file, data);
     }
 };
 
-bool Bmp::Decode(const string& filename, Image &data) {
-    ifstream file(filename, ifstream::binary);
+bool Bmp::EncodeIndexed(const string& filename, const uint8_t* indices,
+        int width, int height, const vector<RgbaPixel>& palette) {
+    ofstream file;
+    file.open(filename, std::ios::binary);
     if (!file.is_open()) {
         return false;
     }
 
-    file.seekg(0, std::ios::end);
-    const size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    FileDump file_dump(size);
-    file.read((char*)file_dump.data(), size);
-    file.close();
+    const int colors_count = std::min<int>(
+        static_cast<int>(palette.size()), kPaletteSize);
+    const int palette_size = colors_count * 4;
+    const int padding = GetPadding(width, 8);
+    const int image_size = (width + padding) * height;
 
     BITMAPFILEHEADER bfh;
-    int pos = 0;
-    Read(file_dump, pos, bfh.bfType);
-    Read(file_dump, pos, bfh.bfSize);
-    Read(file_dump, pos, bfh.bfReserved1);
-    Read(file_dump, pos, bfh.bfReserved2);
-    Read(file_dump, pos, bfh.bfOffBits);
+    bfh.bfType = static_cast<WORD>(kBitmapType);
+    bfh.bfSize = kBitmapFileHeaderSize + kBitmapInfoHeaderSize +
+                 palette_size + image_size;
+    bfh.bfReserved1 = 0;
+    bfh.bfReserved2 = 0;
+    bfh.bfOffBits = kBitmapFileHeaderSize + kBitmapInfoHeaderSize +
+                    palette_size;
+
+    Write(file, bfh.bfType);
+    Write(file, bfh.bfSize);
+    Write(file, bfh.bfReserved1);
+    Write(file, bfh.bfReserved2);
+    Write(file, bfh.bfOffBits);
 
     BITMAPINFOHEADER bih;
-    DWORD red_mask = 0;
-    DWORD green_mask = 0;
-    DWORD blue_mask = 0;
-    DWORD alpha_mask = 0;
-    DWORD info_version = 0;
-    Read(file_dump, pos, info_version);
-
-    switch (info_version) {
-    case kBitmapCoreHeaderSize : {
-        BITMAPCOREHEADER bch;
-        bch.bcSize = info_version;
-        Read(file_dump, pos, bch.bcWidth);
-        Read(file_dump, pos, bch.bcHeight);
-        Read(file_dump, pos, bch.bcPlanes);
-        Read(file_dump, pos, bch.bcBitCount);
-
-        int align = 0;
-        if (bch.bcWidth % 4 != 0) {
-            align = 4 - bch.bcWidth % 4;
-        }
+    bih.biSize          = kBitmapInfoHeaderSize;
+    bih.biWidth         = width;
+    bih.biHeight        = height;
+    bih.biPlanes        = 1;
+    bih.biBitCount      = 8;
+    bih.biCompression   = kBiRGB;
+    bih.biSizeImage     = image_size;
+    bih.biXPelsPerMeter = 2000;
+    bih.biYPelsPerMeter = 2000;
+    bih.biClrUsed       = colors_count;
+    bih.biClrImportant  = 0;
+
+    Write(file, bih.biSize);
+    Write(file, bih.biWidth);
+    Write(file, bih.biHeight);
+    Write(file, bih.biPlanes);
+    Write(file, bih.biBitCount);
+    Write(file, bih.biCompression);
+    Write(file, bih.biSizeImage);
+    Write(file, bih.biXPelsPerMeter);
+    Write(file, bih.biYPelsPerMeter);
+    Write(file, bih.biClrUsed);
+    Write(file, bih.biClrImportant);
+
+    for (int i = 0; i < colors_count; ++i) {
+        const uint8_t quad[4] = {
+            palette[i].blue, palette[i].green, palette[i].red, 0
+        };
+        file.write(reinterpret_cast<const char*>(quad), sizeof(quad));
+    }
 
-        bih.biWidth =  std::abs(bch.bcWidth);
-        bih.biHeight = std::abs(bch.bcHeight);
-        bih.biPlanes = bch.bcPlanes;
-        bih.biBitCount = bch.bcBitCount;
-        bih.biCompression = kBiRGB;
-        bih.biSizeImage = (bch.bcWidth + align) * std::abs(bch.bcHeight);
-        bih.biXPelsPerMeter = 2000;
-        bih.biYPelsPerMeter = 2000;
-        bih.biClrUsed = 0;
-        bih.biClrImportant = 0;
-        break;
+    if (width <= 0 || height <= 0) {
+        file.close();
+        return !file.fail();
     }
-    default:
-        bih.biSize = info_version;
-        Read(file_dump, pos, bih.biWidth);
-        Read(file_dump, pos, bih.biHeight);
-        Read(file_dump, pos, bih.biPlanes);
-        Read(file_dump, pos, bih.biBitCount);
-        Read(file_dump, pos, bih.biCompression);
-        Read(file_dump, pos, bih.biSizeImage);
-        Read(file_dump, pos, bih.biXPelsPerMeter);
-        Read(file_dump, pos, bih.biYPelsPerMeter);
-        Read(file_dump, pos, bih.biClrUsed);
-        Read(file_dump, pos, bih.biClrImportant);
-        if (bih.biCompression == kBiBitFields) {
-            Read(file_dump, pos, red_mask);
-            Read(file_dump, pos, green_mask);
-            Read(file_dump, pos, blue_mask);
-        } else if (bih.biCompression == kBiAlphaBitFields) {
-            Read(file_dump, pos, red_mask);
-            Read(file_dump, pos, green_mask);
-            Read(file_dump, pos, blue_mask);
-            Read(file_dump, pos, alpha_mask);
+
+    // Indices are already BMP pixels, so rows are only reordered and
+    // padded in reusable block.
+    const size_t row_size = static_cast<size_t>(width) + padding;
+    const int block_rows = static_cast<int>(std::min<size_t>(
+            std::max<size_t>(kWriteBlockSize / row_size, 1), height));
+    vector<uint8_t> block(row_size * block_rows, 0);
+    for (int row = 0; row < height; row += block_rows) {
+        const int rows = std::min(block_rows, height - row);
+        for (int i = 0; i < rows; ++i) {
+            const int y = height - 1 - (row + i);
+            memcpy(block.data() + i * row_size,
+                   indices + static_cast<size_t>(y) * width, width);
         }
+        file.write(reinterpret_cast<const char*>(block.data()),
+                   rows * row_size);
     }
+    file.close();
+    return !file.fail();
+}
 
-    switch (bih.biBitCount) {
-    case 8:
-        data = ReadColors<8>(file_dump, bih.biWidth, bih.biHeight, bfh.bfOffBits, bih.biSize);
-        break;
-    case 24:
-        data = ReadColors<24>(file_dump, bih.biWidth, bih.biHeight, bfh.bfOffBits, bih.biSize);
-        break;
-    case 32:
-        data = ReadColors<32>(file_dump, bih.biWidth, bih.biHeight, bfh.bfOffBits, bih.biSize);
-        break;
-    default:
+bool Bmp::Decode(const string& filename, Image &data) {
+    MappedFile file;
+    if (!file.Open(filename)) {
+        return false;
+    }
+
+    PixelLayout layout;
+    if (!ReadLayout(file.Data(), file.Size(), layout)) {
         return false;
     }
 
+    vector<RgbaPixel> palette;
+    if (layout.bit_count == 8) {
+        palette = ReadPalette(file.Data(), file.Size(), layout);
+    }
+
+    // Pixel data is checked to fit in file, but decoded image is bigger, so
+    // allocation can still fail.
+    Image decoded;
+    try {
+        decoded.Resize(layout.width, layout.height);
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+
+    const uint8_t* pixels = file.Data() + layout.offset;
+    for (int row = 0; row < layout.height; ++row) {
+        const int y = layout.top_down ? row : layout.height - 1 - row;
+        const uint8_t* src = pixels +
+                             static_cast<size_t>(row) * layout.row_size;
+        RgbaPixel* dst = decoded.Data() +
+                         static_cast<size_t>(y) * layout.width;
+        switch (layout.bit_count) {
+        case 8:
+            ConvertRow8(src, palette.data(), layout.width, dst);
+            break;
+        case 24:
+            ConvertRow24(src, layout.width, dst);
+            break;
+        default:
+            ConvertRow32(src, layout.width, dst);
+            break;
+        }
+    }
+
+    data = std::move(decoded);
     return true;
 }
 
-template <int BIT_COUNT>
-Image Bmp::ReadColors(const FileDump& file_dump,
-                      const int width,
-                      const int height,
-                      int pixel_data_pos,
-                      const int info_header_size) {
-    const int padding = GetPadding(width, BIT_COUNT);
-    Image data(width, height);
-
-    const vector<RgbaPixel> palette = (BIT_COUNT == 8) ?
-                                      ReadPalette(file_dump, info_header_size) :
-                                      vector<RgbaPixel>();
-
-    for (int y = height - 1; y >= 0; --y) {
-        for (int x = 0; x < width; ++x) {
-            if (BIT_COUNT == 8) {
-                uint8_t index = 0;
-                Read(file_dump, pixel_data_pos, index);
-                data(x, y).red   = palette[index].red;
-                data(x, y).green = palette[index].green;
-                data(x, y).blue  = palette[index].blue;
-                data(x, y).alpha = palette[index].alpha;
-            } else {
-                Read(file_dump, pixel_data_pos, data(x, y).blue);
-                Read(file_dump, pixel_data_pos, data(x, y).green);
-                Read(file_dump, pixel_data_pos, data(x, y).red);
-                if (BIT_COUNT == 32) {
-                    Read(file_dump, pixel_data_pos, data(x, y).alpha);
-                }
-            }
+bool Bmp::ReadLayout(const uint8_t* file, size_t size, PixelLayout& layout) {
+    if (size < kBitmapFileHeaderSize + kBitmapCoreHeaderSize) {
+        return false;
+    }
+
+    BITMAPFILEHEADER bfh;
+    size_t pos = 0;
+    Read(file, pos, bfh.bfType);
+    Read(file, pos, bfh.bfSize);
+    Read(file, pos, bfh.bfReserved1);
+    Read(file, pos, bfh.bfReserved2);
+    Read(file, pos, bfh.bfOffBits);
+    if (bfh.bfType != kBitmapType) {
+        return false;
+    }
+
+    DWORD info_size = 0;
+    Read(file, pos, info_size);
+    if (info_size != kBitmapCoreHeaderSize &&
+            info_size < kBitmapInfoHeaderSize) {
+        return false;
+    }
+    if (size < kBitmapFileHeaderSize + static_cast<size_t>(info_size)) {
+        return false;
+    }
+
+    int64_t width = 0;
+    int64_t height = 0;
+    WORD bit_count = 0;
+    DWORD compression = kBiRGB;
+    DWORD colors_used = 0;
+    if (info_size == kBitmapCoreHeaderSize) {
+        BITMAPCOREHEADER bch;
+        Read(file, pos, bch.bcWidth);
+        Read(file, pos, bch.bcHeight);
+        Read(file, pos, bch.bcPlanes);
+        Read(file, pos, bch.bcBitCount);
+        width = bch.bcWidth;
+        height = bch.bcHeight;
+        bit_count = bch.bcBitCount;
+    } else {
+        BITMAPINFOHEADER bih;
+        Read(file, pos, bih.biWidth);
+        Read(file, pos, bih.biHeight);
+        Read(file, pos, bih.biPlanes);
+        Read(file, pos, bih.biBitCount);
+        Read(file, pos, bih.biCompression);
+        Read(file, pos, bih.biSizeImage);
+        Read(file, pos, bih.biXPelsPerMeter);
+        Read(file, pos, bih.biYPelsPerMeter);
+        Read(file, pos, bih.biClrUsed);
+        Read(file, pos, bih.biClrImportant);
+        width = bih.biWidth;
+        height = bih.biHeight;
+        bit_count = bih.biBitCount;
+        compression = bih.biCompression;
+        colors_used = bih.biClrUsed;
+    }
+
+    layout.top_down = height < 0;
+    height = std::abs(height);
+    if (width <= 0 || height <= 0 || width * height > INT_MAX) {
+        return false;
+    }
+    if (bit_count != 8 && bit_count != 24 && bit_count != 32) {
+        return false;
+    }
+
+    size_t masks_size = 0;
+    if (compression == kBiBitFields || compression == kBiAlphaBitFields) {
+        // Only default BGRA order is supported, it's used by Encode too.
+        masks_size = (compression == kBiBitFields) ? 12 : 16;
+        if (bit_count != 32 || size < pos + 12) {
+            return false;
         }
-        for (int i = 0; i < padding; ++i) {
-            uint8_t offset_bytes = 0;
-            Read(file_dump, pixel_data_pos, offset_bytes);
+        DWORD red_mask = 0;
+        DWORD green_mask = 0;
+        DWORD blue_mask = 0;
+        Read(file, pos, red_mask);
+        Read(file, pos, green_mask);
+        Read(file, pos, blue_mask);
+        if (red_mask != 0x00FF0000U ||
+                green_mask != 0x0000FF00U ||
+                blue_mask != 0x000000FFU) {
+            return false;
         }
+    } else if (compression != kBiRGB) {
+        return false;
     }
 
-    return data;
+    layout.width = static_cast<int>(width);
+    layout.height = static_cast<int>(height);
+    layout.bit_count = bit_count;
+    layout.row_size = (static_cast<size_t>(width) * bit_count + 31) / 32 * 4;
+    layout.offset = bfh.bfOffBits;
+    layout.palette_pos = kBitmapFileHeaderSize + info_size;
+    if (info_size == kBitmapInfoHeaderSize) {
+        layout.palette_pos += masks_size;
+    }
+    layout.palette_entry_size = (info_size == kBitmapCoreHeaderSize) ? 3 : 4;
+    layout.palette_count = (colors_used == 0 || colors_used > kPaletteSize) ?
+                           kPaletteSize : static_cast<int>(colors_used);
+
+    if (layout.offset < kBitmapFileHeaderSize + kBitmapCoreHeaderSize ||
+            layout.offset > size) {
+        return false;
+    }
+    return layout.row_size * layout.height <= size - layout.offset;
 }
 
-vector<RgbaPixel> Bmp::ReadPalette(const FileDump& file_dump,
-                                   const int info_header_size) {
-    int pos = kBitmapFileHeaderSize + info_header_size;
-    vector<RgbaPixel> palette;
-    static const int palette_size = 256;
-    palette.resize(palette_size);
-    for (size_t i = 0; i < palette_size; i++) {
-        Read(file_dump, pos, palette[i].blue);
-        Read(file_dump, pos, palette[i].green);
-        Read(file_dump, pos, palette[i].red);
-        if (info_header_size == kBitmapCoreHeaderSize) {
-            palette[i].alpha = 255;
-        } else {
-            Read(file_dump, pos, palette[i].alpha);
+vector<RgbaPixel> Bmp::ReadPalette(const uint8_t* file,
+                                   size_t size,
+                                   const PixelLayout& layout) {
+    vector<RgbaPixel> palette(kPaletteSize);
+    size_t pos = layout.palette_pos;
+    for (int i = 0; i < layout.palette_count; ++i) {
+        if (pos + layout.palette_entry_size > size) {
+            break;
+        }
+        Read(file, pos, palette[i].blue);
+        Read(file, pos, palette[i].green);
+        Read(file, pos, palette[i].red);
+        if (layout.palette_entry_size == 4) {
+            Read(file, pos, palette[i].alpha);
         }
     }
     return palette;
 }
 
 template <int BIT_COUNT>
-void Bmp::WriteBmp(const string& filename, const Image& data) {
+bool Bmp::WriteBmp(const string& filename, const Image& data) {
     ofstream file;
     file.open(filename, std::ios::binary);
     if (!file.is_open()) {
-        return;
+        return false;
     }
 
     static constexpr int info_header_size = (BIT_COUNT == 24) ? kBitmapInfoHeaderSize : kBitmapV5HeaderSize;
@@ -299,30 +476,36 @@ void Bmp::WriteBmp(const string& filename, const Image& data) {
         }
     }
 
-    vector<uint8_t> raw_image(image_size);
-    size_t index = 0;
-    for (int j = height - 1; j >= 0; --j) {
-        for (int i = 0; i < width; ++i) {
-            raw_image[index + 0] = data(i, j).blue;
-            raw_image[index + 1] = data(i, j).green;
-            raw_image[index + 2] = data(i, j).red;
+    if (width <= 0 || height <= 0) {
+        file.close();
+        return !file.fail();
+    }
+
+    // Rows are encoded to reusable block and written by several at once,
+    // padding bytes are zeroed once and never overwritten.
+    const size_t row_size = static_cast<size_t>(width) * (BIT_COUNT / 8) +
+                            padding;
+    const int block_rows = static_cast<int>(std::min<size_t>(
+            std::max<size_t>(kWriteBlockSize / row_size, 1), height));
+    vector<uint8_t> block(row_size * block_rows, 0);
+    for (int row = 0; row < height; row += block_rows) {
+        const int rows = std::min(block_rows, height - row);
+        for (int i = 0; i < rows; ++i) {
+            const int y = height - 1 - (row + i);
+            const RgbaPixel* src = data.Data() +
+                                   static_cast<size_t>(y) * width;
+            uint8_t* dst = block.data() + i * row_size;
             if (BIT_COUNT == 24) {
-                index += 3;
+                EncodeRow24(src, width, dst);
             } else {
-                raw_image[index + 3] = data(i, j).alpha;
-                index += 4;
-            }
-        }
-        if (BIT_COUNT == 24) {
-            for (int k = 0; k < padding; ++k) {
-                raw_image[index] = 0;
-                ++index;
+                EncodeRow32(src, width, dst);
             }
         }
+        file.write(reinterpret_cast<const char*>(block.data()),
+                   rows * row_size);
     }
-
-    file.write((char*)raw_image.data(), raw_image.size());
     file.close();
+    return !file.fail();
 }
 
 } // namespace utils
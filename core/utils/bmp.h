@@ -14,8 +14,6 @@ using WORD =  uint16_t;
 using DWORD = uint32_t;
 /** Signed 32bit integer. */
 using LONG =  int32_t;
-/** File dumped data. */
-using FileDump = std::vector<uint8_t>;
 
 
 /** @brief Information about the type, size, and layout of a DIB file. */
@@ -78,23 +76,68 @@ typedef struct tagBITMAPV5HEADER {
 
 /** @brief BMP files encoding and decoding support.
 
-Supports decoding of 8-, 24- and 32 bit BMP.
-Supports encoding of 24- and 32- bit BMP. */
+Supports decoding of 8-, 24- and 32 bit uncompressed bottom-up and top-down
+BMP. File is mapped to memory and rows are converted directly to output
+image. Supports encoding of 24- and 32- bit BMP and 8 bit BMP with palette. */
 class Bmp {
  public:
     /** Save image to BMP file.
     @param [in] file - Filename to save image.
     @param [in] data - Data for saving.
-    @param [in] bits - Bit depth of output image. */
-    static void Encode(const std::string& file, const Image &data, int bits);
-
-    /** Read image from BMP file.
+    @param [in] bits - Bit depth of output image.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Encode(const std::string& file, const Image &data, int bits);
+
+    /** Save indexed image to 8 bit BMP file with palette.
+    @param [in] file    - Filename to save image.
+    @param [in] indices - Palette indices of pixels row by row from top.
+    @param [in] width   - Image width in pixels.
+    @param [in] height  - Image height in pixels.
+    @param [in] palette - Colors of palette, up to kPaletteSize entries.
+                          Alpha is not saved.
+    @return @c true if file is written, @c false otherwise. */
+    static bool EncodeIndexed(const std::string& file,
+                              const uint8_t* indices,
+                              int width,
+                              int height,
+                              const std::vector<RgbaPixel>& palette);
+
+    /** Read image from BMP file. Output image isn't changed on failure.
     @param [in] file  - Filename for reading image.
     @param [out] data - Output image.
-    @return @c true if decoding is succeeded, @c false otherwise. */
+    @return @c true if decoding is succeeded, @c false otherwise (file
+    can't be read, headers are broken or format isn't supported). */
     static bool Decode(const std::string& file, Image& data);
 
  protected:
+    /** @brief Placement of pixel data in BMP file. */
+    struct PixelLayout {
+        /** Image width in pixels. */
+        int    width = 0;
+        /** Image height in pixels. */
+        int    height = 0;
+        /** Rows are stored from top to bottom. */
+        bool   top_down = false;
+        /** Bits per pixel (8, 24 or 32). */
+        int    bit_count = 0;
+        /** Position in file where pixel data starts. */
+        size_t offset = 0;
+        /** Size of row with padding in bytes. */
+        size_t row_size = 0;
+        /** Position in file where palette starts. */
+        size_t palette_pos = 0;
+        /** Size of palette entry in bytes. */
+        size_t palette_entry_size = 4;
+        /** Count of palette entries. */
+        int    palette_count = 0;
+    };
+
+    /** File type signature ("BM"). */
+    static const int kBitmapType = 0x4D42;
+    /** Maximal count of palette entries for 8 bit image. */
+    static const int kPaletteSize = 256;
+    /** Size of block of encoded rows written to file at once. */
+    static const int kWriteBlockSize = 1 << 20;
     /** Flag for usage RGB 8bit. */
     static const int kBiRGB = 0;
     /** Flag for custom RGB mask. */
@@ -110,35 +153,34 @@ class Bmp {
     static const int kBitmapInfoHeaderSize = 40;
     /** Size of serialized BITMAPV5HEADER. */
     static const int kBitmapV5HeaderSize =   124;
-    /** Size of rarely used BITMAPV5HEADER elements in the end of header. */
-    static const int kBitmapV5HeaderRareFeaturesSize = 20;
-
-    /** Read pixel palette for 8 bit image.
-    @param [in] file_dump        - Dumped to memory file.
-    @param [in] width            - Image width in pixels.
-    @param [in] height           - Image height in pixels.
-    @param [in] pixel_data_pos   - Position in file wherepixel data starts.
-    @param [in] info_header_size - Version of bitmap info header.
-    @return Image with filled data. */
-    template <int BIT_COUNT>
-    static Image ReadColors(const FileDump& file_dump,
-                            const int width,
-                            const int height,
-                            const int pixel_data_pos,
-                            const int info_header_size);
-
-    /** Read pixel palette for 8 bit image.
-    @param [in] file_dump - Dumped to memory file.
-    @param [in] bih       - Info header.
-    @return Pixel palette. */
-    static std::vector<RgbaPixel> ReadPalette(const FileDump& file_dump,
-                                              const int info_header_size);
+    /** Size of rarely used BITMAPV5HEADER elements in the end of header
+    (endpoints, gamma, intent, profile data, profile size and reserved). */
+    static const int kBitmapV5HeaderRareFeaturesSize = 64;
+
+    /** Read and validate file headers. Pixel data must fit in file.
+    @param [in] file    - File contents.
+    @param [in] size    - File size in bytes.
+    @param [out] layout - Placement of pixel data.
+    @return @c true if file is supported, @c false otherwise. */
+    static bool ReadLayout(const uint8_t* file,
+                           size_t size,
+                           PixelLayout& layout);
+
+    /** Read pixel palette for 8 bit image. Missing entries are black.
+    @param [in] file   - File contents.
+    @param [in] size   - File size in bytes.
+    @param [in] layout - Placement of pixel data.
+    @return Pixel palette with kPaletteSize entries. */
+    static std::vector<RgbaPixel> ReadPalette(const uint8_t* file,
+                                              size_t size,
+                                              const PixelLayout& layout);
 
     /** Save image to BIT_COUNT bit BMP file. Only 24 and 32 are allowed.
     @param [in] file - Filename to save image.
-    @param [in] data - Data for saving. */
+    @param [in] data - Data for saving.
+    @return @c true if file is written, @c false otherwise. */
     template <int BIT_COUNT>
-    static void WriteBmp(const std::string& filename, const Image& data);
+    static bool WriteBmp(const std::string& filename, const Image& data);
 };
 
 } // namespace utils
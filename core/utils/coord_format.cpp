@@ -0,0 +1,43 @@
+#include "coord_format.h"
+
+#include <algorithm>
+
+namespace prowogene {
+namespace utils {
+
+using std::string;
+
+CoordFormat::CoordFormat(const string& format) {
+    string lower = format;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    is_positive_[0] = lower.find("-x") == string::npos;
+    is_positive_[1] = lower.find("-y") == string::npos;
+    is_positive_[2] = lower.find("-z") == string::npos;
+
+    size_t x_index = lower.find("x");
+    size_t y_index = lower.find("y");
+    size_t z_index = lower.find("z");
+    if (x_index == string::npos ||
+            y_index == string::npos ||
+            z_index == string::npos) {
+        indexes_[0] = 0;
+        indexes_[1] = 1;
+        indexes_[2] = 2;
+        return;
+    }
+
+    indexes_[0] = static_cast<int>((x_index > y_index) + (x_index > z_index));
+    indexes_[1] = static_cast<int>((y_index > x_index) + (y_index > z_index));
+    indexes_[2] = static_cast<int>((z_index > x_index) + (z_index > y_index));
+}
+
+void CoordFormat::Apply(const float(&coords)[3],
+        float(&out_values)[3]) const {
+    for (int i = 0; i < 3; ++i) {
+        out_values[indexes_[i]] = coords[i] * (is_positive_[i] ? 1 : -1);
+    }
+}
+
+} // namespace utils
+} // namespace prowogene
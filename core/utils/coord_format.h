@@ -0,0 +1,33 @@
+#ifndef PROWOGENE_CORE_UTILS_COORD_FORMAT_H_
+#define PROWOGENE_CORE_UTILS_COORD_FORMAT_H_
+
+#include <string>
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Order and directions of axes in saved 3D models. */
+class CoordFormat {
+ public:
+    /** Constructor.
+    @param [in] format - String with coords order and their signs, for
+                         example @c "x -z y". Wrong format means
+                         @c "x y z". */
+    explicit CoordFormat(const std::string& format = "x y z");
+
+    /** Reorder point coords according format.
+    @param [in] coords      - input point coordinates.
+    @param [out] out_values - output point coordinates. */
+    void Apply(const float (&coords)[3], float (&out_values)[3]) const;
+
+ protected:
+    /** X, Y and Z axis signs. */
+    bool is_positive_[3];
+    /** X, Y and Z position indexes. */
+    int  indexes_[3];
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_COORD_FORMAT_H_
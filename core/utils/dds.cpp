@@ -0,0 +1,351 @@
+#include "dds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "utils/parallel_for.h"
+
+namespace prowogene {
+namespace utils {
+
+using std::string;
+using std::vector;
+
+static const uint32_t kMagic = 0x20534444;  // "DDS "
+static const uint32_t kFlagCaps = 0x1;
+static const uint32_t kFlagHeight = 0x2;
+static const uint32_t kFlagWidth = 0x4;
+static const uint32_t kFlagPixelFormat = 0x1000;
+static const uint32_t kFlagLinearSize = 0x80000;
+static const uint32_t kPixelFormatFourCC = 0x4;
+static const uint32_t kCapsTexture = 0x1000;
+static const int      kBlockSide = 4;
+static const int      kBlockPixels = 16;
+static const int      kPowerIterations = 4;
+
+template<typename Type>
+static void Write(std::ofstream& file, Type value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static inline uint32_t FourCC(const char (&code)[5]) {
+    return static_cast<uint32_t>(code[0]) |
+           (static_cast<uint32_t>(code[1]) << 8) |
+           (static_cast<uint32_t>(code[2]) << 16) |
+           (static_cast<uint32_t>(code[3]) << 24);
+}
+
+static inline uint16_t To565(const float (&color)[3]) {
+    const int r = static_cast<int>(std::lround(color[0] * 31.0f / 255.0f));
+    const int g = static_cast<int>(std::lround(color[1] * 63.0f / 255.0f));
+    const int b = static_cast<int>(std::lround(color[2] * 31.0f / 255.0f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static inline void From565(uint16_t packed, int (&color)[3]) {
+    const int r = packed >> 11;
+    const int g = (packed >> 5) & 0x3F;
+    const int b = packed & 0x1F;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+static inline void PutUInt16(uint16_t val, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(val & 0xFF);
+    out[1] = static_cast<uint8_t>(val >> 8);
+}
+
+// Palette indices of colors for endpoints, 0 - first, 1 - second,
+// 2 and 3 - interpolated at 1/3 and 2/3 from the first one.
+template<typename PaletteType>
+static uint32_t ChooseIndices(const float (&colors)[kBlockPixels][3],
+                              const PaletteType (&palette)[4][3]) {
+    uint32_t indices = 0;
+    for (int i = 0; i < kBlockPixels; ++i) {
+        int best = 0;
+        float best_dist = 0.0f;
+        for (int j = 0; j < 4; ++j) {
+            float dist = 0.0f;
+            for (int c = 0; c < 3; ++c) {
+                const float diff = colors[i][c] - palette[j][c];
+                dist += diff * diff;
+            }
+            if (j == 0 || dist < best_dist) {
+                best = j;
+                best_dist = dist;
+            }
+        }
+        indices |= static_cast<uint32_t>(best) << (i * 2);
+    }
+    return indices;
+}
+
+// Least squares endpoints for fixed indices.
+static void RefineEndpoints(const float (&colors)[kBlockPixels][3],
+                            uint32_t indices,
+                            float (&first)[3],
+                            float (&second)[3]) {
+    static const float kWeights[4] = {1.0f, 0.0f, 2.0f / 3, 1.0f / 3};
+    float aa = 0.0f;
+    float bb = 0.0f;
+    float ab = 0.0f;
+    float ax[3] = {0.0f, 0.0f, 0.0f};
+    float bx[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < kBlockPixels; ++i) {
+        const float a = kWeights[(indices >> (i * 2)) & 3];
+        const float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; ++c) {
+            ax[c] += a * colors[i][c];
+            bx[c] += b * colors[i][c];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) {
+        return;
+    }
+    for (int c = 0; c < 3; ++c) {
+        const float e0 = (ax[c] * bb - bx[c] * ab) / det;
+        const float e1 = (bx[c] * aa - ax[c] * ab) / det;
+        first[c] = std::min(std::max(e0, 0.0f), 255.0f);
+        second[c] = std::min(std::max(e1, 0.0f), 255.0f);
+    }
+}
+
+
+bool Dds::Encode(const string& filename, const Image& data,
+        BlockFormat format, int thread_count) {
+    const int width = data.Width();
+    const int height = data.Height();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const int blocks_x = (width + kBlockSide - 1) / kBlockSide;
+    const int blocks_y = (height + kBlockSide - 1) / kBlockSide;
+    const size_t block_size = (format == BlockFormat::BC1) ? 8 : 16;
+    vector<uint8_t> blocks(static_cast<size_t>(blocks_x) * blocks_y *
+                           block_size);
+    ParallelFor(blocks_y, thread_count, [&](int begin, int end) {
+        RgbaPixel block[kBlockPixels];
+        uint8_t first[kBlockPixels];
+        uint8_t second[kBlockPixels];
+        for (int by = begin; by < end; ++by) {
+            for (int bx = 0; bx < blocks_x; ++bx) {
+                for (int i = 0; i < kBlockPixels; ++i) {
+                    const int x = std::min(bx * kBlockSide + i % kBlockSide,
+                                           width - 1);
+                    const int y = std::min(by * kBlockSide + i / kBlockSide,
+                                           height - 1);
+                    block[i] = data.Data()[static_cast<size_t>(y) * width + x];
+                }
+                uint8_t* out = blocks.data() +
+                               (static_cast<size_t>(by) * blocks_x + bx) *
+                               block_size;
+                switch (format) {
+                case BlockFormat::BC1:
+                    EncodeBC1(block, out);
+                    break;
+                case BlockFormat::BC3:
+                    for (int i = 0; i < kBlockPixels; ++i) {
+                        first[i] = block[i].alpha;
+                    }
+                    EncodeBC4(first, out);
+                    EncodeBC1(block, out + 8);
+                    break;
+                case BlockFormat::BC5:
+                    for (int i = 0; i < kBlockPixels; ++i) {
+                        first[i] = block[i].red;
+                        second[i] = block[i].green;
+                    }
+                    EncodeBC4(first, out);
+                    EncodeBC4(second, out + 8);
+                    break;
+                }
+            }
+        }
+    });
+
+    WriteHeader(width, height, format, static_cast<uint32_t>(blocks.size()),
+                file);
+    file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+    file.close();
+    return !file.fail();
+}
+
+void Dds::EncodeBC1(const RgbaPixel (&block)[16], uint8_t* out) {
+    float colors[kBlockPixels][3];
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    float min_color[3] = {255.0f, 255.0f, 255.0f};
+    float max_color[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < kBlockPixels; ++i) {
+        colors[i][0] = block[i].red;
+        colors[i][1] = block[i].green;
+        colors[i][2] = block[i].blue;
+        for (int c = 0; c < 3; ++c) {
+            mean[c] += colors[i][c] / kBlockPixels;
+            min_color[c] = std::min(min_color[c], colors[i][c]);
+            max_color[c] = std::max(max_color[c], colors[i][c]);
+        }
+    }
+
+    // Principal axis of colors by power iteration over covariance matrix.
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < kBlockPixels; ++i) {
+        const float r = colors[i][0] - mean[0];
+        const float g = colors[i][1] - mean[1];
+        const float b = colors[i][2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+    float axis[3] = {max_color[0] - min_color[0],
+                     max_color[1] - min_color[1],
+                     max_color[2] - min_color[2]};
+    for (int i = 0; i < kPowerIterations; ++i) {
+        const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        const float norm = std::max(std::fabs(x),
+                                    std::max(std::fabs(y), std::fabs(z)));
+        if (norm <= 0.0f) {
+            break;
+        }
+        axis[0] = x / norm;
+        axis[1] = y / norm;
+        axis[2] = z / norm;
+    }
+
+    int min_index = 0;
+    int max_index = 0;
+    float min_proj = 0.0f;
+    float max_proj = 0.0f;
+    for (int i = 0; i < kBlockPixels; ++i) {
+        const float proj = colors[i][0] * axis[0] + colors[i][1] * axis[1] +
+                           colors[i][2] * axis[2];
+        if (i == 0 || proj < min_proj) {
+            min_proj = proj;
+            min_index = i;
+        }
+        if (i == 0 || proj > max_proj) {
+            max_proj = proj;
+            max_index = i;
+        }
+    }
+    float first[3];
+    float second[3];
+    float palette[4][3];
+    for (int c = 0; c < 3; ++c) {
+        first[c] = colors[max_index][c];
+        second[c] = colors[min_index][c];
+        palette[0][c] = first[c];
+        palette[1][c] = second[c];
+        palette[2][c] = (2.0f * first[c] + second[c]) / 3.0f;
+        palette[3][c] = (first[c] + 2.0f * second[c]) / 3.0f;
+    }
+    RefineEndpoints(colors, ChooseIndices(colors, palette), first, second);
+
+    // The first endpoint must be greater for 4 colors mode.
+    uint16_t packed_first = To565(first);
+    uint16_t packed_second = To565(second);
+    if (packed_first < packed_second) {
+        std::swap(packed_first, packed_second);
+    }
+    uint32_t indices = 0;
+    if (packed_first != packed_second) {
+        int quantized[4][3];
+        From565(packed_first, quantized[0]);
+        From565(packed_second, quantized[1]);
+        for (int c = 0; c < 3; ++c) {
+            quantized[2][c] = (2 * quantized[0][c] + quantized[1][c]) / 3;
+            quantized[3][c] = (quantized[0][c] + 2 * quantized[1][c]) / 3;
+        }
+        indices = ChooseIndices(colors, quantized);
+    }
+
+    PutUInt16(packed_first, out);
+    PutUInt16(packed_second, out + 2);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<uint8_t>((indices >> (i * 8)) & 0xFF);
+    }
+}
+
+void Dds::EncodeBC4(const uint8_t (&values)[16], uint8_t* out) {
+    const int max_val = *std::max_element(values, values + kBlockPixels);
+    const int min_val = *std::min_element(values, values + kBlockPixels);
+    out[0] = static_cast<uint8_t>(max_val);
+    out[1] = static_cast<uint8_t>(min_val);
+
+    // Maximum goes first, so 6 values are interpolated between endpoints.
+    uint64_t indices = 0;
+    if (max_val != min_val) {
+        int palette[8];
+        palette[0] = max_val;
+        palette[1] = min_val;
+        for (int i = 2; i < 8; ++i) {
+            palette[i] = ((8 - i) * max_val + (i - 1) * min_val + 3) / 7;
+        }
+        for (int i = 0; i < kBlockPixels; ++i) {
+            int best = 0;
+            for (int j = 1; j < 8; ++j) {
+                if (std::abs(palette[j] - values[i]) <
+                        std::abs(palette[best] - values[i])) {
+                    best = j;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (i * 3);
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<uint8_t>((indices >> (i * 8)) & 0xFF);
+    }
+}
+
+void Dds::WriteHeader(int width, int height, BlockFormat format,
+        uint32_t linear_size, std::ofstream& file) {
+    uint32_t four_cc = FourCC("DXT1");
+    if (format == BlockFormat::BC3) {
+        four_cc = FourCC("DXT5");
+    } else if (format == BlockFormat::BC5) {
+        four_cc = FourCC("ATI2");
+    }
+
+    Write(file, kMagic);
+    Write(file, static_cast<uint32_t>(kHeaderSize));
+    Write(file, kFlagCaps | kFlagHeight | kFlagWidth | kFlagPixelFormat |
+                kFlagLinearSize);
+    Write(file, static_cast<uint32_t>(height));
+    Write(file, static_cast<uint32_t>(width));
+    Write(file, linear_size);
+    Write(file, static_cast<uint32_t>(0));  // depth
+    Write(file, static_cast<uint32_t>(0));  // mipmaps count
+    for (int i = 0; i < 11; ++i) {
+        Write(file, static_cast<uint32_t>(0));
+    }
+
+    Write(file, static_cast<uint32_t>(kPixelFormatSize));
+    Write(file, kPixelFormatFourCC);
+    Write(file, four_cc);
+    for (int i = 0; i < 5; ++i) {
+        Write(file, static_cast<uint32_t>(0));  // bit count and masks
+    }
+
+    Write(file, kCapsTexture);
+    for (int i = 0; i < 4; ++i) {
+        Write(file, static_cast<uint32_t>(0));
+    }
+}
+
+} // namespace utils
+} // namespace prowogene
@@ -0,0 +1,79 @@
+#ifndef PROWOGENE_CORE_UTILS_DDS_H_
+#define PROWOGENE_CORE_UTILS_DDS_H_
+
+#include <stdint.h>
+
+#include <fstream>
+#include <string>
+
+#include "utils/image.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Block compression format of DDS texture. */
+typedef enum class _BlockFormat : unsigned char {
+    /** RGB, 4 bits per pixel. */
+    BC1,
+    /** RGB with smooth alpha, 8 bits per pixel. */
+    BC3,
+    /** Red and green channels, 8 bits per pixel. Used for normal maps. */
+    BC5
+} BlockFormat;
+
+
+/** @brief DDS files encoding support.
+
+Image is compressed by 4x4 pixel blocks. Color endpoints are chosen along
+principal axis of block colors and refined by least squares, channel
+endpoints (alpha, BC5) are minimal and maximal values. Edge blocks of
+images with sizes not multiple of 4 are padded by edge pixels. Single
+mip level is saved, formats are written as @c "DXT1" , @c "DXT5" and
+@c "ATI2" FourCC codes. */
+class Dds {
+ public:
+    /** Save image to DDS file.
+    @param [in] file         - Filename to save image.
+    @param [in] data         - Data for saving.
+    @param [in] format       - Block compression format.
+    @param [in] thread_count - Count of threads for compression.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Encode(const std::string& file,
+                       const Image& data,
+                       BlockFormat format,
+                       int thread_count);
+
+    /** Compress 4x4 block to BC1 format.
+    @param [in] block - Pixels of block row by row.
+    @param [out] out  - Compressed block, 8 bytes. */
+    static void EncodeBC1(const RgbaPixel (&block)[16], uint8_t* out);
+
+    /** Compress 4x4 block of single channel to BC4 format. BC3 alpha and
+    BC5 channels are BC4 blocks.
+    @param [in] values - Channel values of block row by row.
+    @param [out] out   - Compressed block, 8 bytes. */
+    static void EncodeBC4(const uint8_t (&values)[16], uint8_t* out);
+
+ protected:
+    /** Size of serialized DDS_HEADER. */
+    static const int kHeaderSize = 124;
+    /** Size of serialized DDS_PIXELFORMAT. */
+    static const int kPixelFormatSize = 32;
+
+    /** Write file signature and DDS_HEADER.
+    @param [in] width       - Image width in pixels.
+    @param [in] height      - Image height in pixels.
+    @param [in] format      - Block compression format.
+    @param [in] linear_size - Size of compressed data in bytes.
+    @param [in, out] file   - Output file. */
+    static void WriteHeader(int width,
+                            int height,
+                            BlockFormat format,
+                            uint32_t linear_size,
+                            std::ofstream& file);
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_DDS_H_
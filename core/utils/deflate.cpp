@@ -0,0 +1,552 @@
+#include "deflate.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace prowogene {
+namespace utils {
+
+using std::vector;
+
+static const int      kMinMatch = 3;
+static const int      kMaxMatch = 258;
+static const int      kHashBits = 15;
+static const int      kMaxChain = 64;
+static const int      kNiceMatch = 128;
+static const int      kLazyMatch = 32;
+static const size_t   kBlockSymbols = 32768;
+static const size_t   kMaxStoredSize = 65535;
+static const int      kLitLenCodes = 286;
+static const int      kDistCodes = 30;
+static const int      kCodeLenCodes = 19;
+static const int      kEndOfBlock = 256;
+static const int      kMaxCodeLength = 15;
+static const int      kMaxCodeLenCodeLength = 7;
+static const uint32_t kAdlerBase = 65521;
+static const size_t   kAdlerMaxRun = 5552;
+
+static const uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+    67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4,
+    5, 5, 5, 5, 0
+};
+static const uint16_t kDistBase[kDistCodes] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+    513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t kDistExtra[kDistCodes] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+    11, 11, 12, 12, 13, 13
+};
+static const uint8_t kCodeLenOrder[kCodeLenCodes] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+
+// Literal (length is 0) or back reference.
+struct Symbol {
+    uint16_t length;
+    uint16_t value;
+};
+
+// Code length symbol with value of its extra bits.
+struct CodeLenSymbol {
+    uint8_t code;
+    uint8_t extra;
+};
+
+// Writer of bits from the least significant one.
+class BitWriter {
+ public:
+    explicit BitWriter(vector<uint8_t>& out) : out_(out) {}
+
+    void Put(uint32_t bits, int count) {
+        buffer_ |= static_cast<uint64_t>(bits) << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    void Align() {
+        if (count_ > 0) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+        }
+        buffer_ = 0;
+        count_ = 0;
+    }
+
+    vector<uint8_t>& Out() {
+        return out_;
+    }
+
+ private:
+    vector<uint8_t>& out_;
+    uint64_t         buffer_ = 0;
+    int              count_ = 0;
+};
+
+
+static inline int LengthCode(int length) {
+    const uint16_t* end = kLengthBase + 29;
+    return static_cast<int>(std::upper_bound(kLengthBase, end, length) -
+                            kLengthBase) - 1;
+}
+
+static inline int DistCode(int dist) {
+    const uint16_t* end = kDistBase + kDistCodes;
+    return static_cast<int>(std::upper_bound(kDistBase, end, dist) -
+                            kDistBase) - 1;
+}
+
+static inline uint32_t Hash(const uint8_t* data) {
+    const uint32_t val = data[0] | (data[1] << 8) | (data[2] << 16);
+    return (val * 2654435761U) >> (32 - kHashBits);
+}
+
+// Huffman code lengths limited by max_length. When tree is too deep,
+// frequencies are halved until it fits.
+static void BuildLengths(const vector<uint32_t>& freqs, int max_length,
+                         vector<uint8_t>& lengths) {
+    using Node = std::pair<uint64_t, int>;
+    const int count = static_cast<int>(freqs.size());
+    lengths.assign(count, 0);
+    vector<uint32_t> scaled = freqs;
+    while (true) {
+        std::priority_queue<Node, vector<Node>, std::greater<Node>> heap;
+        for (int i = 0; i < count; ++i) {
+            if (scaled[i]) {
+                heap.push(Node(scaled[i], i));
+            }
+        }
+        if (heap.empty()) {
+            return;
+        }
+        if (heap.size() == 1) {
+            lengths[heap.top().second] = 1;
+            return;
+        }
+
+        vector<int> parent(count * 2, -1);
+        int next = count;
+        while (heap.size() > 1) {
+            const Node first = heap.top();
+            heap.pop();
+            const Node second = heap.top();
+            heap.pop();
+            parent[first.second] = next;
+            parent[second.second] = next;
+            heap.push(Node(first.first + second.first, next));
+            ++next;
+        }
+
+        // Parent of node is always created after the node.
+        vector<int> depth(next, 0);
+        int max_depth = 0;
+        for (int i = next - 2; i >= 0; --i) {
+            if (parent[i] >= 0) {
+                depth[i] = depth[parent[i]] + 1;
+                max_depth = std::max(max_depth, depth[i]);
+            }
+        }
+        if (max_depth <= max_length) {
+            for (int i = 0; i < count; ++i) {
+                lengths[i] = static_cast<uint8_t>(depth[i]);
+            }
+            return;
+        }
+        for (auto& freq : scaled) {
+            freq = (freq + 1) / 2;
+        }
+    }
+}
+
+// Canonical codes with reversed bits order, as they are written.
+static void BuildCodes(const vector<uint8_t>& lengths,
+                       vector<uint16_t>& codes) {
+    int length_count[kMaxCodeLength + 1] = {0};
+    for (const auto length : lengths) {
+        ++length_count[length];
+    }
+    length_count[0] = 0;
+    int next_code[kMaxCodeLength + 1] = {0};
+    int code = 0;
+    for (int bits = 1; bits <= kMaxCodeLength; ++bits) {
+        code = (code + length_count[bits - 1]) << 1;
+        next_code[bits] = code;
+    }
+
+    codes.assign(lengths.size(), 0);
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        const int length = lengths[i];
+        if (!length) {
+            continue;
+        }
+        int val = next_code[length]++;
+        int reversed = 0;
+        for (int bit = 0; bit < length; ++bit) {
+            reversed = (reversed << 1) | (val & 1);
+            val >>= 1;
+        }
+        codes[i] = static_cast<uint16_t>(reversed);
+    }
+}
+
+static void FixedLengths(vector<uint8_t>& lit_lengths,
+                         vector<uint8_t>& dist_lengths) {
+    lit_lengths.assign(288, 8);
+    std::fill(lit_lengths.begin() + 144, lit_lengths.begin() + 256, 9);
+    std::fill(lit_lengths.begin() + 256, lit_lengths.begin() + 280, 7);
+    dist_lengths.assign(kDistCodes, 5);
+}
+
+// Run-length encoding of code lengths of both alphabets.
+static void EncodeLengths(const vector<uint8_t>& lengths,
+                          vector<CodeLenSymbol>& symbols) {
+    const size_t count = lengths.size();
+    size_t i = 0;
+    while (i < count) {
+        const uint8_t length = lengths[i];
+        size_t run = 1;
+        while (i + run < count && lengths[i + run] == length) {
+            ++run;
+        }
+        i += run;
+        if (!length) {
+            while (run >= 11) {
+                const size_t part = std::min<size_t>(run, 138);
+                symbols.push_back({18, static_cast<uint8_t>(part - 11)});
+                run -= part;
+            }
+            if (run >= 3) {
+                symbols.push_back({17, static_cast<uint8_t>(run - 3)});
+                run = 0;
+            }
+        } else {
+            symbols.push_back({length, 0});
+            --run;
+            while (run >= 3) {
+                const size_t part = std::min<size_t>(run, 6);
+                symbols.push_back({16, static_cast<uint8_t>(part - 3)});
+                run -= part;
+            }
+        }
+        for (; run > 0; --run) {
+            symbols.push_back({length, 0});
+        }
+    }
+}
+
+static uint64_t DataBits(const vector<uint32_t>& lit_freqs,
+                         const vector<uint32_t>& dist_freqs,
+                         const vector<uint8_t>& lit_lengths,
+                         const vector<uint8_t>& dist_lengths) {
+    uint64_t bits = 0;
+    for (int i = 0; i < kLitLenCodes; ++i) {
+        bits += static_cast<uint64_t>(lit_freqs[i]) * lit_lengths[i];
+        if (i > kEndOfBlock) {
+            bits += static_cast<uint64_t>(lit_freqs[i]) *
+                    kLengthExtra[i - kEndOfBlock - 1];
+        }
+    }
+    for (int i = 0; i < kDistCodes; ++i) {
+        bits += static_cast<uint64_t>(dist_freqs[i]) *
+                (dist_lengths[i] + kDistExtra[i]);
+    }
+    return bits;
+}
+
+static void WriteSymbols(const vector<Symbol>& symbols,
+                         const vector<uint8_t>& lit_lengths,
+                         const vector<uint8_t>& dist_lengths,
+                         BitWriter& writer) {
+    vector<uint16_t> lit_codes;
+    vector<uint16_t> dist_codes;
+    BuildCodes(lit_lengths, lit_codes);
+    BuildCodes(dist_lengths, dist_codes);
+    for (const auto& symbol : symbols) {
+        if (!symbol.length) {
+            writer.Put(lit_codes[symbol.value], lit_lengths[symbol.value]);
+            continue;
+        }
+        const int length_code = LengthCode(symbol.length);
+        const int lit = kEndOfBlock + 1 + length_code;
+        writer.Put(lit_codes[lit], lit_lengths[lit]);
+        writer.Put(symbol.length - kLengthBase[length_code],
+                   kLengthExtra[length_code]);
+        const int dist_code = DistCode(symbol.value);
+        writer.Put(dist_codes[dist_code], dist_lengths[dist_code]);
+        writer.Put(symbol.value - kDistBase[dist_code],
+                   kDistExtra[dist_code]);
+    }
+    writer.Put(lit_codes[kEndOfBlock], lit_lengths[kEndOfBlock]);
+}
+
+static void WriteStored(const uint8_t* raw, size_t size, bool is_final,
+                        BitWriter& writer) {
+    size_t pos = 0;
+    do {
+        const size_t part = std::min(size - pos, kMaxStoredSize);
+        const bool is_final_part = is_final && pos + part == size;
+        writer.Put(is_final_part ? 1 : 0, 3);
+        writer.Align();
+        vector<uint8_t>& out = writer.Out();
+        out.push_back(static_cast<uint8_t>(part & 0xFF));
+        out.push_back(static_cast<uint8_t>(part >> 8));
+        out.push_back(static_cast<uint8_t>(~part & 0xFF));
+        out.push_back(static_cast<uint8_t>((~part >> 8) & 0xFF));
+        out.insert(out.end(), raw + pos, raw + pos + part);
+        pos += part;
+    } while (pos < size);
+}
+
+// Write block with the cheapest of dynamic, fixed and stored encodings.
+static void WriteBlock(const vector<Symbol>& symbols,
+                       const uint8_t* raw, size_t raw_size, bool is_final,
+                       BitWriter& writer) {
+    vector<uint32_t> lit_freqs(kLitLenCodes, 0);
+    vector<uint32_t> dist_freqs(kDistCodes, 0);
+    for (const auto& symbol : symbols) {
+        if (!symbol.length) {
+            ++lit_freqs[symbol.value];
+        } else {
+            ++lit_freqs[kEndOfBlock + 1 + LengthCode(symbol.length)];
+            ++dist_freqs[DistCode(symbol.value)];
+        }
+    }
+    lit_freqs[kEndOfBlock] = 1;
+
+    vector<uint8_t> lit_lengths;
+    vector<uint8_t> dist_lengths;
+    BuildLengths(lit_freqs, kMaxCodeLength, lit_lengths);
+    BuildLengths(dist_freqs, kMaxCodeLength, dist_lengths);
+    if (std::all_of(dist_lengths.begin(), dist_lengths.end(),
+                    [](uint8_t length) { return length == 0; })) {
+        dist_lengths[0] = 1;
+    }
+    int lit_count = kLitLenCodes;
+    while (lit_count > kEndOfBlock + 1 && !lit_lengths[lit_count - 1]) {
+        --lit_count;
+    }
+    int dist_count = kDistCodes;
+    while (dist_count > 1 && !dist_lengths[dist_count - 1]) {
+        --dist_count;
+    }
+
+    vector<uint8_t> all_lengths(lit_lengths.begin(),
+                                lit_lengths.begin() + lit_count);
+    all_lengths.insert(all_lengths.end(), dist_lengths.begin(),
+                       dist_lengths.begin() + dist_count);
+    vector<CodeLenSymbol> len_symbols;
+    EncodeLengths(all_lengths, len_symbols);
+    vector<uint32_t> len_freqs(kCodeLenCodes, 0);
+    for (const auto& symbol : len_symbols) {
+        ++len_freqs[symbol.code];
+    }
+    vector<uint8_t> len_lengths;
+    BuildLengths(len_freqs, kMaxCodeLenCodeLength, len_lengths);
+    int len_count = kCodeLenCodes;
+    while (len_count > 4 && !len_lengths[kCodeLenOrder[len_count - 1]]) {
+        --len_count;
+    }
+
+    uint64_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * len_count +
+                            DataBits(lit_freqs, dist_freqs,
+                                     lit_lengths, dist_lengths);
+    for (const auto& symbol : len_symbols) {
+        dynamic_bits += len_lengths[symbol.code];
+        dynamic_bits += (symbol.code == 16) ? 2 :
+                        (symbol.code == 17) ? 3 :
+                        (symbol.code == 18) ? 7 : 0;
+    }
+    vector<uint8_t> fixed_lit_lengths;
+    vector<uint8_t> fixed_dist_lengths;
+    FixedLengths(fixed_lit_lengths, fixed_dist_lengths);
+    const uint64_t fixed_bits = 3 + DataBits(lit_freqs, dist_freqs,
+                                             fixed_lit_lengths,
+                                             fixed_dist_lengths);
+    const uint64_t stored_parts = raw_size / kMaxStoredSize + 1;
+    const uint64_t stored_bits = stored_parts * (3 + 7 + 32) + raw_size * 8;
+
+    if (stored_bits < dynamic_bits && stored_bits < fixed_bits) {
+        WriteStored(raw, raw_size, is_final, writer);
+        return;
+    }
+    if (fixed_bits <= dynamic_bits) {
+        writer.Put(is_final ? 1 : 0, 1);
+        writer.Put(1, 2);
+        WriteSymbols(symbols, fixed_lit_lengths, fixed_dist_lengths, writer);
+        return;
+    }
+
+    writer.Put(is_final ? 1 : 0, 1);
+    writer.Put(2, 2);
+    writer.Put(lit_count - 257, 5);
+    writer.Put(dist_count - 1, 5);
+    writer.Put(len_count - 4, 4);
+    for (int i = 0; i < len_count; ++i) {
+        writer.Put(len_lengths[kCodeLenOrder[i]], 3);
+    }
+    vector<uint16_t> len_codes;
+    BuildCodes(len_lengths, len_codes);
+    for (const auto& symbol : len_symbols) {
+        writer.Put(len_codes[symbol.code], len_lengths[symbol.code]);
+        if (symbol.code == 16) {
+            writer.Put(symbol.extra, 2);
+        } else if (symbol.code == 17) {
+            writer.Put(symbol.extra, 3);
+        } else if (symbol.code == 18) {
+            writer.Put(symbol.extra, 7);
+        }
+    }
+    WriteSymbols(symbols, lit_lengths, dist_lengths, writer);
+}
+
+
+void Deflate::WriteHeader(vector<uint8_t>& out) {
+    // Deflate with 32KiB window, default compression level.
+    out.push_back(0x78);
+    out.push_back(0x9C);
+}
+
+void Deflate::WriteTrailer(uint32_t adler, vector<uint8_t>& out) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>((adler >> shift) & 0xFF));
+    }
+}
+
+void Deflate::Compress(const uint8_t* data, size_t history, size_t size,
+        bool is_last, vector<uint8_t>& out) {
+    // Positions are counted from the beginning of history.
+    const uint8_t* base = data - history;
+    const size_t total = history + size;
+    vector<int32_t> head(1 << kHashBits, -1);
+    vector<int32_t> prev(total, -1);
+    auto insert = [&](size_t pos) {
+        if (pos + kMinMatch <= total) {
+            const uint32_t hash = Hash(base + pos);
+            prev[pos] = head[hash];
+            head[hash] = static_cast<int32_t>(pos);
+        }
+    };
+    auto find_match = [&](size_t pos, int& best_length, int& best_dist) {
+        best_length = 0;
+        best_dist = 0;
+        if (pos + kMinMatch > total) {
+            return;
+        }
+        const int max_length = static_cast<int>(
+            std::min<size_t>(kMaxMatch, total - pos));
+        const uint8_t* cur = base + pos;
+        int length = kMinMatch - 1;
+        int candidate = head[Hash(cur)];
+        for (int chain = 0; candidate >= 0 && chain < kMaxChain; ++chain) {
+            const size_t dist = pos - candidate;
+            if (dist > kWindowSize) {
+                break;
+            }
+            const uint8_t* ref = base + candidate;
+            if (ref[length] == cur[length]) {
+                int match = 0;
+                while (match < max_length && ref[match] == cur[match]) {
+                    ++match;
+                }
+                if (match > length) {
+                    length = match;
+                    best_length = match;
+                    best_dist = static_cast<int>(dist);
+                    if (match >= kNiceMatch || match == max_length) {
+                        break;
+                    }
+                }
+            }
+            candidate = prev[candidate];
+        }
+        if (best_length < kMinMatch) {
+            best_length = 0;
+        }
+    };
+
+    for (size_t pos = 0; pos < history; ++pos) {
+        insert(pos);
+    }
+
+    BitWriter writer(out);
+    vector<Symbol> symbols;
+    symbols.reserve(kBlockSymbols);
+    size_t block_start = history;
+    size_t pos = history;
+    while (pos < total) {
+        int length = 0;
+        int dist = 0;
+        find_match(pos, length, dist);
+        insert(pos);
+
+        // Lazy matching: literal is emitted when the next position has
+        // longer match.
+        bool is_literal = !length;
+        if (length && length < kLazyMatch && pos + 1 < total) {
+            int next_length = 0;
+            int next_dist = 0;
+            find_match(pos + 1, next_length, next_dist);
+            is_literal = next_length > length;
+        }
+
+        if (is_literal) {
+            symbols.push_back({0, base[pos]});
+            ++pos;
+        } else {
+            symbols.push_back({static_cast<uint16_t>(length),
+                               static_cast<uint16_t>(dist)});
+            for (int i = 1; i < length; ++i) {
+                insert(pos + i);
+            }
+            pos += length;
+        }
+
+        if (symbols.size() >= kBlockSymbols) {
+            const bool is_final = is_last && pos == total;
+            WriteBlock(symbols, base + block_start, pos - block_start,
+                       is_final, writer);
+            symbols.clear();
+            block_start = pos;
+        }
+    }
+
+    if (!symbols.empty() || (is_last && block_start == history)) {
+        WriteBlock(symbols, base + block_start, total - block_start,
+                   is_last, writer);
+    }
+    if (is_last) {
+        writer.Align();
+    } else {
+        WriteStored(nullptr, 0, false, writer);
+    }
+}
+
+uint32_t Deflate::Adler32(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t low = adler & 0xFFFF;
+    uint32_t high = adler >> 16;
+    while (size > 0) {
+        const size_t run = std::min(size, kAdlerMaxRun);
+        for (size_t i = 0; i < run; ++i) {
+            low += data[i];
+            high += low;
+        }
+        low %= kAdlerBase;
+        high %= kAdlerBase;
+        data += run;
+        size -= run;
+    }
+    return (high << 16) | low;
+}
+
+} // namespace utils
+} // namespace prowogene
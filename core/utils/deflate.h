@@ -0,0 +1,58 @@
+#ifndef PROWOGENE_CORE_UTILS_DEFLATE_H_
+#define PROWOGENE_CORE_UTILS_DEFLATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Compressor to zlib stream format (RFC 1950, RFC 1951).
+
+Stream can be compressed by independent segments, for example in parallel
+threads. Every segment may refer to up to kWindowSize bytes of preceding
+data, so compression ratio is almost the same as for single segment.
+Segments except the last one end with empty stored block, so they are
+byte aligned and compressed stream is simple concatenation of header,
+segments and trailer. */
+class Deflate {
+ public:
+    /** Maximal distance of back references in bytes. */
+    static const size_t kWindowSize = 32768;
+
+    /** Append zlib stream header.
+    @param [in, out] out - Output buffer. */
+    static void WriteHeader(std::vector<uint8_t>& out);
+
+    /** Append zlib stream trailer.
+    @param [in] adler    - Adler-32 checksum of whole uncompressed data.
+    @param [in, out] out - Output buffer. */
+    static void WriteTrailer(uint32_t adler, std::vector<uint8_t>& out);
+
+    /** Compress segment of data.
+    @param [in] data     - Segment data.
+    @param [in] history  - Count of bytes before @p data that can be
+                           referred, [0, kWindowSize].
+    @param [in] size     - Segment size in bytes.
+    @param [in] is_last  - Segment is the last one in stream.
+    @param [in, out] out - Output buffer, compressed data is appended. */
+    static void Compress(const uint8_t* data,
+                         size_t history,
+                         size_t size,
+                         bool is_last,
+                         std::vector<uint8_t>& out);
+
+    /** Update Adler-32 checksum.
+    @param [in] adler - Checksum of previous data, 1 for empty data.
+    @param [in] data  - Next data.
+    @param [in] size  - Size of next data in bytes.
+    @return Checksum of previous and next data. */
+    static uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size);
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_DEFLATE_H_
@@ -0,0 +1,628 @@
+#include "gltf.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace prowogene {
+namespace utils {
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+static const uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+static const uint32_t kGlbVersion = 2;
+static const uint32_t kJsonChunkType = 0x4E4F534A;  // "JSON"
+static const uint32_t kBinChunkType = 0x004E4942;  // "BIN\0"
+static const size_t   kGlbHeaderSize = 12;
+static const size_t   kChunkHeaderSize = 8;
+static const size_t   kAlignment = 4;
+static const size_t   kCopyBlockSize = 1 << 20;
+
+static const int kArrayBuffer = 34962;
+static const int kElementArrayBuffer = 34963;
+
+static const int kByte = 5120;
+static const int kUnsignedShort = 5123;
+static const int kUnsignedInt = 5125;
+static const int kFloat = 5126;
+
+static const float kMaxUShort = 65535.0f;
+static const float kMaxByte = 127.0f;
+
+template<typename Type>
+static void Append(vector<uint8_t>& bin, Type value) {
+    const size_t size = bin.size();
+    bin.resize(size + sizeof(value));
+    memcpy(bin.data() + size, &value, sizeof(value));
+}
+
+template<typename Type>
+static void Write(ofstream& file, Type value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void Align(vector<uint8_t>& bin) {
+    bin.resize((bin.size() + kAlignment - 1) / kAlignment * kAlignment, 0);
+}
+
+static uint16_t QuantizeUnsigned(float val) {
+    const float clamped = std::min(std::max(val, 0.0f), 1.0f);
+    return static_cast<uint16_t>(std::lround(clamped * kMaxUShort));
+}
+
+static int8_t QuantizeSigned(float val) {
+    const float clamped = std::min(std::max(val, -1.0f), 1.0f);
+    return static_cast<int8_t>(std::lround(clamped * kMaxByte));
+}
+
+// Same scale is used for all axes, so normal vectors aren't distorted by
+// node transform.
+static float QuantizationStep(const vector<float>& min,
+                              const vector<float>& max) {
+    float range = 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        range = std::max(range, max[c] - min[c]);
+    }
+    return range > 0.0f ? range / kMaxUShort : 1.0f;
+}
+
+static uint16_t QuantizePosition(float coord, float offset, float step) {
+    return QuantizeUnsigned((coord - offset) / step / kMaxUShort);
+}
+
+static void AppendNormal(const Vector3D& normal,
+                         const CoordFormat& coord_format, bool quantize,
+                         vector<uint8_t>& bin) {
+    float res[3];
+    coord_format.Apply({ normal.x, normal.y, normal.z }, res);
+    const float length = std::sqrt(res[0] * res[0] + res[1] * res[1] +
+                                   res[2] * res[2]);
+    const float inv_length = length > 0.0f ? 1.0f / length : 0.0f;
+    for (int c = 0; c < 3; ++c) {
+        if (quantize) {
+            Append(bin, QuantizeSigned(res[c] * inv_length));
+        } else {
+            Append(bin, res[c] * inv_length);
+        }
+    }
+    if (quantize) {
+        Append(bin, static_cast<int8_t>(0));
+    }
+}
+
+// glTF texture origin is top left corner of image.
+static void AppendUV(const TextureCoord& uv, bool quantize,
+                     vector<uint8_t>& bin) {
+    if (quantize) {
+        Append(bin, QuantizeUnsigned(uv.u));
+        Append(bin, QuantizeUnsigned(1.0f - uv.v));
+    } else {
+        Append(bin, uv.u);
+        Append(bin, 1.0f - uv.v);
+    }
+}
+
+static void AddFloats(const vector<float>& values, TextBuffer& json) {
+    json.Add('[');
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i) {
+            json.Add(',');
+        }
+        json.AddFloat(values[i]);
+    }
+    json.Add(']');
+}
+
+
+bool Gltf::Save(const Model3d& model, const ModelIOParams& params) {
+    const CoordFormat coord_format(params.coord_format);
+    const size_t vertexes_count = model.vertexes.size();
+    const bool add_normals = params.add_normals &&
+                             model.normals.size() == vertexes_count;
+    const bool add_uv = params.add_uv && model.uv.size() == vertexes_count;
+
+    vector<uint8_t> bin;
+    vector<Accessor> accessors;
+    float scale[3] = { 1.0f, 1.0f, 1.0f };
+    float offset[3] = { 0.0f, 0.0f, 0.0f };
+    accessors.push_back(AddPositions(model, coord_format, params.quantize,
+                                     scale, offset, bin));
+    accessors.push_back(AddIndices(model, bin));
+    if (add_normals) {
+        accessors.push_back(AddNormals(model, coord_format, params.quantize,
+                                       bin));
+    }
+    if (add_uv) {
+        accessors.push_back(AddUV(model, params.quantize, bin));
+    }
+    Align(bin);
+
+    const TextBuffer json = CreateJson(params, accessors, add_normals, add_uv,
+                                       scale, offset, bin.size());
+    ofstream file(params.filename + ".glb", std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    WriteHead(json, bin.size(), file);
+    file.write(reinterpret_cast<const char*>(bin.data()), bin.size());
+    file.close();
+    return !file.fail();
+}
+
+TextBuffer Gltf::CreateJson(const ModelIOParams& params,
+        const vector<Accessor>& accessors, bool add_normals, bool add_uv,
+        const float (&scale)[3], const float (&offset)[3], size_t bin_size) {
+    const bool add_texture = add_uv && !params.texture.empty();
+    const bool add_normal_map = add_texture && add_normals &&
+                                !params.normal_map.empty();
+    const size_t indices_idx = 1;
+    const size_t normals_idx = indices_idx + 1;
+    const size_t uv_idx = normals_idx + (add_normals ? 1 : 0);
+
+    TextBuffer json;
+    json.Add("{\"asset\":{\"version\":\"2.0\",\"generator\":\"prowogene\"}");
+    if (params.quantize) {
+        json.Add(",\"extensionsUsed\":[\"KHR_mesh_quantization\"]");
+        json.Add(",\"extensionsRequired\":[\"KHR_mesh_quantization\"]");
+    }
+    json.Add(",\"scene\":0,\"scenes\":[{\"nodes\":[0]}]");
+    json.Add(",\"nodes\":[{\"mesh\":0,\"name\":");
+    AddString(params.filename, json);
+    if (params.quantize) {
+        json.Add(",\"translation\":");
+        AddFloats({ offset[0], offset[1], offset[2] }, json);
+        json.Add(",\"scale\":");
+        AddFloats({ scale[0], scale[1], scale[2] }, json);
+    }
+    json.Add("}]");
+
+    json.Add(",\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0");
+    if (add_normals) {
+        json.Add(",\"NORMAL\":").AddInt(normals_idx);
+    }
+    if (add_uv) {
+        json.Add(",\"TEXCOORD_0\":").AddInt(uv_idx);
+    }
+    json.Add("},\"indices\":").AddInt(indices_idx);
+    if (add_texture) {
+        json.Add(",\"material\":0");
+    }
+    json.Add("}]}]");
+
+    if (add_texture) {
+        json.Add(",\"materials\":[{\"pbrMetallicRoughness\":"
+                 "{\"baseColorTexture\":{\"index\":0},\"metallicFactor\":0}");
+        if (add_normal_map) {
+            json.Add(",\"normalTexture\":{\"index\":1}");
+        }
+        json.Add("}],\"textures\":[{\"source\":0}");
+        if (add_normal_map) {
+            json.Add(",{\"source\":1}");
+        }
+        json.Add("],\"images\":[{\"uri\":");
+        AddString(params.texture, json);
+        json.Add('}');
+        if (add_normal_map) {
+            json.Add(",{\"uri\":");
+            AddString(params.normal_map, json);
+            json.Add('}');
+        }
+        json.Add(']');
+    }
+
+    AddAccessors(accessors, bin_size, json);
+    json.Add('}');
+    while (json.Size() % kAlignment) {
+        json.Add(' ');
+    }
+    return json;
+}
+
+void Gltf::WriteHead(const TextBuffer& json, size_t bin_size,
+        ofstream& file) {
+    const size_t json_size = json.Size();
+    const size_t total_size = kGlbHeaderSize + kChunkHeaderSize + json_size +
+                              kChunkHeaderSize + bin_size;
+    Write(file, kGlbMagic);
+    Write(file, kGlbVersion);
+    Write(file, static_cast<uint32_t>(total_size));
+    Write(file, static_cast<uint32_t>(json_size));
+    Write(file, kJsonChunkType);
+    file.write(json.Data(), json_size);
+    Write(file, static_cast<uint32_t>(bin_size));
+    Write(file, kBinChunkType);
+}
+
+Gltf::Accessor Gltf::AddPositions(const Model3d& model,
+        const CoordFormat& coord_format, bool quantize, float (&scale)[3],
+        float (&offset)[3], vector<uint8_t>& bin) {
+    const size_t count = model.vertexes.size();
+    vector<float> coords(count * 3);
+    Accessor accessor = CreatePositions(count, quantize);
+    accessor.min.assign(3, 0.0f);
+    accessor.max.assign(3, 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& vertex = model.vertexes[i];
+        float res[3];
+        coord_format.Apply({ vertex.x, vertex.y, vertex.z }, res);
+        for (int c = 0; c < 3; ++c) {
+            coords[i * 3 + c] = res[c];
+            if (!i || res[c] < accessor.min[c]) {
+                accessor.min[c] = res[c];
+            }
+            if (!i || res[c] > accessor.max[c]) {
+                accessor.max[c] = res[c];
+            }
+        }
+    }
+
+    Align(bin);
+    accessor.offset = bin.size();
+    if (!quantize) {
+        for (float coord : coords) {
+            Append(bin, coord);
+        }
+        accessor.length = bin.size() - accessor.offset;
+        return accessor;
+    }
+
+    const float step = QuantizationStep(accessor.min, accessor.max);
+    for (int c = 0; c < 3; ++c) {
+        offset[c] = accessor.min[c];
+        scale[c] = step;
+    }
+
+    vector<float> q_min(3, kMaxUShort);
+    vector<float> q_max(3, 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const uint16_t q = QuantizePosition(coords[i * 3 + c],
+                                                offset[c], step);
+            q_min[c] = std::min(q_min[c], static_cast<float>(q));
+            q_max[c] = std::max(q_max[c], static_cast<float>(q));
+            Append(bin, q);
+        }
+        Append(bin, static_cast<uint16_t>(0));
+    }
+    accessor.min = q_min;
+    accessor.max = q_max;
+    accessor.length = bin.size() - accessor.offset;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::AddNormals(const Model3d& model,
+        const CoordFormat& coord_format, bool quantize,
+        vector<uint8_t>& bin) {
+    Align(bin);
+    Accessor accessor = CreateNormals(model.normals.size(), quantize);
+    accessor.offset = bin.size();
+    for (const auto& normal : model.normals) {
+        AppendNormal(normal, coord_format, quantize, bin);
+    }
+    accessor.length = bin.size() - accessor.offset;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::AddUV(const Model3d& model, bool quantize,
+        vector<uint8_t>& bin) {
+    Align(bin);
+    Accessor accessor = CreateUV(model.uv.size(), quantize);
+    accessor.offset = bin.size();
+    for (const auto& uv : model.uv) {
+        AppendUV(uv, quantize, bin);
+    }
+    accessor.length = bin.size() - accessor.offset;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::AddIndices(const Model3d& model,
+        vector<uint8_t>& bin) {
+    const bool is_short = model.vertexes.size() <= kMaxUShort;
+    Align(bin);
+    Accessor accessor = CreateIndices(model.TrianglesCount() * 3, is_short);
+    accessor.offset = bin.size();
+    model.ForEachTriangle([&](uint32_t a, uint32_t b, uint32_t c) {
+        if (is_short) {
+            Append(bin, static_cast<uint16_t>(a));
+            Append(bin, static_cast<uint16_t>(b));
+            Append(bin, static_cast<uint16_t>(c));
+        } else {
+            Append(bin, a);
+            Append(bin, b);
+            Append(bin, c);
+        }
+    });
+    accessor.length = bin.size() - accessor.offset;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::CreatePositions(size_t count, bool quantize) {
+    Accessor accessor;
+    accessor.target = kArrayBuffer;
+    accessor.count = count;
+    accessor.type = "VEC3";
+    accessor.component_type = quantize ? kUnsignedShort : kFloat;
+    accessor.stride = quantize ? 8 : 0;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::CreateNormals(size_t count, bool quantize) {
+    Accessor accessor;
+    accessor.target = kArrayBuffer;
+    accessor.count = count;
+    accessor.type = "VEC3";
+    accessor.component_type = quantize ? kByte : kFloat;
+    accessor.normalized = quantize;
+    accessor.stride = quantize ? 4 : 0;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::CreateUV(size_t count, bool quantize) {
+    Accessor accessor;
+    accessor.target = kArrayBuffer;
+    accessor.count = count;
+    accessor.type = "VEC2";
+    accessor.component_type = quantize ? kUnsignedShort : kFloat;
+    accessor.normalized = quantize;
+    return accessor;
+}
+
+Gltf::Accessor Gltf::CreateIndices(size_t count, bool is_short) {
+    Accessor accessor;
+    accessor.target = kElementArrayBuffer;
+    accessor.count = count;
+    accessor.type = "SCALAR";
+    accessor.component_type = is_short ? kUnsignedShort : kUnsignedInt;
+    return accessor;
+}
+
+void Gltf::AddAccessors(const vector<Accessor>& accessors, size_t bin_size,
+        TextBuffer& json) {
+    json.Add(",\"accessors\":[");
+    for (size_t i = 0; i < accessors.size(); ++i) {
+        const Accessor& accessor = accessors[i];
+        json.Add(i ? ",{" : "{").Add("\"bufferView\":").AddInt(i);
+        json.Add(",\"componentType\":").AddInt(accessor.component_type);
+        if (accessor.normalized) {
+            json.Add(",\"normalized\":true");
+        }
+        json.Add(",\"count\":").AddInt(accessor.count);
+        json.Add(",\"type\":\"").Add(accessor.type).Add('"');
+        if (!accessor.min.empty()) {
+            json.Add(",\"min\":");
+            AddFloats(accessor.min, json);
+            json.Add(",\"max\":");
+            AddFloats(accessor.max, json);
+        }
+        json.Add('}');
+    }
+    json.Add(']');
+
+    json.Add(",\"bufferViews\":[");
+    for (size_t i = 0; i < accessors.size(); ++i) {
+        const Accessor& accessor = accessors[i];
+        json.Add(i ? ",{" : "{").Add("\"buffer\":0");
+        json.Add(",\"byteOffset\":").AddInt(accessor.offset);
+        json.Add(",\"byteLength\":").AddInt(accessor.length);
+        if (accessor.stride) {
+            json.Add(",\"byteStride\":").AddInt(accessor.stride);
+        }
+        json.Add(",\"target\":").AddInt(accessor.target);
+        json.Add('}');
+    }
+    json.Add(']');
+
+    json.Add(",\"buffers\":[{\"byteLength\":").AddInt(bin_size).Add("}]");
+}
+
+void Gltf::AddString(const string& str, TextBuffer& json) {
+    json.Add('"');
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            json.Add('\\');
+        }
+        if (static_cast<unsigned char>(c) >= ' ') {
+            json.Add(c);
+        }
+    }
+    json.Add('"');
+}
+
+
+GltfWriter::GltfWriter(const ModelIOParams& params)
+        : params_(params), coord_format_(params.coord_format) {
+    for (TempStream* stream : { &positions_, &indices_, &normals_, &uv_ }) {
+        stream->file = tmpfile();
+        if (!stream->file) {
+            is_failed_ = true;
+        }
+    }
+}
+
+GltfWriter::~GltfWriter() {
+    Close();
+}
+
+void GltfWriter::Write(const Model3d& part) {
+    if (is_failed_ || is_closed_) {
+        return;
+    }
+
+    for (const auto& vertex : part.vertexes) {
+        float res[3];
+        coord_format_.Apply({ vertex.x, vertex.y, vertex.z }, res);
+        if (min_.empty()) {
+            min_.assign(res, res + 3);
+            max_.assign(res, res + 3);
+        }
+        for (int c = 0; c < 3; ++c) {
+            min_[c] = std::min(min_[c], res[c]);
+            max_[c] = std::max(max_[c], res[c]);
+            Append(bin_, res[c]);
+        }
+    }
+    Flush(part.vertexes.size(), positions_);
+
+    size_t indices_count = 0;
+    part.ForEachTriangle([&](uint32_t a, uint32_t b, uint32_t c) {
+        Append(bin_, a);
+        Append(bin_, b);
+        Append(bin_, c);
+        indices_count += 3;
+    });
+    Flush(indices_count, indices_);
+
+    if (params_.add_normals) {
+        for (const auto& normal : part.normals) {
+            AppendNormal(normal, coord_format_, params_.quantize, bin_);
+        }
+        Flush(part.normals.size(), normals_);
+    }
+    if (params_.add_uv) {
+        for (const auto& uv : part.uv) {
+            AppendUV(uv, params_.quantize, bin_);
+        }
+        Flush(part.uv.size(), uv_);
+    }
+}
+
+bool GltfWriter::Close() {
+    if (is_closed_) {
+        return !is_failed_;
+    }
+    is_closed_ = true;
+    is_failed_ = is_failed_ || !SaveFile();
+    for (TempStream* stream : { &positions_, &indices_, &normals_, &uv_ }) {
+        if (stream->file) {
+            fclose(stream->file);
+            stream->file = nullptr;
+        }
+    }
+    return !is_failed_;
+}
+
+void GltfWriter::Flush(size_t count, TempStream& stream) {
+    const size_t written = fwrite(bin_.data(), 1, bin_.size(), stream.file);
+    is_failed_ = is_failed_ || written != bin_.size();
+    stream.count += count;
+    stream.length += bin_.size();
+    bin_.clear();
+}
+
+bool GltfWriter::SaveFile() {
+    const size_t vertexes_count = positions_.count;
+    const bool add_normals = params_.add_normals &&
+                             normals_.count == vertexes_count;
+    const bool add_uv = params_.add_uv && uv_.count == vertexes_count;
+    const bool quantize = params_.quantize;
+    if (min_.empty()) {
+        min_.assign(3, 0.0f);
+        max_.assign(3, 0.0f);
+    }
+
+    float scale[3] = { 1.0f, 1.0f, 1.0f };
+    float offset[3] = { 0.0f, 0.0f, 0.0f };
+    Accessor positions = CreatePositions(vertexes_count, quantize);
+    positions.min = min_;
+    positions.max = max_;
+    positions.length = positions_.length;
+    const float step = QuantizationStep(min_, max_);
+    if (quantize) {
+        for (int c = 0; c < 3; ++c) {
+            offset[c] = min_[c];
+            scale[c] = step;
+            positions.min[c] = QuantizePosition(min_[c], offset[c], step);
+            positions.max[c] = QuantizePosition(max_[c], offset[c], step);
+        }
+        positions.length = vertexes_count * 4 * sizeof(uint16_t);
+    }
+
+    vector<Accessor> accessors;
+    accessors.push_back(positions);
+    accessors.push_back(CreateIndices(indices_.count, false));
+    accessors.back().length = indices_.length;
+    if (add_normals) {
+        accessors.push_back(CreateNormals(normals_.count, quantize));
+        accessors.back().length = normals_.length;
+    }
+    if (add_uv) {
+        accessors.push_back(CreateUV(uv_.count, quantize));
+        accessors.back().length = uv_.length;
+    }
+    // All elements sizes are multiple of 4, so buffer views are aligned.
+    size_t bin_size = 0;
+    for (auto& accessor : accessors) {
+        accessor.offset = bin_size;
+        bin_size += accessor.length;
+    }
+
+    const TextBuffer json = CreateJson(params_, accessors, add_normals,
+                                       add_uv, scale, offset, bin_size);
+    ofstream file(params_.filename + ".glb", std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    // Head already contains full buffer size, so short copy is an error.
+    WriteHead(json, bin_size, file);
+    bool is_copied = quantize ? CopyQuantizedPositions(offset, step, file) :
+                                CopyStream(positions_, file);
+    is_copied = is_copied && CopyStream(indices_, file);
+    if (add_normals) {
+        is_copied = is_copied && CopyStream(normals_, file);
+    }
+    if (add_uv) {
+        is_copied = is_copied && CopyStream(uv_, file);
+    }
+    file.close();
+    return is_copied && !file.fail();
+}
+
+bool GltfWriter::CopyStream(const TempStream& stream, ofstream& file) {
+    vector<char> block(kCopyBlockSize);
+    rewind(stream.file);
+    size_t left = stream.length;
+    while (left) {
+        const size_t size = std::min(left, block.size());
+        if (fread(block.data(), 1, size, stream.file) != size) {
+            return false;
+        }
+        file.write(block.data(), size);
+        left -= size;
+    }
+    return file.good();
+}
+
+bool GltfWriter::CopyQuantizedPositions(const float (&offset)[3], float step,
+        ofstream& file) const {
+    const size_t block_vertexes = kCopyBlockSize / sizeof(float) / 3;
+    vector<float> coords(block_vertexes * 3);
+    vector<uint8_t> bin;
+    rewind(positions_.file);
+    size_t left = positions_.count;
+    while (left) {
+        const size_t count = std::min(left, block_vertexes);
+        const size_t read = fread(coords.data(), sizeof(float), count * 3,
+                                  positions_.file);
+        if (read != count * 3) {
+            return false;
+        }
+        bin.clear();
+        for (size_t i = 0; i < count; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                Append(bin, QuantizePosition(coords[i * 3 + c], offset[c],
+                                             step));
+            }
+            Append(bin, static_cast<uint16_t>(0));
+        }
+        file.write(reinterpret_cast<const char*>(bin.data()), bin.size());
+        left -= count;
+    }
+    return file.good();
+}
+
+} // namespace utils
+} // namespace prowogene
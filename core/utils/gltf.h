@@ -0,0 +1,248 @@
+#ifndef PROWOGENE_CORE_UTILS_GLTF_H_
+#define PROWOGENE_CORE_UTILS_GLTF_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <fstream>
+#include <vector>
+
+#include "utils/coord_format.h"
+#include "utils/model_io.h"
+#include "utils/text_buffer.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Save class for binary glTF 2.0 (GLB) 3D model files.
+
+Model is saved as single mesh with single triangles primitive, triangle
+strips are unpacked because glTF doesn't allow restart index. Texture and
+normal map are referenced by their filenames. */
+class Gltf {
+ public:
+    /** Save 3D model to file.
+    @param [in] model  - 3D model to save.
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Save(const Model3d& model, const ModelIOParams& params);
+
+ protected:
+    /** @brief Part of binary buffer with data of single accessor. */
+    struct Accessor {
+        /** Offset in binary buffer. */
+        size_t      offset = 0;
+        /** Size in binary buffer. */
+        size_t      length = 0;
+        /** Distance between elements in bytes. 0 means tightly packed. */
+        int         stride = 0;
+        /** Buffer view target (vertex attributes or indices). */
+        int         target = 0;
+        /** glTF component type. */
+        int         component_type = 0;
+        /** Integer components are mapped to [0.0, 1.0] or [-1.0, 1.0]. */
+        bool        normalized = false;
+        /** Count of elements. */
+        size_t      count = 0;
+        /** glTF element type ("SCALAR", "VEC2", "VEC3"). */
+        const char* type = "";
+        /** Minimal values of element components. Empty when not needed. */
+        std::vector<float> min;
+        /** Maximal values of element components. Empty when not needed. */
+        std::vector<float> max;
+    };
+
+    /** Create glTF JSON description of model.
+    @param [in] params      - Saving params.
+    @param [in] accessors   - Accessors of positions, indices, normals and
+                              UV in this order.
+    @param [in] add_normals - Accessors have normals.
+    @param [in] add_uv      - Accessors have UV.
+    @param [in] scale       - Scale for dequantization.
+    @param [in] offset      - Offset for dequantization.
+    @param [in] bin_size    - Binary buffer size.
+    @return JSON text padded to chunk alignment. */
+    static TextBuffer CreateJson(const ModelIOParams& params,
+                                 const std::vector<Accessor>& accessors,
+                                 bool add_normals,
+                                 bool add_uv,
+                                 const float (&scale)[3],
+                                 const float (&offset)[3],
+                                 size_t bin_size);
+
+    /** Write GLB header, JSON chunk and header of binary chunk.
+    @param [in] json     - JSON text.
+    @param [in] bin_size - Binary buffer size.
+    @param [in, out] file - Output file. */
+    static void WriteHead(const TextBuffer& json,
+                          size_t bin_size,
+                          std::ofstream& file);
+
+    /** Add vertex positions to binary buffer.
+    @param [in] model        - 3D model.
+    @param [in] coord_format - Coord order and axis directions.
+    @param [in] quantize     - Save positions as 16bit integers.
+    @param [out] scale       - Scale for dequantization.
+    @param [out] offset      - Offset for dequantization.
+    @param [in, out] bin     - Binary buffer.
+    @return Positions accessor. */
+    static Accessor AddPositions(const Model3d& model,
+                                 const CoordFormat& coord_format,
+                                 bool quantize,
+                                 float (&scale)[3],
+                                 float (&offset)[3],
+                                 std::vector<uint8_t>& bin);
+
+    /** Add normalized normal vectors to binary buffer.
+    @param [in] model        - 3D model.
+    @param [in] coord_format - Coord order and axis directions.
+    @param [in] quantize     - Save vectors as 8bit integers.
+    @param [in, out] bin     - Binary buffer.
+    @return Normals accessor. */
+    static Accessor AddNormals(const Model3d& model,
+                               const CoordFormat& coord_format,
+                               bool quantize,
+                               std::vector<uint8_t>& bin);
+
+    /** Add UV coordinates to binary buffer.
+    @param [in] model    - 3D model.
+    @param [in] quantize - Save coordinates as 16bit integers.
+    @param [in, out] bin - Binary buffer.
+    @return UV accessor. */
+    static Accessor AddUV(const Model3d& model,
+                          bool quantize,
+                          std::vector<uint8_t>& bin);
+
+    /** Add triangle indices to binary buffer. 16bit indices are used when
+    it's enough for vertexes count.
+    @param [in] model    - 3D model.
+    @param [in, out] bin - Binary buffer.
+    @return Indices accessor. */
+    static Accessor AddIndices(const Model3d& model,
+                               std::vector<uint8_t>& bin);
+
+    /** Create accessor of vertex positions without place in buffer and
+    bounds.
+    @param [in] count    - Count of vertexes.
+    @param [in] quantize - Positions are 16bit integers.
+    @return Positions accessor. */
+    static Accessor CreatePositions(size_t count, bool quantize);
+
+    /** Create accessor of normal vectors without place in buffer.
+    @param [in] count    - Count of vectors.
+    @param [in] quantize - Vectors are 8bit integers.
+    @return Normals accessor. */
+    static Accessor CreateNormals(size_t count, bool quantize);
+
+    /** Create accessor of UV coordinates without place in buffer.
+    @param [in] count    - Count of coordinates.
+    @param [in] quantize - Coordinates are 16bit integers.
+    @return UV accessor. */
+    static Accessor CreateUV(size_t count, bool quantize);
+
+    /** Create accessor of triangle indices without place in buffer.
+    @param [in] count    - Count of indices.
+    @param [in] is_short - Indices are 16bit integers.
+    @return Indices accessor. */
+    static Accessor CreateIndices(size_t count, bool is_short);
+
+    /** Add glTF JSON description of accessors and their buffer views.
+    @param [in] accessors  - Accessors.
+    @param [in] bin_size   - Binary buffer size.
+    @param [in, out] json  - JSON text. */
+    static void AddAccessors(const std::vector<Accessor>& accessors,
+                             size_t bin_size,
+                             TextBuffer& json);
+
+    /** Add JSON string value.
+    @param [in] str       - String value.
+    @param [in, out] json - JSON text. */
+    static void AddString(const std::string& str, TextBuffer& json);
+};
+
+
+/** @brief Writer of binary glTF 2.0 (GLB) 3D model files by parts.
+
+JSON with sizes and bounds of attributes is placed before binary buffer,
+so attributes of parts are kept in temporary files until closing. Indices
+are always 32bit. */
+class GltfWriter : public ModelWriter, protected Gltf {
+ public:
+    /** Constructor.
+    @param [in] params - Saving params. */
+    explicit GltfWriter(const ModelIOParams& params);
+
+    /** Destructor. Finishes file if it isn't closed. */
+    ~GltfWriter() override;
+
+    /** @copydoc ModelWriter::Write */
+    void Write(const Model3d& part) override;
+
+    /** @copydoc ModelWriter::Close */
+    bool Close() override;
+
+ protected:
+    /** @brief Temporary file with data of single accessor. */
+    struct TempStream {
+        /** Temporary file. */
+        FILE*  file = nullptr;
+        /** Count of elements. */
+        size_t count = 0;
+        /** Size of data in bytes. */
+        size_t length = 0;
+    };
+
+    /** Move part buffer to the end of temporary file.
+    @param [in] count       - Count of elements in part buffer.
+    @param [in, out] stream - Temporary file. */
+    void Flush(size_t count, TempStream& stream);
+
+    /** Save GLB file from temporary files.
+    @return @c true if file is written, @c false otherwise. */
+    bool SaveFile();
+
+    /** Copy data of temporary file to the end of output file.
+    @param [in] stream    - Temporary file.
+    @param [in, out] file - Output file.
+    @return @c true if all data is copied, @c false otherwise. */
+    static bool CopyStream(const TempStream& stream, std::ofstream& file);
+
+    /** Quantize vertex positions from temporary file and write them to the
+    end of output file.
+    @param [in] offset    - Offset for dequantization.
+    @param [in] step      - Scale for dequantization.
+    @param [in, out] file - Output file.
+    @return @c true if all positions are written, @c false otherwise. */
+    bool CopyQuantizedPositions(const float (&offset)[3],
+                                float step,
+                                std::ofstream& file) const;
+
+    /** Saving params. */
+    ModelIOParams        params_;
+    /** Coord order and axis directions. */
+    CoordFormat          coord_format_;
+    /** Vertex positions as floats. */
+    TempStream           positions_;
+    /** Triangle indices. */
+    TempStream           indices_;
+    /** Normal vectors in output format. */
+    TempStream           normals_;
+    /** UV coordinates in output format. */
+    TempStream           uv_;
+    /** Minimal values of positions coords. */
+    std::vector<float>   min_;
+    /** Maximal values of positions coords. */
+    std::vector<float>   max_;
+    /** Binary data of current part. */
+    std::vector<uint8_t> bin_;
+    /** Writing is failed, all next parts are skipped and file isn't
+    finished. */
+    bool                 is_failed_ = false;
+    /** File is finished. */
+    bool                 is_closed_ = false;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_GLTF_H_
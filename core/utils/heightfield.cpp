@@ -0,0 +1,131 @@
+#include "heightfield.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+namespace prowogene {
+namespace utils {
+
+using std::string;
+using std::vector;
+
+static const uint32_t kMagic = 0x31464850;  // "PHF1"
+static const uint16_t kFormatUnorm = 0;
+static const uint16_t kFormatHalf = 1;
+static const float    kMaxUShort = 65535.0f;
+
+// Bits of float and half precision float.
+static const uint32_t kFloatAbsMask = 0x7FFFFFFF;
+static const uint32_t kFloatInf = 0x7F800000;
+static const uint32_t kFloatHalfOverflow = 0x477FF000;  // 65520.0
+static const uint32_t kFloatHalfMinNormal = 0x38800000;  // 2^-14
+static const uint16_t kHalfInf = 0x7C00;
+static const uint16_t kHalfNan = 0x7E00;
+static const float    kHalfSubnormalScale = 16777216.0f;  // 2^24
+
+const string Heightfield::kExtension = "hf";
+
+static const size_t   kHeaderSize = 32;
+
+static void PutU16(uint8_t* dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static void PutU32(uint8_t* dst, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+static void PutFloat(uint8_t* dst, float value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    PutU32(dst, bits);
+}
+
+bool Heightfield::Save(const Array2D<float>& map, const Range& range,
+        const HeightfieldParams& params) {
+    const int map_width = map.Width();
+    const int map_height = map.Height();
+    const int width = range.right - range.left + 1;
+    const int height = range.bottom - range.top + 1;
+    if (width <= 0 || height <= 0 || !map_width || !map_height) {
+        return false;
+    }
+
+    // Header and samples are serialized byte by byte, so file is
+    // little-endian on any platform.
+    vector<uint8_t> data(kHeaderSize +
+                         static_cast<size_t>(width) * height * 2);
+    PutU32(data.data(), kMagic);
+    PutU16(data.data() + 4, params.half_float ? kFormatHalf : kFormatUnorm);
+    PutU16(data.data() + 6, 0);
+    PutU32(data.data() + 8, static_cast<uint32_t>(width));
+    PutU32(data.data() + 12, static_cast<uint32_t>(height));
+    PutFloat(data.data() + 16, params.origin_x);
+    PutFloat(data.data() + 20, params.origin_y);
+    PutFloat(data.data() + 24, params.edge_size);
+    PutFloat(data.data() + 28, params.height_scale);
+    uint8_t* sample = data.data() + kHeaderSize;
+    for (int y = range.top; y <= range.bottom; ++y) {
+        const int map_y = (y % map_height + map_height) % map_height;
+        for (int x = range.left; x <= range.right; ++x) {
+            const int map_x = (x % map_width + map_width) % map_width;
+            const float val = map(map_x, map_y);
+            PutU16(sample, params.half_float ? ToHalf(val) : ToUnorm16(val));
+            sample += 2;
+        }
+    }
+
+    std::ofstream file(params.filename + "." + kExtension,
+                       std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.close();
+    return !file.fail();
+}
+
+uint16_t Heightfield::ToUnorm16(float val) {
+    const float clamped = std::min(std::max(val, 0.0f), 1.0f);
+    return static_cast<uint16_t>(std::lround(clamped * kMaxUShort));
+}
+
+uint16_t Heightfield::ToHalf(float val) {
+    uint32_t bits = 0;
+    memcpy(&bits, &val, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t abs_bits = bits & kFloatAbsMask;
+
+    if (abs_bits > kFloatInf) {
+        return sign | kHalfNan;
+    }
+    if (abs_bits >= kFloatHalfOverflow) {
+        return sign | kHalfInf;
+    }
+    if (abs_bits < kFloatHalfMinNormal) {
+        const float abs_val = std::fabs(val);
+        return sign | static_cast<uint16_t>(
+            std::lround(abs_val * kHalfSubnormalScale));
+    }
+
+    // Exponent bias is changed from 127 to 15, mantissa is cut from 23 to
+    // 10 bits. Carry of rounding goes to exponent correctly.
+    const uint32_t exponent = (abs_bits >> 23) - 127 + 15;
+    const uint32_t mantissa = abs_bits & 0x7FFFFF;
+    uint32_t half = (exponent << 10) | (mantissa >> 13);
+    const uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        ++half;
+    }
+    return sign | static_cast<uint16_t>(half);
+}
+
+} // namespace utils
+} // namespace prowogene
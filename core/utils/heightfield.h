@@ -0,0 +1,77 @@
+#ifndef PROWOGENE_CORE_UTILS_HEIGHTFIELD_H_
+#define PROWOGENE_CORE_UTILS_HEIGHTFIELD_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "utils/array2d.h"
+#include "utils/range.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Heightfield saving params. */
+struct HeightfieldParams {
+    /** Filename without extension. */
+    std::string filename     = "heightfield";
+    /** Store heights as half precision floats instead of 16bit unsigned
+    normalized integers. */
+    bool        half_float   = false;
+    /** X coordinate of the first sample in 3D units. */
+    float       origin_x     = 0.0f;
+    /** Y coordinate of the first sample in 3D units. */
+    float       origin_y     = 0.0f;
+    /** Distance between neighbour samples in 3D units. */
+    float       edge_size    = 1.0f;
+    /** Height of sample with value 1.0 in 3D units. */
+    float       height_scale = 1.0f;
+};
+
+
+/** @brief Save class for raw 16bit heightfield tiles.
+
+File is 32 bytes header followed by samples. All values are little-endian.
+Header:
+  - uint32 magic "PHF1";
+  - uint16 sample format: 0 - unsigned normalized, 1 - half float;
+  - uint16 reserved, 0;
+  - uint32 width and uint32 height in samples;
+  - float origin X and float origin Y in 3D units;
+  - float edge size in 3D units;
+  - float height scale in 3D units.
+
+Samples are 16bit numbers stored row by row, every row goes along X axis.
+Height in 3D units is sample value in [0.0, 1.0] multiplied by height
+scale, so whole tile is loaded by single read. */
+class Heightfield {
+ public:
+    /** Heightfield filename extension. */
+    static const std::string kExtension;
+
+    /** Save part of height map. Points out of map are wrapped around it.
+    @param [in] map    - Height map with values in [0.0, 1.0].
+    @param [in] r      - Saved area, right and bottom borders are
+                         included.
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Save(const Array2D<float>& map,
+                     const Range& r,
+                     const HeightfieldParams& params);
+
+    /** Convert number in [0.0, 1.0] to 16bit unsigned normalized integer.
+    Values out of range are clamped.
+    @param [in] val - Number to convert.
+    @return Normalized integer. */
+    static uint16_t ToUnorm16(float val);
+
+    /** Convert number to half precision float with rounding to nearest.
+    @param [in] val - Number to convert.
+    @return Bits of half precision float. */
+    static uint16_t ToHalf(float val);
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_HEIGHTFIELD_H_
@@ -28,7 +28,7 @@ struct RgbaPixel {
     RgbaPixel(std::string hex_color);
 
     /** Converts color to @c "#RRGGBBAA" format. */
-    virtual std::string ToString() const;
+    std::string ToString() const;
 
     /** Red component. */
     uint8_t red   = 0;
@@ -40,6 +40,8 @@ struct RgbaPixel {
     uint8_t alpha = 255;
 };
 
+static_assert(sizeof(RgbaPixel) == 4, "RgbaPixel must be packed RGBA8.");
+
 using Image = Array2D<RgbaPixel>;
 
 } // namespace utils
@@ -0,0 +1,208 @@
+#include "image_codecs.h"
+
+#include <string.h>
+
+#include <fstream>
+#include <vector>
+
+#include "utils/bmp.h"
+#include "utils/dds.h"
+#include "utils/heightfield.h"
+#include "utils/png.h"
+
+namespace prowogene {
+namespace utils {
+
+using std::string;
+using std::vector;
+
+// Grayscale row of height map, 16bit samples are big-endian.
+static void FillGrayRow(const float* src, int width, bool is_short,
+                        uint8_t* row) {
+    for (int x = 0; x < width; ++x) {
+        const uint16_t val = Heightfield::ToUnorm16(src[x]);
+        if (is_short) {
+            row[x * 2] = static_cast<uint8_t>(val >> 8);
+            row[x * 2 + 1] = static_cast<uint8_t>(val & 0xFF);
+        } else {
+            row[x] = static_cast<uint8_t>((val * 255 + 32767) / 65535);
+        }
+    }
+}
+
+
+string BmpCodec::Extension() const {
+    return "bmp";
+}
+
+ImageCodecCaps BmpCodec::Caps() const {
+    ImageCodecCaps caps;
+    caps.decode = true;
+    caps.encode = true;
+    caps.encode_height_map = true;
+    caps.bit_depths = {24, 32};
+    caps.streaming = true;
+    return caps;
+}
+
+bool BmpCodec::Decode(const string& filename, Image& image) const {
+    return Bmp::Decode(filename, image);
+}
+
+bool BmpCodec::Encode(const Image& image, const ImageIOParams& params) const {
+    return Bmp::Encode(params.filename + "." + Extension(), image,
+                       params.bit_depth);
+}
+
+
+string PngCodec::Extension() const {
+    return "png";
+}
+
+ImageCodecCaps PngCodec::Caps() const {
+    ImageCodecCaps caps;
+    caps.encode = true;
+    caps.encode_height_map = true;
+    caps.precise_height_map = true;
+    caps.bit_depths = {24, 32};
+    caps.streaming = true;
+    caps.threaded = true;
+    return caps;
+}
+
+bool PngCodec::Encode(const Image& image, const ImageIOParams& params) const {
+    return Png::Encode(params.filename + "." + Extension(), image,
+                       params.bit_depth, params.thread_count);
+}
+
+bool PngCodec::EncodeHeightMap(const Array2D<float>& hm,
+        const ImageIOParams& params) const {
+    const int width = hm.Width();
+    const bool is_short = params.bit_depth != 8;
+    const Png::RowSource source = [&hm, width, is_short](int y,
+                                                         uint8_t* row) {
+        FillGrayRow(hm.Data() + static_cast<size_t>(y) * width, width,
+                    is_short, row);
+    };
+    return Png::Encode(params.filename + "." + Extension(), width,
+                       hm.Height(), Png::kColorGray, is_short ? 16 : 8,
+                       source, params.thread_count);
+}
+
+
+string DdsCodec::Extension() const {
+    return "dds";
+}
+
+ImageCodecCaps DdsCodec::Caps() const {
+    ImageCodecCaps caps;
+    caps.encode = true;
+    caps.encode_height_map = true;
+    caps.bit_depths = {24, 32};
+    caps.threaded = true;
+    return caps;
+}
+
+bool DdsCodec::Encode(const Image& image, const ImageIOParams& params) const {
+    BlockFormat format = BlockFormat::BC1;
+    if (params.is_normal_map) {
+        format = BlockFormat::BC5;
+    } else if (params.bit_depth == 32) {
+        format = BlockFormat::BC3;
+    }
+    return Dds::Encode(params.filename + "." + Extension(), image, format,
+                       params.thread_count);
+}
+
+
+string PgmCodec::Extension() const {
+    return "pgm";
+}
+
+ImageCodecCaps PgmCodec::Caps() const {
+    ImageCodecCaps caps;
+    caps.encode_height_map = true;
+    caps.precise_height_map = true;
+    caps.streaming = true;
+    return caps;
+}
+
+bool PgmCodec::EncodeHeightMap(const Array2D<float>& hm,
+        const ImageIOParams& params) const {
+    std::ofstream file(params.filename + "." + Extension(),
+                       std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    const int width = hm.Width();
+    const int height = hm.Height();
+    const bool is_short = params.bit_depth != 8;
+    file << "P5\n" << width << " " << height << "\n"
+         << (is_short ? 65535 : 255) << "\n";
+
+    vector<uint8_t> row(static_cast<size_t>(width) * (is_short ? 2 : 1));
+    for (int y = 0; y < height; ++y) {
+        FillGrayRow(hm.Data() + static_cast<size_t>(y) * width, width,
+                    is_short, row.data());
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    file.close();
+    return !file.fail();
+}
+
+
+RawHeightCodec::RawHeightCodec(const string& extension, Sample sample)
+    : extension_(extension)
+    , sample_(sample) {
+}
+
+string RawHeightCodec::Extension() const {
+    return extension_;
+}
+
+ImageCodecCaps RawHeightCodec::Caps() const {
+    ImageCodecCaps caps;
+    caps.encode_height_map = true;
+    caps.precise_height_map = true;
+    caps.streaming = true;
+    return caps;
+}
+
+bool RawHeightCodec::EncodeHeightMap(const Array2D<float>& hm,
+        const ImageIOParams& params) const {
+    std::ofstream file(params.filename + "." + extension_, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    const int width = hm.Width();
+    const int height = hm.Height();
+    const size_t sample_size = (sample_ == Sample::Float) ?
+                               sizeof(float) : sizeof(uint16_t);
+
+    // Samples are serialized byte by byte, so file is little-endian on any
+    // platform.
+    vector<uint8_t> row(static_cast<size_t>(width) * sample_size);
+    for (int y = 0; y < height; ++y) {
+        const float* src = hm.Data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            uint32_t val = 0;
+            if (sample_ == Sample::Float) {
+                memcpy(&val, src + x, sizeof(val));
+            } else if (sample_ == Sample::Half) {
+                val = Heightfield::ToHalf(src[x]);
+            } else {
+                val = Heightfield::ToUnorm16(src[x]);
+            }
+            uint8_t* dst = row.data() + x * sample_size;
+            for (size_t i = 0; i < sample_size; ++i) {
+                dst[i] = static_cast<uint8_t>(val >> (i * 8));
+            }
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    file.close();
+    return !file.fail();
+}
+
+} // namespace utils
+} // namespace prowogene
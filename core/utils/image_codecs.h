@@ -0,0 +1,109 @@
+#ifndef PROWOGENE_CORE_UTILS_IMAGE_CODECS_H_
+#define PROWOGENE_CORE_UTILS_IMAGE_CODECS_H_
+
+#include <string>
+
+#include "utils/image_io.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief BMP codec. Supports decoding of 8-, 24- and 32 bit images and
+encoding of 24- and 32 bit ones. */
+class BmpCodec : public ImageCodec {
+ public:
+    /** @copydoc ImageCodec::Extension */
+    std::string Extension() const override;
+    /** @copydoc ImageCodec::Caps */
+    ImageCodecCaps Caps() const override;
+    /** @copydoc ImageCodec::Decode */
+    bool Decode(const std::string& filename, Image& image) const override;
+    /** @copydoc ImageCodec::Encode */
+    bool Encode(const Image& image,
+                const ImageIOParams& params) const override;
+};
+
+
+/** @brief PNG codec. Encodes 24- and 32 bit images, height maps are
+saved as 16bit grayscale unless bit depth is 8. */
+class PngCodec : public ImageCodec {
+ public:
+    /** @copydoc ImageCodec::Extension */
+    std::string Extension() const override;
+    /** @copydoc ImageCodec::Caps */
+    ImageCodecCaps Caps() const override;
+    /** @copydoc ImageCodec::Encode */
+    bool Encode(const Image& image,
+                const ImageIOParams& params) const override;
+    /** @copydoc ImageCodec::EncodeHeightMap */
+    bool EncodeHeightMap(const Array2D<float>& hm,
+                         const ImageIOParams& params) const override;
+};
+
+
+/** @brief DDS codec. Encodes images with BC1 (24bit), BC3 (32bit) or BC5
+(normal maps) block compression. */
+class DdsCodec : public ImageCodec {
+ public:
+    /** @copydoc ImageCodec::Extension */
+    std::string Extension() const override;
+    /** @copydoc ImageCodec::Caps */
+    ImageCodecCaps Caps() const override;
+    /** @copydoc ImageCodec::Encode */
+    bool Encode(const Image& image,
+                const ImageIOParams& params) const override;
+};
+
+
+/** @brief Binary PGM codec for height maps. Heights are 16bit big-endian
+unless bit depth is 8. */
+class PgmCodec : public ImageCodec {
+ public:
+    /** @copydoc ImageCodec::Extension */
+    std::string Extension() const override;
+    /** @copydoc ImageCodec::Caps */
+    ImageCodecCaps Caps() const override;
+    /** @copydoc ImageCodec::EncodeHeightMap */
+    bool EncodeHeightMap(const Array2D<float>& hm,
+                         const ImageIOParams& params) const override;
+};
+
+
+/** @brief Codec for height maps in headerless files with little-endian
+samples stored row by row from top. */
+class RawHeightCodec : public ImageCodec {
+ public:
+    /** @brief Type of height samples. */
+    enum class Sample {
+        /** 16bit unsigned normalized integer. */
+        Unorm16,
+        /** Half precision float. */
+        Half,
+        /** Single precision float. */
+        Float
+    };
+
+    /** Constructor.
+    @param [in] extension - Filename extension.
+    @param [in] sample    - Type of height samples. */
+    RawHeightCodec(const std::string& extension, Sample sample);
+
+    /** @copydoc ImageCodec::Extension */
+    std::string Extension() const override;
+    /** @copydoc ImageCodec::Caps */
+    ImageCodecCaps Caps() const override;
+    /** @copydoc ImageCodec::EncodeHeightMap */
+    bool EncodeHeightMap(const Array2D<float>& hm,
+                         const ImageIOParams& params) const override;
+
+ protected:
+    /** Filename extension. */
+    std::string extension_;
+    /** Type of height samples. */
+    Sample      sample_ = Sample::Unorm16;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_IMAGE_CODECS_H_
@@ -1,30 +1,35 @@
 #include "image_io.h"
 
-#include <string.h>
+#include <algorithm>
 
-#include "utils/bmp.h"
+#include "settings_interface.h"
+#include "utils/image_codecs.h"
 
 namespace prowogene {
 namespace utils {
 
+using std::future;
 using std::string;
+using std::make_shared;
+using std::shared_ptr;
 using prowogene::utils::RgbaPixel;
 
-Image ImageIO::Load(const std::string& filename) const {
-    const string ext = filename.substr(filename.find_last_of(".") + 1);
-    if (ext == "bmp") {
-        return LoadBMP(filename);
-    }
-    return Image();
+static string ToLower(string str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
 }
 
-void ImageIO::Save(const Image& image, const ImageIOParams& params) const {
-    if (params.format == "bmp") {
-        SaveBMP(image, params);
-    }
+bool ImageCodec::Decode(const string& /*filename*/,
+        Image& /*image*/) const {
+    return false;
 }
 
-void ImageIO::SaveHeightMap(const Array2D<float>& hm,
+bool ImageCodec::Encode(const Image& /*image*/,
+        const ImageIOParams& /*params*/) const {
+    return false;
+}
+
+bool ImageCodec::EncodeHeightMap(const Array2D<float>& hm,
         const ImageIOParams& params) const {
     const int width = hm.Width();
     const int height = hm.Height();
@@ -35,17 +40,98 @@ void ImageIO::SaveHeightMap(const Array2D<float>& hm,
             image(x, y) = RgbaPixel(color, color, color, 255);
         }
     }
-    Save(image, params);
+    return Encode(image, params);
+}
+
+ImageIO::ImageIO()
+    : executor_(&own_executor_) {
+    using Sample = RawHeightCodec::Sample;
+    Register(make_shared<BmpCodec>());
+    Register(make_shared<PngCodec>());
+    Register(make_shared<DdsCodec>());
+    Register(make_shared<PgmCodec>());
+    Register(make_shared<RawHeightCodec>("r16",  Sample::Unorm16));
+    Register(make_shared<RawHeightCodec>("r16f", Sample::Half));
+    Register(make_shared<RawHeightCodec>("r32",  Sample::Float));
+}
+
+void ImageIO::SetExecutor(IOExecutor* executor) {
+    executor_ = executor ? executor : &own_executor_;
+}
+
+IOExecutor* ImageIO::GetExecutor() const {
+    return executor_;
+}
+
+void ImageIO::Register(shared_ptr<ImageCodec> codec) {
+    if (codec) {
+        codecs_[ToLower(codec->Extension())] = codec;
+    }
+}
+
+const ImageCodec* ImageIO::GetCodec(const string& extension) const {
+    const auto it = codecs_.find(ToLower(extension));
+    if (it == codecs_.end()) {
+        return nullptr;
+    }
+    return it->second.get();
 }
 
-Image ImageIO::LoadBMP(const std::string& filename) const {
+Image ImageIO::Load(const std::string& filename) const {
+    const string ext = filename.substr(filename.find_last_of(".") + 1);
+    const ImageCodec* codec = GetCodec(ext);
     Image decoded;
-    Bmp::Decode(filename, decoded);
+    if (codec && codec->Caps().decode) {
+        codec->Decode(filename, decoded);
+    }
     return decoded;
 }
 
-void ImageIO::SaveBMP(const Image& image, const ImageIOParams& params) const {
-    Bmp::Encode(params.filename + ".bmp", image, params.bit_depth);
+bool ImageIO::Save(const Image& image, const ImageIOParams& params) const {
+    const ImageCodec* codec = GetCodec(params.format);
+    return codec && codec->Caps().encode && codec->Encode(image, params);
+}
+
+bool ImageIO::SaveHeightMap(const Array2D<float>& hm,
+        const ImageIOParams& params) const {
+    const ImageCodec* codec = GetCodec(params.format);
+    return codec && codec->Caps().encode_height_map &&
+           codec->EncodeHeightMap(hm, params);
+}
+
+future<Image> ImageIO::LoadAsync(const string& filename) const {
+    return executor_->Submit([this, filename]() {
+        return Load(filename);
+    });
+}
+
+future<void> ImageIO::SaveAsync(Image&& image,
+        const ImageIOParams& params) const {
+    const size_t bytes = static_cast<size_t>(image.Width()) *
+                         image.Height() * sizeof(RgbaPixel);
+    const shared_ptr<const Image> owned = make_shared<Image>(
+        std::move(image));
+    return executor_->Submit([this, owned, params]() {
+        if (!Save(*owned, params)) {
+            throw LogicException("Can't write image '" + params.filename +
+                                 "." + params.format + "'.");
+        }
+    }, bytes);
+}
+
+future<void> ImageIO::SaveHeightMapAsync(Array2D<float>&& hm,
+        const ImageIOParams& params) const {
+    const size_t bytes = static_cast<size_t>(hm.Width()) * hm.Height() *
+                         sizeof(float);
+    const shared_ptr<const Array2D<float>> owned =
+        make_shared<Array2D<float>>(std::move(hm));
+    return executor_->Submit([this, owned, params]() {
+        if (!SaveHeightMap(*owned, params)) {
+            throw LogicException("Can't write height map '" +
+                                 params.filename + "." + params.format +
+                                 "'.");
+        }
+    }, bytes);
 }
 
 } // namespace utils
@@ -1,14 +1,24 @@
 #ifndef PROWOGENE_CORE_UTILS_IMAGE_IO_H_
 #define PROWOGENE_CORE_UTILS_IMAGE_IO_H_
 
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
 #include "utils/image.h"
+#include "utils/io_executor.h"
 
 namespace prowogene {
 namespace utils {
 
 /** @brief Image saving params. */
 struct ImageIOParams {
-    /** Image file format. */
+    /** Image file format, extension of registered codec. Built-in are
+    @c "bmp" , @c "png" and @c "dds" (BC1 for 24bit, BC3 for 32bit, BC5
+    for normal maps). Height maps can also be saved as @c "pgm" (grayscale,
+    16bit unless bit_depth is 8), @c "r16" (raw 16bit unsigned normalized),
+    @c "r16f" (raw half float) or @c "r32" (raw float). */
     std::string format = "bmp";
     /** Image filename without extension. */
     std::string filename = "texture";
@@ -16,38 +26,156 @@ struct ImageIOParams {
     int bit_depth = 24;
     /** Quality of output image (reserved). */
     int quality = 0;
+    /** Count of threads for image compression. */
+    int thread_count = 1;
+    /** Image is normal map, only red and green channels are needed. */
+    bool is_normal_map = false;
+};
+
+
+/** @brief Capabilities of image file format codec. */
+struct ImageCodecCaps {
+    /** Images can be loaded. */
+    bool             decode = false;
+    /** Images can be saved. */
+    bool             encode = false;
+    /** Height maps can be saved. */
+    bool             encode_height_map = false;
+    /** Height maps are saved with more than 8 bits per height. */
+    bool             precise_height_map = false;
+    /** Supported bit depths of saved images. */
+    std::vector<int> bit_depths;
+    /** Rows are encoded and written without full copy of image. */
+    bool             streaming = false;
+    /** Encoding uses ImageIOParams::thread_count threads. */
+    bool             threaded = false;
+};
+
+
+/** @brief Encoder and decoder of single image file format.
+
+Methods can be called from several threads at the same time. */
+class ImageCodec {
+ public:
+    /** Destructor. */
+    virtual ~ImageCodec() = default;
+
+    /** Get filename extension without dot. It is key of format in
+    ImageIO and value of ImageIOParams::format.
+    @return Extension. */
+    virtual std::string Extension() const = 0;
+
+    /** Get format capabilities.
+    @return Capabilities. */
+    virtual ImageCodecCaps Caps() const = 0;
+
+    /** Load image from file. Does nothing by default.
+    @param [in] filename - Filename of image.
+    @param [out] image   - Decoded image.
+    @return @c true if decoding is succeeded, @c false otherwise. */
+    virtual bool Decode(const std::string& filename, Image& image) const;
+
+    /** Save image to file. Does nothing and fails by default.
+    @param [in] image  - Image to save.
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false otherwise. */
+    virtual bool Encode(const Image& image,
+                        const ImageIOParams& params) const;
+
+    /** Save height map to file. By default heights are converted to 8bit
+    gray image that is saved by Encode.
+    @param [in] hm     - Height map to save, values are in [0.0, 1.0].
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false otherwise. */
+    virtual bool EncodeHeightMap(const Array2D<float>& hm,
+                                 const ImageIOParams& params) const;
 };
 
 
-/** @brief Image input/output worker. */
+/** @brief Image input/output worker.
+
+Files are loaded and saved by codecs registered by their extensions. Async
+methods execute tasks by I/O executor, own not started executor is used by
+default, so they are synchronous until shared executor is set. */
 class ImageIO {
  public:
+    /** Constructor. Registers built-in codecs. */
+    ImageIO();
+
+    /** Destructor. */
+    virtual ~ImageIO() = default;
+
+    ImageIO(const ImageIO&) = delete;
+    ImageIO& operator=(const ImageIO&) = delete;
+
+    /** Set executor of async methods. It must outlive all submitted tasks.
+    @param [in] executor - Executor, @c nullptr to use own one. */
+    virtual void SetExecutor(IOExecutor* executor);
+
+    /** Get executor of async methods.
+    @return Executor. */
+    virtual IOExecutor* GetExecutor() const;
+
+    /** Add codec. Codec with the same extension is replaced. Codecs must
+    be registered before images loading or saving.
+    @param [in] codec - Codec to add. */
+    virtual void Register(std::shared_ptr<ImageCodec> codec);
+
+    /** Get codec by extension.
+    @param [in] extension - Extension without dot, case insensitive.
+    @return Codec, @c nullptr if there is no such codec. */
+    virtual const ImageCodec* GetCodec(const std::string& extension) const;
+
     /** Load image from file.
     @param [in] filename - Filename of image.
-    @return decoded image. */
+    @return decoded image. Empty when format isn't supported. */
     virtual Image Load(const std::string& filename) const;
 
     /** Save image to file.
     @param [in] image  - Image to save.
-    @param [in] params - Saving params. */
-    virtual void Save(const Image& image, const ImageIOParams& params) const;
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false if format isn't supported
+            or writing is failed. */
+    virtual bool Save(const Image& image, const ImageIOParams& params) const;
 
     /** Save height map to file.
-    @param [in] hm     - Height map to save.
-    @param [in] params - Saving params. */
-    virtual void SaveHeightMap(const Array2D<float>& hm,
+    @param [in] hm     - Height map to save, values are in [0.0, 1.0].
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false if format isn't supported
+            or writing is failed. */
+    virtual bool SaveHeightMap(const Array2D<float>& hm,
                                const ImageIOParams& params) const;
 
- protected:
-    /** Load BMP image from file.
+    /** Load image from file by I/O executor.
     @param [in] filename - Filename of image.
-    @return decoded image. */
-    virtual Image LoadBMP(const std::string& filename) const;
+    @return Future for decoded image. */
+    virtual std::future<Image> LoadAsync(const std::string& filename) const;
 
-    /** Save BMP image to file.
-    @param [in] image - Image to save.
-    @param [in] par   - Saving params. */
-    virtual void SaveBMP(const Image& image, const ImageIOParams& par) const;
+    /** Save image to file by I/O executor. Caller is blocked while byte
+    budget of executor is exceeded.
+    @param [in] image  - Image to save, it's moved to the task.
+    @param [in] params - Saving params.
+    @return Future that is ready when image is saved. Task throws
+            LogicException if image isn't saved. */
+    virtual std::future<void> SaveAsync(Image&& image,
+                                        const ImageIOParams& params) const;
+
+    /** Save height map to file by I/O executor. Caller is blocked while
+    byte budget of executor is exceeded.
+    @param [in] hm     - Height map to save, it's moved to the task.
+    @param [in] params - Saving params.
+    @return Future that is ready when height map is saved. Task throws
+            LogicException if height map isn't saved. */
+    virtual std::future<void> SaveHeightMapAsync(
+        Array2D<float>&& hm, const ImageIOParams& params) const;
+
+ protected:
+    /** Registered codecs by lowercase extensions. */
+    std::map<std::string, std::shared_ptr<ImageCodec>> codecs_;
+    /** Executor used when shared one isn't set. */
+    IOExecutor                                         own_executor_;
+    /** Executor of async methods. */
+    IOExecutor*                                        executor_;
 };
 
 } // namespace utils
@@ -0,0 +1,63 @@
+#include "io_executor.h"
+
+namespace prowogene {
+namespace utils {
+
+using std::exception_ptr;
+using std::lock_guard;
+using std::mutex;
+
+IOExecutor::~IOExecutor() {
+    queue_.reset();
+}
+
+void IOExecutor::Start(int thread_count, int capacity, size_t byte_budget) {
+    queue_.reset();
+    if (thread_count > 0) {
+        queue_.reset(new WriteQueue(thread_count, capacity, byte_budget));
+    }
+}
+
+void IOExecutor::SetOwner(const void* owner) {
+    owner_ = owner;
+}
+
+void IOExecutor::SetWaitDeferred(bool is_deferred) {
+    is_wait_deferred_ = is_deferred;
+}
+
+bool IOExecutor::IsWaitDeferred() const {
+    return is_wait_deferred_;
+}
+
+void IOExecutor::Wait(const void** error_owner) {
+    if (queue_) {
+        queue_->Flush();
+    }
+    exception_ptr error;
+    const void* owner = nullptr;
+    {
+        lock_guard<mutex> lock(error_mutex_);
+        error = error_;
+        owner = error_owner_;
+        error_ = nullptr;
+        error_owner_ = nullptr;
+    }
+    if (error_owner) {
+        *error_owner = owner;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void IOExecutor::SetError(exception_ptr error, const void* owner) {
+    lock_guard<mutex> lock(error_mutex_);
+    if (!error_) {
+        error_ = error;
+        error_owner_ = owner;
+    }
+}
+
+} // namespace utils
+} // namespace prowogene
@@ -0,0 +1,160 @@
+#ifndef PROWOGENE_CORE_UTILS_IO_EXECUTOR_H_
+#define PROWOGENE_CORE_UTILS_IO_EXECUTOR_H_
+
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include "utils/write_queue.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Executor of file loading and saving tasks shared by all I/O
+workers.
+
+Tasks are executed by dedicated I/O threads, so caller can go on while
+files are encoded and written. Size of data owned by tasks is limited by
+byte budget. Result of task is returned by future. Also first exception
+of all tasks is rethrown by Wait, so errors of tasks that nobody waits for
+aren't lost. Tasks can be marked by owner, so that exception is reported
+together with owner of failed task. */
+class IOExecutor {
+ public:
+    /** Constructor. Executor isn't started, tasks are executed inside Submit
+    call. */
+    IOExecutor() = default;
+
+    /** Destructor. Waits for all submitted tasks. */
+    ~IOExecutor();
+
+    IOExecutor(const IOExecutor&) = delete;
+    IOExecutor& operator=(const IOExecutor&) = delete;
+
+    /** Start I/O threads. Tasks of previous start are completed first. Must
+    not be called at the same time with Submit.
+    @param [in] thread_count - Count of I/O threads. When it is less than 1,
+                               tasks are executed inside Submit call.
+    @param [in] capacity     - Maximal count of tasks waiting for I/O
+                               threads. [1, ...).
+    @param [in] byte_budget  - Maximal size of data owned by submitted
+                               tasks in bytes. 0 means no limit. */
+    void Start(int thread_count, int capacity, size_t byte_budget);
+
+    /** Execute function by I/O thread. Blocks caller while queue is full or
+    byte budget is exceeded. Thread-safe.
+    @param [in] func  - Function without params, it must own all data it
+                        needs.
+    @param [in] bytes - Size of data owned by function.
+    @return Future for function result. When executor isn't started,
+            function is called right away and its exception is thrown from
+            Submit. */
+    template <typename Func>
+    auto Submit(Func func, size_t bytes = 0)
+        -> std::future<decltype(func())>;
+
+    /** Set owner of tasks submitted after that call, for example module
+    that saves files. Must not be called at the same time with Submit.
+    @param [in] owner - Owner of tasks, @c nullptr for none. */
+    void SetOwner(const void* owner);
+
+    /** Let owner of executor wait for all tasks once they are submitted, so
+    submitters don't need to wait for their own tasks.
+    @param [in] is_deferred - @c true if wait is deferred, @c false
+                              otherwise. */
+    void SetWaitDeferred(bool is_deferred);
+
+    /** Check that wait for tasks is deferred to owner of executor.
+    @return @c true if wait is deferred, @c false otherwise. */
+    bool IsWaitDeferred() const;
+
+    /** Wait until all submitted tasks are completed. First exception thrown
+    by task since previous Wait is rethrown here.
+    @param [out] error_owner - Owner of task which exception is rethrown,
+                               can be @c nullptr. */
+    void Wait(const void** error_owner = nullptr);
+
+ protected:
+    /** Remember exception of task if it's the first one.
+    @param [in] error - Exception of task.
+    @param [in] owner - Owner of task. */
+    void SetError(std::exception_ptr error, const void* owner);
+
+    /** Call function by caller thread.
+    @param [in] func - Function without params.
+    @return Ready future with function result. */
+    template <typename Result, typename Func>
+    static typename std::enable_if<!std::is_void<Result>::value,
+                                   std::future<Result> >::type
+    CallNow(Func& func);
+
+    /** @copydoc CallNow */
+    template <typename Result, typename Func>
+    static typename std::enable_if<std::is_void<Result>::value,
+                                   std::future<Result> >::type
+    CallNow(Func& func);
+
+
+    /** Queue of tasks, @c nullptr when executor isn't started. */
+    std::unique_ptr<WriteQueue> queue_;
+    /** Owner of submitted tasks. */
+    const void*                 owner_ = nullptr;
+    /** Wait for tasks is deferred to owner of executor. */
+    bool                        is_wait_deferred_ = false;
+    /** First exception thrown by task. */
+    std::exception_ptr          error_;
+    /** Owner of task that has thrown error_. */
+    const void*                 error_owner_ = nullptr;
+    /** Guard for error_. */
+    std::mutex                  error_mutex_;
+};
+
+
+template <typename Func>
+auto IOExecutor::Submit(Func func, size_t bytes)
+        -> std::future<decltype(func())> {
+    using Result = decltype(func());
+    if (!queue_) {
+        return CallNow<Result>(func);
+    }
+
+    const void* owner = owner_;
+    auto task = std::make_shared<std::packaged_task<Result()> >(
+        [this, func, owner]() {
+            try {
+                return func();
+            } catch (...) {
+                SetError(std::current_exception(), owner);
+                throw;
+            }
+        });
+    std::future<Result> result = task->get_future();
+    queue_->Push([task]() { (*task)(); }, bytes);
+    return result;
+}
+
+template <typename Result, typename Func>
+typename std::enable_if<!std::is_void<Result>::value,
+                        std::future<Result> >::type
+IOExecutor::CallNow(Func& func) {
+    std::promise<Result> promise;
+    promise.set_value(func());
+    return promise.get_future();
+}
+
+template <typename Result, typename Func>
+typename std::enable_if<std::is_void<Result>::value,
+                        std::future<Result> >::type
+IOExecutor::CallNow(Func& func) {
+    func();
+    std::promise<Result> promise;
+    promise.set_value();
+    return promise.get_future();
+}
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_IO_EXECUTOR_H_
@@ -1,6 +1,8 @@
 #ifndef PROWOGENE_CORE_UTILS_JSON_H_
 #define PROWOGENE_CORE_UTILS_JSON_H_
 
+#include <stddef.h>
+
 #include <map>
 #include <string>
 #include <vector>
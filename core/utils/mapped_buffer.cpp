@@ -0,0 +1,216 @@
+#include "mapped_buffer.h"
+
+#include <stdlib.h>
+
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace prowogene {
+namespace utils {
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+
+static const char kFilePrefix[] = "prowogene_";
+
+static MappedBufferParams g_params;
+static mutex              g_params_mutex;
+
+#ifdef _WIN32
+static uint8_t* MapTemporary(const MappedBufferParams& params,
+                             size_t bytes) {
+    char dir[MAX_PATH + 1] = {0};
+    if (!params.directory.empty()) {
+        params.directory.copy(dir, MAX_PATH);
+    } else if (!GetTempPathA(MAX_PATH, dir)) {
+        return nullptr;
+    }
+    char filename[MAX_PATH + 1] = {0};
+    if (!GetTempFileNameA(dir, kFilePrefix, 0, filename)) {
+        return nullptr;
+    }
+    HANDLE file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0,
+                              nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY |
+                              FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        DeleteFileA(filename);
+        return nullptr;
+    }
+    uint8_t* view = nullptr;
+    const uint64_t size = bytes;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(size >> 32),
+                                        static_cast<DWORD>(size), nullptr);
+    if (mapping) {
+        view = static_cast<uint8_t*>(
+                MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, bytes));
+        CloseHandle(mapping);
+    }
+    // File is removed when view is unmapped.
+    CloseHandle(file);
+    return view;
+}
+
+static void Unmap(uint8_t* view, size_t size) {
+    (void)size;
+    UnmapViewOfFile(view);
+}
+
+static void AdviseMemory(uint8_t* view, size_t size, MemoryAccess access) {
+    (void)view;
+    (void)size;
+    (void)access;
+}
+#else
+static uint8_t* MapTemporary(const MappedBufferParams& params,
+                             size_t bytes) {
+    string dir = params.directory;
+    if (dir.empty()) {
+        const char* tmp = getenv("TMPDIR");
+        dir = (tmp && *tmp) ? tmp : "/tmp";
+    }
+    string pattern = dir + "/" + kFilePrefix + "XXXXXX";
+    std::vector<char> filename(pattern.begin(), pattern.end());
+    filename.push_back('\0');
+    const int file = mkstemp(filename.data());
+    if (file < 0) {
+        return nullptr;
+    }
+    // Name is removed right away, so space is released when file is
+    // closed and unmapped, also after crash.
+    unlink(filename.data());
+    // Space is reserved instead of creating sparse file, otherwise full disk
+    // is detected only by SIGBUS on write to page.
+    void* addr = MAP_FAILED;
+    if (!posix_fallocate(file, 0, static_cast<off_t>(bytes))) {
+        addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    file, 0);
+    }
+    close(file);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (params.huge_pages) {
+        madvise(addr, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return static_cast<uint8_t*>(addr);
+}
+
+static void Unmap(uint8_t* view, size_t size) {
+    munmap(view, size);
+}
+
+static void AdviseMemory(uint8_t* view, size_t size, MemoryAccess access) {
+    int advice = MADV_NORMAL;
+    switch (access) {
+    case MemoryAccess::Sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case MemoryAccess::Random:
+        advice = MADV_RANDOM;
+        break;
+    case MemoryAccess::WillNeed:
+        advice = MADV_WILLNEED;
+        break;
+    case MemoryAccess::DontNeed:
+        // Pages of shared file mapping are written to file, not dropped.
+        advice = MADV_DONTNEED;
+        break;
+    case MemoryAccess::Normal:
+    default:
+        break;
+    }
+    madvise(view, size, advice);
+}
+#endif
+
+
+MappedBuffer::~MappedBuffer() {
+    Release();
+}
+
+MappedBuffer::MappedBuffer(MappedBuffer&& src) {
+    view_ = src.view_;
+    size_ = src.size_;
+    src.view_ = nullptr;
+    src.size_ = 0;
+}
+
+MappedBuffer& MappedBuffer::operator=(MappedBuffer&& src) {
+    if (this != &src) {
+        Release();
+        view_ = src.view_;
+        size_ = src.size_;
+        src.view_ = nullptr;
+        src.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedBuffer::SetParams(const MappedBufferParams& params) {
+    lock_guard<mutex> lock(g_params_mutex);
+    g_params = params;
+}
+
+MappedBufferParams MappedBuffer::GetParams() {
+    lock_guard<mutex> lock(g_params_mutex);
+    return g_params;
+}
+
+bool MappedBuffer::IsWanted(size_t bytes) {
+    lock_guard<mutex> lock(g_params_mutex);
+    return g_params.threshold && bytes >= g_params.threshold;
+}
+
+bool MappedBuffer::Allocate(size_t bytes) {
+    Release();
+    if (!bytes) {
+        return false;
+    }
+    view_ = MapTemporary(GetParams(), bytes);
+    if (!view_) {
+        return false;
+    }
+    size_ = bytes;
+    return true;
+}
+
+void MappedBuffer::Release() {
+    if (view_) {
+        Unmap(view_, size_);
+        view_ = nullptr;
+    }
+    size_ = 0;
+}
+
+uint8_t* MappedBuffer::Data() const {
+    return view_;
+}
+
+size_t MappedBuffer::Size() const {
+    return size_;
+}
+
+void MappedBuffer::Advise(MemoryAccess access) const {
+    if (view_) {
+        AdviseMemory(view_, size_, access);
+    }
+}
+
+} // namespace utils
+} // namespace prowogene
@@ -0,0 +1,112 @@
+#ifndef PROWOGENE_CORE_UTILS_MAPPED_BUFFER_H_
+#define PROWOGENE_CORE_UTILS_MAPPED_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Expected access pattern of memory. */
+typedef enum class _MemoryAccess : unsigned char {
+    /** No special treatment. */
+    Normal,
+    /** Read ahead aggressively, pages can be freed soon after access. */
+    Sequential,
+    /** Don't read ahead. */
+    Random,
+    /** Load all pages in background. */
+    WillNeed,
+    /** Pages aren't needed soon, data is kept. */
+    DontNeed
+} MemoryAccess;
+
+
+/** @brief Params of file-backed storage for big arrays. */
+struct MappedBufferParams {
+    /** Arrays of that size in bytes or bigger are stored in temporary
+    files. 0 means all arrays are stored in heap memory. */
+    size_t      threshold = 0;
+    /** Directory for temporary files, empty for system temporary
+    directory. */
+    std::string directory;
+    /** Ask the OS to use huge pages for mapped memory. Has effect only on
+    Linux when directory is on tmpfs and transparent huge pages are enabled
+    for shared memory, other file systems ignore it. */
+    bool        huge_pages = false;
+};
+
+
+/** @brief Writable memory backed by temporary file instead of swap.
+
+Memory is mapped view of file that is removed right after creation, so the
+OS writes pages to that file when physical memory is low, and file space is
+released together with buffer even if process is killed. New buffer is
+filled by zeros. */
+class MappedBuffer {
+ public:
+    /** Constructor. */
+    MappedBuffer() = default;
+
+    /** Destructor. Releases buffer. */
+    ~MappedBuffer();
+
+    MappedBuffer(const MappedBuffer&) = delete;
+    MappedBuffer& operator=(const MappedBuffer&) = delete;
+
+    /** Move constructor. Source buffer becomes empty. */
+    MappedBuffer(MappedBuffer&& src);
+
+    /** Move assignment operator. Source buffer becomes empty. */
+    MappedBuffer& operator=(MappedBuffer&& src);
+
+    /** Set params of all buffers that are allocated after that call.
+    Thread-safe.
+    @param [in] params - Storage params. */
+    static void SetParams(const MappedBufferParams& params);
+
+    /** Get current storage params. Thread-safe.
+    @return Storage params. */
+    static MappedBufferParams GetParams();
+
+    /** Check that data of that size must be stored in file by current
+    params. Thread-safe.
+    @param [in] bytes - Size of data in bytes.
+    @return @c true if mapped buffer must be used, @c false otherwise. */
+    static bool IsWanted(size_t bytes);
+
+    /** Create temporary file and map it. Previous buffer is released.
+    @param [in] bytes - Size of buffer in bytes.
+    @return @c true if buffer is allocated, @c false otherwise. */
+    bool Allocate(size_t bytes);
+
+    /** Unmap buffer and release file space. */
+    void Release();
+
+    /** Get buffer memory.
+    @return Pointer to the first byte, @c nullptr if buffer isn't
+    allocated. */
+    uint8_t* Data() const;
+
+    /** Get buffer size.
+    @return Size of buffer in bytes. */
+    size_t Size() const;
+
+    /** Tell the OS how buffer will be accessed. Does nothing when hints are
+    not supported by platform.
+    @param [in] access - Expected access pattern. */
+    void Advise(MemoryAccess access) const;
+
+ protected:
+    /** Mapped view of file. */
+    uint8_t* view_ = nullptr;
+    /** Size of view in bytes. */
+    size_t   size_ = 0;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_MAPPED_BUFFER_H_
@@ -0,0 +1,139 @@
+#include "mapped_file.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace prowogene {
+namespace utils {
+
+using std::ifstream;
+using std::string;
+
+#ifdef _WIN32
+static const uint8_t* MapFile(const string& filename, size_t& size) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    const uint8_t* view = nullptr;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                            0, 0, nullptr);
+        if (mapping) {
+            view = static_cast<const uint8_t*>(
+                    MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        size = static_cast<size_t>(file_size.QuadPart);
+    }
+    CloseHandle(file);
+    return view;
+}
+
+static void UnmapFile(const uint8_t* view, size_t size) {
+    (void)size;
+    UnmapViewOfFile(view);
+}
+#else
+static const uint8_t* MapFile(const string& filename, size_t& size) {
+    const int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+    struct stat file_stat;
+    const uint8_t* view = nullptr;
+    if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0) {
+        size = static_cast<size_t>(file_stat.st_size);
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, size, MADV_SEQUENTIAL);
+            view = static_cast<const uint8_t*>(addr);
+        }
+    }
+    close(file);
+    return view;
+}
+
+static void UnmapFile(const uint8_t* view, size_t size) {
+    munmap(const_cast<uint8_t*>(view), size);
+}
+#endif
+
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const string& filename) {
+    Close();
+    size_t size = 0;
+    view_ = MapFile(filename, size);
+    if (view_) {
+        size_ = size;
+        return true;
+    }
+    return ReadToBuffer(filename);
+}
+
+void MappedFile::Close() {
+    if (view_) {
+        UnmapFile(view_, size_);
+        view_ = nullptr;
+    }
+    size_ = 0;
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+const uint8_t* MappedFile::Data() const {
+    if (view_) {
+        return view_;
+    }
+    return buffer_.empty() ? nullptr : buffer_.data();
+}
+
+size_t MappedFile::Size() const {
+    return size_;
+}
+
+bool MappedFile::IsMapped() const {
+    return view_ != nullptr;
+}
+
+bool MappedFile::ReadToBuffer(const string& filename) {
+    ifstream file(filename, ifstream::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const std::streamoff size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    buffer_.resize(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(buffer_.data()), size);
+    if (file.gcount() != size) {
+        buffer_.clear();
+        return false;
+    }
+    size_ = buffer_.size();
+    return true;
+}
+
+} // namespace utils
+} // namespace prowogene
@@ -0,0 +1,69 @@
+#ifndef PROWOGENE_CORE_UTILS_MAPPED_FILE_H_
+#define PROWOGENE_CORE_UTILS_MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Read-only view of whole file contents.
+
+File is mapped to memory when it's possible, so pages are loaded by the OS
+only when they are touched and nothing is copied. When mapping isn't
+available (empty file, unsupported platform or file system), file is read
+to internal buffer. */
+class MappedFile {
+ public:
+    /** Constructor. */
+    MappedFile() = default;
+
+    /** Destructor. Unmaps file. */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Open file and map it to memory. Previously opened file is closed.
+    @param [in] filename - Name of file.
+    @return @c true if file is opened, @c false otherwise. */
+    bool Open(const std::string& filename);
+
+    /** Unmap file and release all resources. */
+    void Close();
+
+    /** Get file contents.
+    @return Pointer to the first byte of file, @c nullptr if file is empty
+    or not opened. */
+    const uint8_t* Data() const;
+
+    /** Get file size.
+    @return Size of file in bytes. */
+    size_t Size() const;
+
+    /** Check that file contents are mapped, not copied to buffer.
+    @return @c true if file is mapped, @c false otherwise. */
+    bool IsMapped() const;
+
+ protected:
+    /** Read whole file to buffer_.
+    @param [in] filename - Name of file.
+    @return @c true if file is read, @c false otherwise. */
+    bool ReadToBuffer(const std::string& filename);
+
+
+    /** Mapped view of file. */
+    const uint8_t*       view_ = nullptr;
+    /** Size of file in bytes. */
+    size_t               size_ = 0;
+    /** File contents when mapping isn't available. */
+    std::vector<uint8_t> buffer_;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_MAPPED_FILE_H_
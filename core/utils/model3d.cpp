@@ -1,8 +1,14 @@
 #include "model3d.h"
 
+#include <cmath>
+
 namespace prowogene {
 namespace utils {
 
+static const float kPackedNormalMax = 32767.0f;
+
+const uint32_t Model3d::kRestartIndex;
+
 Vector3D Vector3D::Multiply(const Vector3D& vector) const {
     Vector3D out;
     out.x = y * vector.z - z * vector.y;
@@ -11,5 +17,109 @@ Vector3D Vector3D::Multiply(const Vector3D& vector) const {
     return out;
 }
 
+Vector3D Vector3D::Normalize() const {
+    const float length = std::sqrt(x * x + y * y + z * z);
+    if (length <= 0.0f) {
+        return *this;
+    }
+    Vector3D out;
+    out.x = x / length;
+    out.y = y / length;
+    out.z = z / length;
+    return out;
+}
+
+static float SignNotZero(float val) {
+    return val < 0.0f ? -1.0f : 1.0f;
+}
+
+PackedNormal PackedNormal::Pack(const Vector3D& vector) {
+    PackedNormal packed;
+    const float length = std::fabs(vector.x) + std::fabs(vector.y) +
+                         std::fabs(vector.z);
+    if (length <= 0.0f) {
+        return packed;
+    }
+    float u = vector.x / length;
+    float v = vector.y / length;
+    if (vector.z < 0.0f) {
+        const float folded_u = (1.0f - std::fabs(v)) * SignNotZero(u);
+        v = (1.0f - std::fabs(u)) * SignNotZero(v);
+        u = folded_u;
+    }
+    packed.u = static_cast<int16_t>(std::lround(u * kPackedNormalMax));
+    packed.v = static_cast<int16_t>(std::lround(v * kPackedNormalMax));
+    return packed;
+}
+
+Vector3D PackedNormal::Unpack() const {
+    Vector3D vector;
+    vector.x = u / kPackedNormalMax;
+    vector.y = v / kPackedNormalMax;
+    vector.z = 1.0f - std::fabs(vector.x) - std::fabs(vector.y);
+    if (vector.z < 0.0f) {
+        const float x = vector.x;
+        vector.x = (1.0f - std::fabs(vector.y)) * SignNotZero(x);
+        vector.y = (1.0f - std::fabs(x)) * SignNotZero(vector.y);
+    }
+    const float length = std::sqrt(vector.x * vector.x +
+                                   vector.y * vector.y +
+                                   vector.z * vector.z);
+    vector.x /= length;
+    vector.y /= length;
+    vector.z /= length;
+    return vector;
+}
+
+size_t Model3d::TrianglesCount() const {
+    if (topology == MeshTopology::Triangles) {
+        return indices.size() / 3;
+    }
+    size_t count = 0;
+    ForEachTriangle([&count](uint32_t, uint32_t, uint32_t) { ++count; });
+    return count;
+}
+
+void Model3d::RemoveUnusedVertexes() {
+    const size_t count = vertexes.size();
+    std::vector<uint32_t> remap(count, kRestartIndex);
+    for (uint32_t index : indices) {
+        if (index != kRestartIndex) {
+            remap[index] = 0;
+        }
+    }
+
+    const bool has_uv = uv.size() == count;
+    const bool has_normals = normals.size() == count;
+    uint32_t used = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (remap[i] == kRestartIndex) {
+            continue;
+        }
+        remap[i] = used;
+        vertexes[used] = vertexes[i];
+        if (has_uv) {
+            uv[used] = uv[i];
+        }
+        if (has_normals) {
+            normals[used] = normals[i];
+        }
+        ++used;
+    }
+    vertexes.resize(used);
+    if (has_uv) {
+        uv.resize(used);
+    }
+    if (has_normals) {
+        normals.resize(used);
+    }
+
+    for (uint32_t& index : indices) {
+        if (index != kRestartIndex) {
+            index = remap[index];
+        }
+    }
+}
+
 } // namespace utils
 } // namespace prowogene
@@ -1,8 +1,13 @@
 #ifndef PROWOGENE_CORE_UTILS_MODEL3D_H_
 #define PROWOGENE_CORE_UTILS_MODEL3D_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <vector>
 
+#include "types.h"
+
 namespace prowogene {
 namespace utils {
 
@@ -39,39 +44,103 @@ struct Vector3D {
     @param [in] vector - Another vector to multiply.
     @return Result multiplication vector. */
     Vector3D Multiply(const Vector3D& vector) const;
+
+    /** Get unit vector with the same direction.
+    @return Unit vector, zero vector stays zero. */
+    Vector3D Normalize() const;
 };
 
 
-/** @brief Group of corelated verticies indexes. */
-struct VertexGroup {
-    /** Vertex index. */
-    int v_idx = 0;
-    /** UV vertex index. */
-    int vt_idx = -1;
-    /** Normal vector vertext index. */
-    int vn_idx = -1;
-};
+/** @brief Unit vector packed to 2 signed 16bit numbers with octahedral
+mapping. Angular error is less than 0.01 degree. */
+struct PackedNormal {
+    /** First octahedral coordinate. */
+    int16_t u = 0;
+    /** Second octahedral coordinate. */
+    int16_t v = 0;
 
+    /** Pack vector.
+    @param [in] vector - Vector to pack. Length doesn't matter.
+    @return Packed unit vector. */
+    static PackedNormal Pack(const Vector3D& vector);
 
-/** @brief Triangle face of verticies. */
-struct ObjectFace {
-    /** Group of pixels. */
-    VertexGroup groups[3];
+    /** Unpack vector.
+    @return Unit vector. */
+    Vector3D Unpack() const;
 };
 
 
-/** @brief 3D model info storage. */
+/** @brief 3D model info storage.
+
+Vertex, UV and normal vector with the same index belong to the same point,
+so faces are stored as single index buffer. */
 struct Model3d {
+    /** Index that breaks triangle strip. */
+    static const uint32_t kRestartIndex = 0xFFFFFFFF;
+
     /** Verticies. */
     std::vector<Vertex>       vertexes;
     /** UV verticies. */
     std::vector<TextureCoord> uv;
     /** Normal vectors. */
-    std::vector<Vector3D>       normals;
-    /** 3D model faces. */
-    std::vector<ObjectFace>   faces;
+    std::vector<Vector3D>     normals;
+    /** Vertex indexes of faces. */
+    std::vector<uint32_t>     indices;
+    /** Order of vertex indexes. */
+    MeshTopology              topology = MeshTopology::Triangles;
+
+    /** Get count of triangles. Degenerate triangles of strips aren't
+    counted.
+    @return Count of triangles. */
+    size_t TrianglesCount() const;
+
+    /** Remove vertexes that aren't used by faces. UV and normal vectors are
+    removed together with their vertexes, order of remaining ones is kept. */
+    void RemoveUnusedVertexes();
+
+    /** Call function for every triangle of model. Triangles of strips are
+    passed with the same winding as the first one, degenerate triangles are
+    skipped.
+    @param [in] func - Function with 3 uint32_t vertex indexes as params. */
+    template <typename Func>
+    void ForEachTriangle(Func func) const;
 };
 
+
+template <typename Func>
+void Model3d::ForEachTriangle(Func func) const {
+    const size_t count = indices.size();
+    if (topology == MeshTopology::Triangles) {
+        for (size_t i = 0; i + 2 < count; i += 3) {
+            func(indices[i], indices[i + 1], indices[i + 2]);
+        }
+        return;
+    }
+
+    size_t strip_length = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] == kRestartIndex) {
+            strip_length = 0;
+            continue;
+        }
+        ++strip_length;
+        if (strip_length < 3) {
+            continue;
+        }
+        const uint32_t a = indices[i - 2];
+        const uint32_t b = indices[i - 1];
+        const uint32_t c = indices[i];
+        if (a == b || b == c || a == c) {
+            continue;
+        }
+        if (strip_length % 2) {
+            func(a, b, c);
+        } else {
+            func(b, a, c);
+        }
+    }
+}
+
 } // namespace utils
 } // namespace prowogene
 
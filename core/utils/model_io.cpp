@@ -1,16 +1,68 @@
 #include "model_io.h"
 
+#include "settings_interface.h"
+#include "utils/gltf.h"
 #include "utils/obj.h"
 
 namespace prowogene {
 namespace utils {
 
+using std::future;
+using std::make_shared;
+using std::shared_ptr;
 using std::string;
 
-void ModelIO::Save(const Model3d& model, const ModelIOParams& params) const {
+ModelIO::ModelIO()
+    : executor_(&own_executor_) {
+}
+
+void ModelIO::SetExecutor(IOExecutor* executor) {
+    executor_ = executor ? executor : &own_executor_;
+}
+
+IOExecutor* ModelIO::GetExecutor() const {
+    return executor_;
+}
+
+bool ModelIO::Save(const Model3d& model, const ModelIOParams& params) const {
+    if (params.format == "obj") {
+        return Obj::Save(model, params);
+    } else if (params.format == "glb") {
+        return Gltf::Save(model, params);
+    }
+    return false;
+}
+
+future<void> ModelIO::SaveAsync(Model3d&& model,
+        const ModelIOParams& params) const {
+    const size_t bytes = model.vertexes.size() * sizeof(Vertex) +
+                         model.uv.size() * sizeof(TextureCoord) +
+                         model.normals.size() * sizeof(Vector3D) +
+                         model.indices.size() * sizeof(uint32_t);
+    const shared_ptr<const Model3d> owned = make_shared<Model3d>(
+        std::move(model));
+    return executor_->Submit([this, owned, params]() {
+        if (!Save(*owned, params)) {
+            throw LogicException("Can't write 3D model '" + params.filename +
+                                 "." + params.format + "'.");
+        }
+    }, bytes);
+}
+
+std::unique_ptr<ModelWriter> ModelIO::CreateWriter(
+        const ModelIOParams& params) const {
+    std::unique_ptr<ModelWriter> writer;
     if (params.format == "obj") {
-        Obj::Save(model, params);
+        writer.reset(new ObjWriter(params));
+    } else if (params.format == "glb") {
+        writer.reset(new GltfWriter(params));
     }
+    return writer;
+}
+
+bool ModelIO::SaveHeightfield(const Array2D<float>& map, const Range& range,
+        const HeightfieldParams& params) const {
+    return Heightfield::Save(map, range, params);
 }
 
 } // namespace utils
@@ -1,9 +1,13 @@
 #ifndef PROWOGENE_CORE_UTILS_MODEL_IO_H_
 #define PROWOGENE_CORE_UTILS_MODEL_IO_H_
 
+#include <future>
+#include <memory>
 #include <string>
 
 #include "model3d.h"
+#include "utils/heightfield.h"
+#include "utils/io_executor.h"
 
 namespace prowogene {
 namespace utils {
@@ -24,15 +28,91 @@ struct ModelIOParams {
     std::string texture      = "";
     /** Normal map filename. Make sense only when add_normals is @c true . */
     std::string normal_map   = "";
+    /** Store vertex attributes as integers when format supports it. */
+    bool        quantize     = false;
 };
 
-/** @brief Model input/output worker. */
+/** @brief Writer that saves single 3D model to file by parts, so whole
+model is never stored in memory.
+
+Vertexes of every part are appended after vertexes of previous parts.
+Indices of part are indices in whole model, so faces can use vertexes of
+previous parts. */
+class ModelWriter {
+ public:
+    /** Destructor. */
+    virtual ~ModelWriter() = default;
+
+    /** Append part of 3D model to file.
+    @param [in] part - Part of 3D model. */
+    virtual void Write(const Model3d& part) = 0;
+
+    /** Finish file. Parts can't be written after it.
+    @return @c true if all parts and file ending are written, @c false
+            otherwise. */
+    virtual bool Close() = 0;
+};
+
+
+/** @brief Model input/output worker.
+
+Async methods execute tasks by I/O executor, own not started executor is
+used by default, so they are synchronous until shared executor is set. */
 class ModelIO {
  public:
+    /** Constructor. */
+    ModelIO();
+
+    /** Destructor. */
+    virtual ~ModelIO() = default;
+
+    ModelIO(const ModelIO&) = delete;
+    ModelIO& operator=(const ModelIO&) = delete;
+
+    /** Set executor of async methods. It must outlive all submitted tasks.
+    @param [in] executor - Executor, @c nullptr to use own one. */
+    virtual void SetExecutor(IOExecutor* executor);
+
+    /** Get executor of async methods.
+    @return Executor. */
+    virtual IOExecutor* GetExecutor() const;
+
     /** Save 3D model to file.
     @param [in] model - 3D model to save.
-    @param [in] par   - Saving params. */
-    virtual void Save(const Model3d& model, const ModelIOParams& par) const;
+    @param [in] par   - Saving params.
+    @return @c true if file is written, @c false if format is unknown or
+            writing is failed. */
+    virtual bool Save(const Model3d& model, const ModelIOParams& par) const;
+
+    /** Save 3D model to file by I/O executor. Caller is blocked while byte
+    budget of executor is exceeded.
+    @param [in] model - 3D model to save, it's moved to the task.
+    @param [in] par   - Saving params.
+    @return Future that is ready when model is saved. Task throws
+            LogicException if model isn't saved. */
+    virtual std::future<void> SaveAsync(Model3d&& model,
+                                        const ModelIOParams& par) const;
+
+    /** Create writer for saving 3D model by parts.
+    @param [in] par - Saving params.
+    @return Writer or @c nullptr when format is unknown. */
+    virtual std::unique_ptr<ModelWriter> CreateWriter(
+        const ModelIOParams& par) const;
+
+    /** Save part of height map as heightfield tile.
+    @param [in] map - Height map.
+    @param [in] r   - Saved area, right and bottom borders are included.
+    @param [in] par - Saving params.
+    @return @c true if file is written, @c false otherwise. */
+    virtual bool SaveHeightfield(const Array2D<float>& map,
+                                 const Range& r,
+                                 const HeightfieldParams& par) const;
+
+ protected:
+    /** Executor used when shared one isn't set. */
+    IOExecutor  own_executor_;
+    /** Executor of async methods. */
+    IOExecutor* executor_;
 };
 
 } // namespace utils
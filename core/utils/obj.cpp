@@ -1,143 +1,128 @@
 #include "obj.h"
 
-#include <algorithm>
-#include <fstream>
-
 namespace prowogene {
 namespace utils {
 
-using std::ofstream;
 using std::string;
 
-static const size_t kBufferSize = 8192;
 static const int    kIndexBase = 1;
+// Approximate lengths of lines for output buffer reservation.
+static const size_t kVertexLength = 40;
+static const size_t kUVLength = 24;
+static const size_t kFaceLength = 64;
+static const size_t kHeaderLength = 64;
+
+bool Obj::Save(const Model3d& model, const ModelIOParams& params) {
+    ObjWriter writer(params);
+    writer.Write(model);
+    return writer.Close();
+}
 
-void Obj::Save(const Model3d& model, const ModelIOParams& params) {
-    const std::string full_filename = params.filename + ".obj";
-    const bool add_uv = params.add_uv;
-    const bool add_normals = params.add_normals;
 
-    ofstream file;
-    char buffer[kBufferSize];
-    file.rdbuf()->pubsetbuf(buffer, kBufferSize);
-    file.open(full_filename);
-    if (!file.is_open()) {
-        return;
+ObjWriter::ObjWriter(const ModelIOParams& params)
+        : params_(params), coord_format_(params.coord_format) {
+    text_.Reserve(kHeaderLength + 2 * params_.filename.size());
+    if (!params_.texture.empty()) {
+        text_.Add("mtllib ").Add(params_.filename).Add(".mtl\n");
     }
+    text_.Add("o ").Add(params_.filename).Add('\n');
+}
 
-    bool coord_is_positive[3];
-    int  coord_indexes[3];
-    DetectCoordFormat(params.coord_format, coord_is_positive, coord_indexes);
+ObjWriter::~ObjWriter() {
+    Close();
+}
 
-    if (params.texture.size()) {
-        file << "mtllib " << params.filename << ".mtl\n";
+void ObjWriter::Write(const Model3d& part) {
+    if (is_failed_ || is_closed_) {
+        return;
     }
-    file << "o " << params.filename << "\n";
+    const bool add_uv = params_.add_uv;
+    const bool add_normals = params_.add_normals;
+
+    const size_t vertexes_count = part.vertexes.size();
+    const size_t uv_count = add_uv ? part.uv.size() : 0;
+    const size_t normals_count = add_normals ? part.vertexes.size() : 0;
+    const size_t faces_count = part.TrianglesCount();
+    text_.Reserve(text_.Size() +
+                  kVertexLength * (vertexes_count + normals_count) +
+                  kUVLength * uv_count + kFaceLength * faces_count +
+                  kHeaderLength + params_.filename.size());
 
-    const size_t vertexes_count = model.vertexes.size();
     for (size_t i = 0; i < vertexes_count; ++i) {
         float res[3];
-        auto& vertex = model.vertexes[i];
-        ReorderCoords({ vertex.x, vertex.y, vertex.z }, coord_is_positive,
-                      coord_indexes, res);
-        file << "v " << res[0] << " " << res[1] << " " << res[2] << "\n";
-    }
-
-    if (params.add_uv) {
-        const size_t uv_count = model.uv.size();
-        for (size_t i = 0; i < uv_count; ++i) {
-            file << "vt " << model.uv[i].u << " " << model.uv[i].v << "\n";
-        }
+        auto& vertex = part.vertexes[i];
+        coord_format_.Apply({ vertex.x, vertex.y, vertex.z }, res);
+        text_.Add("v ").AddFloat(res[0]).Add(' ').AddFloat(res[1]).Add(' ').
+            AddFloat(res[2]).Add('\n');
     }
 
-    if (add_normals) {
-        const size_t normals_count = model.vertexes.size();
-        for (size_t i = 0; i < normals_count; ++i) {
-            float res[3];
-            auto& normal = model.normals[i];
-            ReorderCoords({ normal.x, normal.y, normal.z }, coord_is_positive,
-                          coord_indexes, res);
-            file << "vn " << res[0] << " " << res[1] << " " << res[2] << "\n";
-        }
+    for (size_t i = 0; i < uv_count; ++i) {
+        text_.Add("vt ").AddFloat(part.uv[i].u).Add(' ').
+            AddFloat(part.uv[i].v).Add('\n');
     }
 
-    if (params.texture.size()) {
-        file << "usemtl material_" << params.filename << "\n";
+    for (size_t i = 0; i < normals_count; ++i) {
+        float res[3];
+        auto& normal = part.normals[i];
+        coord_format_.Apply({ normal.x, normal.y, normal.z }, res);
+        text_.Add("vn ").AddFloat(res[0]).Add(' ').AddFloat(res[1]).Add(' ').
+            AddFloat(res[2]).Add('\n');
     }
 
-    for (size_t i = 0; i < model.faces.size(); ++i) {
-        const auto& group = model.faces[i].groups;
-        file << "f " <<
-            SerializeGroup(group[0], add_uv, add_normals) << " " <<
-            SerializeGroup(group[1], add_uv, add_normals) << " " <<
-            SerializeGroup(group[2], add_uv, add_normals) << "\n";
+    if (!params_.texture.empty() && !is_material_used_) {
+        text_.Add("usemtl material_").Add(params_.filename).Add('\n');
+        is_material_used_ = true;
     }
 
-    file.close();
-
-    if (params.texture.size()) {
-        file.open(params.filename + ".mtl");
-        file << "newmtl material_" << params.filename << "\n";
-        file << "map_Kd " << params.texture << "\n";
-        file << "Ks 0 0 0\n";
-        file.close();
-    }
+    part.ForEachTriangle([&](uint32_t a, uint32_t b, uint32_t c) {
+        text_.Add("f ");
+        SerializeIndex(a, add_uv, add_normals, text_);
+        text_.Add(' ');
+        SerializeIndex(b, add_uv, add_normals, text_);
+        text_.Add(' ');
+        SerializeIndex(c, add_uv, add_normals, text_);
+        text_.Add('\n');
+    });
+    Flush();
 }
 
-void Obj::DetectCoordFormat(std::string format, bool(&is_positive)[3],
-        int(&indexes)[3]) {
-    std::transform(format.begin(), format.end(), format.begin(), ::tolower);
-
-    is_positive[0] = format.find("-x") == string::npos;
-    is_positive[1] = format.find("-y") == string::npos;
-    is_positive[2] = format.find("-z") == string::npos;
-
-    size_t x_index = format.find("x");
-    size_t y_index = format.find("y");
-    size_t z_index = format.find("z");
-    if (x_index == string::npos ||
-            y_index == string::npos ||
-            z_index == string::npos) {
-        indexes[0] = 0;
-        indexes[1] = 1;
-        indexes[2] = 2;
-        return;
+bool ObjWriter::Close() {
+    if (is_closed_) {
+        return !is_failed_;
+    }
+    if (!is_created_) {
+        Flush();
+    }
+    is_closed_ = true;
+    if (is_failed_ || params_.texture.empty()) {
+        return !is_failed_;
     }
 
-    indexes[0] = static_cast<int>((x_index > y_index) + (x_index > z_index));
-    indexes[1] = static_cast<int>((y_index > x_index) + (y_index > z_index));
-    indexes[2] = static_cast<int>((z_index > x_index) + (z_index > y_index));
+    TextBuffer material;
+    material.Add("newmtl material_").Add(params_.filename).Add('\n');
+    material.Add("map_Kd ").Add(params_.texture).Add('\n');
+    material.Add("Ks 0 0 0\n");
+    is_failed_ = !material.Write(params_.filename + ".mtl");
+    return !is_failed_;
 }
 
-void Obj::ReorderCoords(const float(&coords)[3], const bool(&is_positive)[3],
-        const int(&indexes)[3], float(&out_values)[3]) {
-    float values[3];
-    for (int i = 0; i < 3; ++i) {
-        values[indexes[i]] = coords[i] * (is_positive[i] ? 1 : -1);
+void ObjWriter::Flush() {
+    if (!is_failed_) {
+        is_failed_ = !text_.Write(params_.filename + ".obj", is_created_);
+        is_created_ = true;
     }
-    out_values[0] = values[0];
-    out_values[1] = values[1];
-    out_values[2] = values[2];
+    text_.Clear();
 }
 
-inline string Obj::SerializeGroup(const VertexGroup& group,
-        bool add_uv, bool add_normals) {
+void ObjWriter::SerializeIndex(uint32_t index, bool add_uv, bool add_normals,
+        TextBuffer& text) {
+    const int64_t obj_index = static_cast<int64_t>(index) + kIndexBase;
+    text.AddInt(obj_index);
     if (add_uv) {
-        if (add_normals) {
-            return std::to_string(group.v_idx +  kIndexBase) + "/" +
-                   std::to_string(group.vt_idx + kIndexBase) +"/" +
-                   std::to_string(group.vn_idx + kIndexBase);
-        } else {
-            return std::to_string(group.v_idx +  kIndexBase) + "/" +
-                   std::to_string(group.vt_idx + kIndexBase);
-        }
-    } else {
-        if (add_normals) {
-            return std::to_string(group.v_idx +  kIndexBase) + "//" +
-                   std::to_string(group.vn_idx + kIndexBase);
-        } else {
-            return std::to_string(group.v_idx + kIndexBase);
-        }
+        text.Add('/').AddInt(obj_index);
+    }
+    if (add_normals) {
+        text.Add(add_uv ? "/" : "//").AddInt(obj_index);
     }
 }
 
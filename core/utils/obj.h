@@ -1,7 +1,9 @@
 #ifndef PROWOGENE_CORE_UTILS_OBJ_H_
 #define PROWOGENE_CORE_UTILS_OBJ_H_
 
+#include "utils/coord_format.h"
 #include "utils/model_io.h"
+#include "utils/text_buffer.h"
 
 namespace prowogene {
 namespace utils {
@@ -11,36 +13,60 @@ class Obj {
  public:
     /** Save 3D model to file.
     @param [in] model  - 3D model to save.
+    @param [in] params - Saving params.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Save(const Model3d& model, const ModelIOParams& params);
+};
+
+
+/** @brief Writer of Wavefront OBJ 3D model files by parts.
+
+Vertexes, UV and normals of every part are placed before it's faces, so
+model saved by single part is the same as model saved by Obj::Save. */
+class ObjWriter : public ModelWriter {
+ public:
+    /** Constructor.
     @param [in] params - Saving params. */
-    static void Save(const Model3d& model, const ModelIOParams& params);
+    explicit ObjWriter(const ModelIOParams& params);
+
+    /** Destructor. Finishes file if it isn't closed. */
+    ~ObjWriter() override;
+
+    /** @copydoc ModelWriter::Write */
+    void Write(const Model3d& part) override;
+
+    /** @copydoc ModelWriter::Close */
+    bool Close() override;
 
  protected:
-    /** Dectect coord order and their axis directions from string.
-    @param [in] format       - String with coords order and their signs.
-    @param [out] is_positive - X, Y and Z axis signs.
-    @param [out] indexes     - X, Y and Z position indexes. */
-    static void DetectCoordFormat(std::string format,
-                                  bool (&is_positive)[3],
-                                  int  (&indexes)[3]);
-
-    /** Reorder point coords according user format.
-    @param [in] coords      - input point coordinates.
-    @param [in] is_positive - X, Y and Z axis signs.
-    @param [in] indexes     - X, Y and Z position indexes.
-    @param [out] out_values - output point coordinates. */
-    static void ReorderCoords(const float (&coords)[3],
-                              const bool(&is_positive)[3],
-                              const int(&indexes)[3],
-                              float (&out_values)[3]);
-
-    /** Serialize vertex group to a string.
-    @param [in] group       - Vertex group.
+    /** Write buffered text to the end of file. */
+    void Flush();
+
+    /** Serialize face vertex to the end of text. The same index is used for
+    vertex, UV and normal vector.
+    @param [in] index       - Vertex index.
     @param [in] add_uv      - Add uv.
     @param [in] add_normals - Add normals.
-    @return String representation of given vertex group. */
-    static std::string SerializeGroup(const VertexGroup& group,
-                                      bool add_uv,
-                                      bool add_normals);
+    @param [in, out] text   - Output text. */
+    static void SerializeIndex(uint32_t index,
+                               bool add_uv,
+                               bool add_normals,
+                               TextBuffer& text);
+
+    /** Saving params. */
+    ModelIOParams params_;
+    /** Coord order and axis directions. */
+    CoordFormat   coord_format_;
+    /** Text that isn't written to file yet. */
+    TextBuffer    text_;
+    /** File is created. */
+    bool          is_created_ = false;
+    /** File writing is failed, all next parts are skipped. */
+    bool          is_failed_ = false;
+    /** Material is set for faces. */
+    bool          is_material_used_ = false;
+    /** File is finished. */
+    bool          is_closed_ = false;
 };
 
 } // namespace utils
@@ -0,0 +1,45 @@
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace prowogene {
+namespace utils {
+
+using std::thread;
+using std::vector;
+
+void ParallelFor(int count, int thread_count,
+        const std::function<void(int, int)>& func) {
+    thread_count = std::max(1, std::min(thread_count, count));
+    const int block_size = count / thread_count;
+    vector<thread> threads(thread_count);
+    vector<std::exception_ptr> errors(thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        const int beg = i * block_size;
+        const int end = i == thread_count - 1 ? count : beg + block_size;
+        threads[i] = thread([&func, &errors, i, beg, end]() {
+            try {
+                func(beg, end);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& th : threads) {
+        if (th.joinable()) {
+            th.join();
+        }
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace utils
+} // namespace prowogene
@@ -0,0 +1,23 @@
+#ifndef PROWOGENE_CORE_UTILS_PARALLEL_FOR_H_
+#define PROWOGENE_CORE_UTILS_PARALLEL_FOR_H_
+
+#include <functional>
+
+namespace prowogene {
+namespace utils {
+
+/** Split range [0, count) to contiguous parts and process them in parallel.
+Returns when all parts are processed. First exception thrown by function
+is rethrown after that.
+@param [in] count        - Count of elements.
+@param [in] thread_count - Maximal count of threads. Values less than 1
+                           mean single thread.
+@param [in] func         - Function that processes elements in range
+                           [begin, end). */
+void ParallelFor(int count, int thread_count,
+                 const std::function<void(int, int)>& func);
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_PARALLEL_FOR_H_
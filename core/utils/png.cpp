@@ -0,0 +1,247 @@
+#include "png.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "utils/deflate.h"
+#include "utils/parallel_for.h"
+
+namespace prowogene {
+namespace utils {
+
+using std::string;
+using std::vector;
+
+static const uint8_t kSignature[8] = {
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A
+};
+static const int kFilterCount = 5;
+
+static void PutUInt32(uint32_t val, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(val >> 24);
+    out[1] = static_cast<uint8_t>(val >> 16);
+    out[2] = static_cast<uint8_t>(val >> 8);
+    out[3] = static_cast<uint8_t>(val);
+}
+
+static inline uint8_t Paeth(uint8_t left, uint8_t up, uint8_t up_left) {
+    const int estimate = left + up - up_left;
+    const int diff_left = abs(estimate - left);
+    const int diff_up = abs(estimate - up);
+    const int diff_up_left = abs(estimate - up_left);
+    if (diff_left <= diff_up && diff_left <= diff_up_left) {
+        return left;
+    }
+    return (diff_up <= diff_up_left) ? up : up_left;
+}
+
+static inline uint8_t Filter(int type, const uint8_t* row,
+                             const uint8_t* prev, size_t i, int bpp) {
+    const uint8_t left = (i >= static_cast<size_t>(bpp)) ? row[i - bpp] : 0;
+    const uint8_t up_left = (i >= static_cast<size_t>(bpp)) ?
+                            prev[i - bpp] : 0;
+    switch (type) {
+    case 1:
+        return row[i] - left;
+    case 2:
+        return row[i] - prev[i];
+    case 3:
+        return row[i] - static_cast<uint8_t>((left + prev[i]) / 2);
+    case 4:
+        return row[i] - Paeth(left, prev[i], up_left);
+    default:
+        return row[i];
+    }
+}
+
+
+bool Png::Encode(const string& file, const Image& data, int bits,
+        int thread_count) {
+    const int width = data.Width();
+    const bool has_alpha = bits == 32;
+    const RowSource source = [&data, width, has_alpha](int y, uint8_t* row) {
+        const RgbaPixel* src = data.Data() + static_cast<size_t>(y) * width;
+        if (has_alpha) {
+            memcpy(row, src, static_cast<size_t>(width) * sizeof(RgbaPixel));
+            return;
+        }
+        for (int x = 0; x < width; ++x) {
+            row[x * 3] = src[x].red;
+            row[x * 3 + 1] = src[x].green;
+            row[x * 3 + 2] = src[x].blue;
+        }
+    };
+    return Encode(file, width, data.Height(),
+                  has_alpha ? kColorRgba : kColorRgb, 8, source,
+                  thread_count);
+}
+
+bool Png::Encode(const string& filename, int width, int height,
+        int color_type, int bit_depth, const RowSource& source,
+        int thread_count) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const int channels = (color_type == kColorRgba) ? 4 :
+                         (color_type == kColorRgb) ? 3 : 1;
+    const int bpp = channels * bit_depth / 8;
+    const size_t row_size = static_cast<size_t>(width) * bpp;
+    const size_t filtered_size = row_size + 1;
+    const int segment_rows = static_cast<int>(std::min<size_t>(
+        std::max<size_t>(kSegmentSize / filtered_size, 1), height));
+    const int segments = (height + segment_rows - 1) / segment_rows;
+    const int group_size = std::max(thread_count, 1);
+
+    file.write(reinterpret_cast<const char*>(kSignature), sizeof(kSignature));
+    uint8_t header[13];
+    PutUInt32(static_cast<uint32_t>(width), header);
+    PutUInt32(static_cast<uint32_t>(height), header + 4);
+    header[8] = static_cast<uint8_t>(bit_depth);
+    header[9] = static_cast<uint8_t>(color_type);
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    WriteChunk("IHDR", header, sizeof(header), file);
+
+    // Segments are processed by groups to keep memory bounded. Filtered
+    // data of group is preceded by the tail of previous group, so every
+    // segment can refer to the whole deflate window.
+    const size_t segment_size = segment_rows * filtered_size;
+    vector<uint8_t> filtered(Deflate::kWindowSize + group_size * segment_size);
+    vector<vector<uint8_t>> compressed(group_size);
+    size_t history = 0;
+    uint32_t adler = 1;
+    for (int group = 0; group < segments; group += group_size) {
+        const int count = std::min(group_size, segments - group);
+        const int first_row = group * segment_rows;
+        const int last_row = std::min(height, first_row + count * segment_rows);
+        const size_t group_bytes = (last_row - first_row) * filtered_size;
+
+        ParallelFor(count, thread_count, [&](int begin, int end) {
+            vector<uint8_t> row(row_size);
+            vector<uint8_t> prev(row_size, 0);
+            for (int i = begin; i < end; ++i) {
+                const int top = first_row + i * segment_rows;
+                const int bottom = std::min(height, top + segment_rows);
+                uint8_t* out = filtered.data() + history + i * segment_size;
+                if (top > 0) {
+                    source(top - 1, prev.data());
+                } else {
+                    std::fill(prev.begin(), prev.end(), 0);
+                }
+                for (int y = top; y < bottom; ++y) {
+                    source(y, row.data());
+                    FilterRow(row.data(), prev.data(), row_size, bpp, out);
+                    out += filtered_size;
+                    row.swap(prev);
+                }
+            }
+        });
+
+        ParallelFor(count, thread_count, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                const size_t start = history + i * segment_size;
+                const size_t size = std::min(segment_size,
+                                             history + group_bytes - start);
+                vector<uint8_t>& out = compressed[i];
+                out.clear();
+                if (group + i == 0) {
+                    Deflate::WriteHeader(out);
+                }
+                Deflate::Compress(filtered.data() + start,
+                                  std::min(start, Deflate::kWindowSize),
+                                  size, group + i == segments - 1, out);
+            }
+        });
+
+        adler = Deflate::Adler32(adler, filtered.data() + history,
+                                 group_bytes);
+        for (int i = 0; i < count; ++i) {
+            if (group + i == segments - 1) {
+                Deflate::WriteTrailer(adler, compressed[i]);
+            }
+            WriteChunk("IDAT", compressed[i].data(), compressed[i].size(),
+                       file);
+        }
+
+        const size_t total = history + group_bytes;
+        const size_t keep = std::min(total, Deflate::kWindowSize);
+        memmove(filtered.data(), filtered.data() + total - keep, keep);
+        history = keep;
+    }
+
+    WriteChunk("IEND", nullptr, 0, file);
+    file.close();
+    return !file.fail();
+}
+
+void Png::FilterRow(const uint8_t* row, const uint8_t* prev, size_t size,
+        int bpp, uint8_t* out) {
+    // Filtered bytes are treated as signed, the smallest sum of absolute
+    // values usually gives the best compression.
+    uint64_t sums[kFilterCount] = {0};
+    for (int type = 0; type < kFilterCount; ++type) {
+        for (size_t i = 0; i < size; ++i) {
+            const int8_t val = static_cast<int8_t>(
+                Filter(type, row, prev, i, bpp));
+            sums[type] += abs(val);
+        }
+    }
+    const int best = static_cast<int>(
+        std::min_element(sums, sums + kFilterCount) - sums);
+
+    out[0] = static_cast<uint8_t>(best);
+    for (size_t i = 0; i < size; ++i) {
+        out[i + 1] = Filter(best, row, prev, i, bpp);
+    }
+}
+
+void Png::WriteChunk(const char* type, const uint8_t* data, size_t size,
+        std::ofstream& file) {
+    uint8_t head[8];
+    PutUInt32(static_cast<uint32_t>(size), head);
+    memcpy(head + 4, type, 4);
+    uint32_t crc = Crc32(0, head + 4, 4);
+    if (size) {
+        crc = Crc32(crc, data, size);
+    }
+    uint8_t tail[4];
+    PutUInt32(crc, tail);
+
+    file.write(reinterpret_cast<const char*>(head), sizeof(head));
+    if (size) {
+        file.write(reinterpret_cast<const char*>(data), size);
+    }
+    file.write(reinterpret_cast<const char*>(tail), sizeof(tail));
+}
+
+uint32_t Png::Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    static const vector<uint32_t> table = []() {
+        vector<uint32_t> values(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t val = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                val = (val & 1) ? (0xEDB88320U ^ (val >> 1)) : (val >> 1);
+            }
+            values[i] = val;
+        }
+        return values;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace utils
+} // namespace prowogene
@@ -0,0 +1,104 @@
+#ifndef PROWOGENE_CORE_UTILS_PNG_H_
+#define PROWOGENE_CORE_UTILS_PNG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fstream>
+#include <functional>
+#include <string>
+
+#include "utils/image.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief PNG files encoding support.
+
+Supports encoding of 24- and 32- bit images and 8- or 16- bit grayscale
+rows from any source. Filter of every row is chosen by minimal sum of
+absolute differences. Rows are split to segments of about kSegmentSize
+bytes that are filtered and compressed in parallel, output doesn't depend
+on threads count. */
+class Png {
+ public:
+    /** Function that fills row of pixels in PNG sample format.
+    @param [in] y    - Row index from top.
+    @param [out] row - Row data. */
+    using RowSource = std::function<void(int y, uint8_t* row)>;
+
+    /** Grayscale color type. */
+    static const int kColorGray = 0;
+    /** RGB color type. */
+    static const int kColorRgb = 2;
+    /** RGBA color type. */
+    static const int kColorRgba = 6;
+
+    /** Save image to PNG file.
+    @param [in] file         - Filename to save image.
+    @param [in] data         - Data for saving.
+    @param [in] bits         - Bit depth of output image, 24 or 32.
+    @param [in] thread_count - Count of threads for compression.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Encode(const std::string& file,
+                       const Image& data,
+                       int bits,
+                       int thread_count);
+
+    /** Save rows to PNG file.
+    @param [in] file         - Filename to save image.
+    @param [in] width        - Image width in pixels.
+    @param [in] height       - Image height in pixels.
+    @param [in] color_type   - kColorGray, kColorRgb or kColorRgba.
+    @param [in] bit_depth    - Bits per sample, 8 or 16. 16bit samples are
+                               big-endian.
+    @param [in] source       - Source of rows. Can be called from several
+                               threads at the same time.
+    @param [in] thread_count - Count of threads for compression.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Encode(const std::string& file,
+                       int width,
+                       int height,
+                       int color_type,
+                       int bit_depth,
+                       const RowSource& source,
+                       int thread_count);
+
+ protected:
+    /** Approximate size of filtered data compressed by single thread. */
+    static const size_t kSegmentSize = 1 << 18;
+
+    /** Filter row with the best filter.
+    @param [in] row  - Row data.
+    @param [in] prev - Previous row data, zeros for the first row.
+    @param [in] size - Size of row in bytes.
+    @param [in] bpp  - Bytes per pixel.
+    @param [out] out - Filter type followed by filtered row. */
+    static void FilterRow(const uint8_t* row,
+                          const uint8_t* prev,
+                          size_t size,
+                          int bpp,
+                          uint8_t* out);
+
+    /** Write PNG chunk.
+    @param [in] type      - Chunk type, 4 characters.
+    @param [in] data      - Chunk data.
+    @param [in] size      - Size of chunk data in bytes.
+    @param [in, out] file - Output file. */
+    static void WriteChunk(const char* type,
+                           const uint8_t* data,
+                           size_t size,
+                           std::ofstream& file);
+
+    /** Update CRC-32 checksum.
+    @param [in] crc  - Checksum of previous data, 0 for empty data.
+    @param [in] data - Next data.
+    @param [in] size - Size of next data in bytes.
+    @return Checksum of previous and next data. */
+    static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size);
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_PNG_H_
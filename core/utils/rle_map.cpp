@@ -0,0 +1,147 @@
+#include "rle_map.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "utils/mapped_file.h"
+
+namespace prowogene {
+namespace utils {
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+static const char kSignature[4] = {'P', 'W', 'R', 'L'};
+
+static void PutU32(uint8_t* dst, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+static uint32_t GetU32(const uint8_t* src) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+bool RleMap::Encode(const string& filename, const uint8_t* indices,
+        int width, int height, const vector<RgbaPixel>& palette) {
+    ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const int colors_count = std::min<int>(
+        static_cast<int>(palette.size()), kPaletteSize);
+    vector<uint8_t> header(kHeaderSize + colors_count * 4);
+    memcpy(header.data(), kSignature, sizeof(kSignature));
+    PutU32(header.data() + 4,  kVersion);
+    PutU32(header.data() + 8,  std::max(width, 0));
+    PutU32(header.data() + 12, std::max(height, 0));
+    PutU32(header.data() + 16, colors_count);
+    for (int i = 0; i < colors_count; ++i) {
+        uint8_t* color = header.data() + kHeaderSize + i * 4;
+        color[0] = palette[i].red;
+        color[1] = palette[i].green;
+        color[2] = palette[i].blue;
+        color[3] = palette[i].alpha;
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    if (width <= 0 || height <= 0) {
+        file.close();
+        return !file.fail();
+    }
+
+    vector<uint8_t> block;
+    block.reserve(kWriteBlockRuns * kRunSize);
+    const size_t count = static_cast<size_t>(width) * height;
+    size_t pos = 0;
+    while (pos < count) {
+        const uint8_t value = indices[pos];
+        const size_t max_end = std::min(count, pos + kMaxRunLength);
+        size_t end = pos + 1;
+        while (end < max_end && indices[end] == value) {
+            ++end;
+        }
+        const size_t length = end - pos;
+        block.push_back(value);
+        block.push_back(static_cast<uint8_t>(length & 0xFF));
+        block.push_back(static_cast<uint8_t>(length >> 8));
+        if (block.size() >= kWriteBlockRuns * kRunSize) {
+            file.write(reinterpret_cast<const char*>(block.data()),
+                       block.size());
+            block.clear();
+        }
+        pos = end;
+    }
+    file.write(reinterpret_cast<const char*>(block.data()), block.size());
+    file.close();
+    return !file.fail();
+}
+
+bool RleMap::Decode(const string& filename, Array2D<uint8_t>& indices,
+        vector<RgbaPixel>& palette) {
+    MappedFile file;
+    if (!file.Open(filename) || file.Size() < kHeaderSize) {
+        return false;
+    }
+    const uint8_t* data = file.Data();
+    const size_t size = file.Size();
+    if (memcmp(data, kSignature, sizeof(kSignature)) ||
+            GetU32(data + 4) != kVersion) {
+        return false;
+    }
+    const uint32_t width = GetU32(data + 8);
+    const uint32_t height = GetU32(data + 12);
+    const uint32_t colors_count = GetU32(data + 16);
+    if (width > INT32_MAX || height > INT32_MAX ||
+            colors_count > kPaletteSize ||
+            size < kHeaderSize + colors_count * 4) {
+        return false;
+    }
+
+    vector<RgbaPixel> decoded_palette(colors_count);
+    for (uint32_t i = 0; i < colors_count; ++i) {
+        const uint8_t* color = data + kHeaderSize + i * 4;
+        decoded_palette[i] = RgbaPixel(color[0], color[1], color[2],
+                                       color[3]);
+    }
+
+    // Every run covers at least one cell, so file size limits map size
+    // before memory for it is allocated.
+    size_t pos = kHeaderSize + colors_count * 4;
+    const uint64_t count = static_cast<uint64_t>(width) * height;
+    if (count > (size - pos) / kRunSize * kMaxRunLength) {
+        return false;
+    }
+    Array2D<uint8_t> decoded(static_cast<int>(width),
+                             static_cast<int>(height));
+    uint8_t* dst = decoded.Data();
+    uint64_t filled = 0;
+    while (filled < count) {
+        if (size - pos < kRunSize) {
+            return false;
+        }
+        const uint8_t value = data[pos];
+        const uint64_t length = data[pos + 1] | (data[pos + 2] << 8);
+        pos += kRunSize;
+        if (!length || length > count - filled) {
+            return false;
+        }
+        memset(dst + filled, value, static_cast<size_t>(length));
+        filled += length;
+    }
+
+    indices = std::move(decoded);
+    palette = std::move(decoded_palette);
+    return true;
+}
+
+} // namespace utils
+} // namespace prowogene
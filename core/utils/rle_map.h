@@ -0,0 +1,66 @@
+#ifndef PROWOGENE_CORE_UTILS_RLE_MAP_H_
+#define PROWOGENE_CORE_UTILS_RLE_MAP_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "utils/array2d.h"
+#include "utils/image.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Run-length encoded map of palette indices.
+
+All numbers are little-endian. File starts with 20 bytes header:
+@c "PWRL" signature and 32bit unsigned version, width, height and count
+of palette colors. Header is followed by palette as RGBA bytes and runs.
+Every run is 8bit palette index and 16bit unsigned count of cells with
+that index. Runs go through rows from top to bottom and can continue on
+the next row. */
+class RleMap {
+ public:
+    /** Version of file format. */
+    static const uint32_t kVersion = 1;
+
+    /** Save indices to file.
+    @param [in] file    - Filename to save map.
+    @param [in] indices - Palette indices of cells row by row from top.
+    @param [in] width   - Map width.
+    @param [in] height  - Map height.
+    @param [in] palette - Colors of palette, up to 256 entries.
+    @return @c true if file is written, @c false otherwise. */
+    static bool Encode(const std::string& file,
+                       const uint8_t* indices,
+                       int width,
+                       int height,
+                       const std::vector<RgbaPixel>& palette);
+
+    /** Read indices from file. Outputs aren't changed on failure.
+    @param [in] file     - Filename of map.
+    @param [out] indices - Palette indices of cells.
+    @param [out] palette - Colors of palette.
+    @return @c true if decoding is succeeded, @c false otherwise. */
+    static bool Decode(const std::string& file,
+                       Array2D<uint8_t>& indices,
+                       std::vector<RgbaPixel>& palette);
+
+ protected:
+    /** Size of header in bytes. */
+    static const size_t kHeaderSize = 20;
+    /** Size of run in bytes. */
+    static const size_t kRunSize = 3;
+    /** Maximal count of cells in one run. */
+    static const int    kMaxRunLength = 0xFFFF;
+    /** Maximal count of palette colors. */
+    static const int    kPaletteSize = 256;
+    /** Count of runs encoded to buffer before writing to file. */
+    static const size_t kWriteBlockRuns = 1 << 16;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_RLE_MAP_H_
@@ -0,0 +1,209 @@
+#include "text_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <cmath>
+
+namespace prowogene {
+namespace utils {
+
+using std::string;
+
+static const int kMaxFloatDigits = 9;
+static const int kMaxExactPow10 = 22;
+static const int kMinFixedExponent = -5;
+static const int kMaxFixedExponent = 9;
+
+// Exact multiplication by power of 10 for |pow| <= kMaxExactPow10.
+static double ScalePow10(double val, int pow) {
+    static const double kPow10[kMaxExactPow10 + 1] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    while (pow > kMaxExactPow10) {
+        val *= kPow10[kMaxExactPow10];
+        pow -= kMaxExactPow10;
+    }
+    while (pow < -kMaxExactPow10) {
+        val /= kPow10[kMaxExactPow10];
+        pow += kMaxExactPow10;
+    }
+    return pow >= 0 ? val * kPow10[pow] : val / kPow10[-pow];
+}
+
+// Write decimal digits of positive number, returns count of digits.
+static size_t WriteDigits(uint64_t val, char* out) {
+    char tmp[TextBuffer::kMaxNumberLength];
+    size_t len = 0;
+    do {
+        tmp[len++] = static_cast<char>('0' + val % 10);
+        val /= 10;
+    } while (val);
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = tmp[len - 1 - i];
+    }
+    return len;
+}
+
+
+TextBuffer::TextBuffer(size_t capacity) {
+    Reserve(capacity);
+}
+
+TextBuffer& TextBuffer::Add(const string& str) {
+    data_.insert(data_.end(), str.begin(), str.end());
+    return *this;
+}
+
+TextBuffer& TextBuffer::Add(const char* str) {
+    data_.insert(data_.end(), str, str + strlen(str));
+    return *this;
+}
+
+TextBuffer& TextBuffer::Add(char c) {
+    data_.push_back(c);
+    return *this;
+}
+
+TextBuffer& TextBuffer::AddInt(int64_t val) {
+    const size_t size = data_.size();
+    data_.resize(size + kMaxNumberLength);
+    data_.resize(size + FormatInt(val, data_.data() + size));
+    return *this;
+}
+
+TextBuffer& TextBuffer::AddFloat(float val) {
+    const size_t size = data_.size();
+    data_.resize(size + kMaxNumberLength);
+    data_.resize(size + FormatFloat(val, data_.data() + size));
+    return *this;
+}
+
+void TextBuffer::Reserve(size_t capacity) {
+    data_.reserve(capacity);
+}
+
+void TextBuffer::Clear() {
+    data_.clear();
+}
+
+const char* TextBuffer::Data() const {
+    return data_.data();
+}
+
+size_t TextBuffer::Size() const {
+    return data_.size();
+}
+
+bool TextBuffer::Write(const string& filename, bool append) const {
+    FILE* file = fopen(filename.c_str(), append ? "ab" : "wb");
+    if (!file) {
+        return false;
+    }
+    setvbuf(file, nullptr, _IONBF, 0);
+    const size_t written = fwrite(data_.data(), 1, data_.size(), file);
+    const bool closed = !fclose(file);
+    return closed && written == data_.size();
+}
+
+size_t TextBuffer::FormatInt(int64_t val, char* out) {
+    if (val < 0) {
+        out[0] = '-';
+        const uint64_t abs_val = static_cast<uint64_t>(-(val + 1)) + 1;
+        return WriteDigits(abs_val, out + 1) + 1;
+    }
+    return WriteDigits(static_cast<uint64_t>(val), out);
+}
+
+size_t TextBuffer::FormatFloat(float val, char* out) {
+    char* pos = out;
+    if (std::signbit(val)) {
+        *pos++ = '-';
+        val = -val;
+    }
+    if (std::isnan(val) || std::isinf(val)) {
+        const char* str = std::isnan(val) ? "nan" : "inf";
+        memcpy(pos, str, 3);
+        return pos - out + 3;
+    }
+    if (val == 0.0f) {
+        *pos++ = '0';
+        return pos - out;
+    }
+
+    // Float value is exactly representable as double. The shortest count of
+    // significant digits that is read back to the same float is found by
+    // binary search, 9 digits are always enough.
+    const double value = val;
+    int exp2 = 0;
+    std::frexp(value, &exp2);
+    int exp10 = static_cast<int>(std::floor((exp2 - 1) * 0.30103));
+    if (ScalePow10(1.0, exp10 + 1) <= value) {
+        ++exp10;
+    }
+    auto get_digits = [value, exp10](int len) {
+        return static_cast<uint64_t>(
+            std::floor(ScalePow10(value, len - 1 - exp10) + 0.5));
+    };
+    int low = 1;
+    int high = kMaxFloatDigits;
+    while (low < high) {
+        const int len = (low + high) / 2;
+        const double back = ScalePow10(static_cast<double>(get_digits(len)),
+                                       exp10 - len + 1);
+        if (static_cast<float>(back) == val) {
+            high = len;
+        } else {
+            low = len + 1;
+        }
+    }
+    uint64_t digits = get_digits(low);
+    int last_pow = exp10 - low + 1;
+    while (digits && digits % 10 == 0) {
+        digits /= 10;
+        ++last_pow;
+    }
+
+    char str[kMaxNumberLength];
+    const int len = static_cast<int>(WriteDigits(digits, str));
+    const int first_pow = last_pow + len - 1;
+    if (first_pow < kMinFixedExponent || first_pow >= kMaxFixedExponent) {
+        *pos++ = str[0];
+        if (len > 1) {
+            *pos++ = '.';
+            memcpy(pos, str + 1, len - 1);
+            pos += len - 1;
+        }
+        *pos++ = 'e';
+        *pos++ = first_pow < 0 ? '-' : '+';
+        const int abs_pow = first_pow < 0 ? -first_pow : first_pow;
+        if (abs_pow < 10) {
+            *pos++ = '0';
+        }
+        pos += WriteDigits(abs_pow, pos);
+    } else if (last_pow >= 0) {
+        memcpy(pos, str, len);
+        pos += len;
+        memset(pos, '0', last_pow);
+        pos += last_pow;
+    } else if (first_pow >= 0) {
+        memcpy(pos, str, first_pow + 1);
+        pos += first_pow + 1;
+        *pos++ = '.';
+        memcpy(pos, str + first_pow + 1, len - first_pow - 1);
+        pos += len - first_pow - 1;
+    } else {
+        *pos++ = '0';
+        *pos++ = '.';
+        memset(pos, '0', -first_pow - 1);
+        pos += -first_pow - 1;
+        memcpy(pos, str, len);
+        pos += len;
+    }
+    return pos - out;
+}
+
+} // namespace utils
+} // namespace prowogene
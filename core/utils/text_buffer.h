@@ -0,0 +1,93 @@
+#ifndef PROWOGENE_CORE_UTILS_TEXT_BUFFER_H_
+#define PROWOGENE_CORE_UTILS_TEXT_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Contiguous buffer for fast text files creation.
+
+Numbers are formatted without locale and streams, whole buffer is written
+to file by single call. */
+class TextBuffer {
+ public:
+    /** Maximal length of formatted number. */
+    static const size_t kMaxNumberLength = 24;
+
+    /** Constructor.
+    @param [in] capacity - Expected size of text in bytes. */
+    explicit TextBuffer(size_t capacity = 0);
+
+    /** Add string to the end of buffer.
+    @param [in] str - String to add.
+    @return Reference to this buffer. */
+    TextBuffer& Add(const std::string& str);
+
+    /** @copydoc TextBuffer::Add(const std::string&) */
+    TextBuffer& Add(const char* str);
+
+    /** Add character to the end of buffer.
+    @param [in] c - Character to add.
+    @return Reference to this buffer. */
+    TextBuffer& Add(char c);
+
+    /** Add integer number to the end of buffer.
+    @param [in] val - Number to add.
+    @return Reference to this buffer. */
+    TextBuffer& AddInt(int64_t val);
+
+    /** Add floating point number to the end of buffer.
+    @param [in] val - Number to add.
+    @return Reference to this buffer. */
+    TextBuffer& AddFloat(float val);
+
+    /** Reserve memory for text.
+    @param [in] capacity - Expected size of text in bytes. */
+    void Reserve(size_t capacity);
+
+    /** Remove all text from buffer. */
+    void Clear();
+
+    /** Get text data.
+    @return Pointer to the first character. Text isn't null-terminated. */
+    const char* Data() const;
+
+    /** Get text size.
+    @return Text size in bytes. */
+    size_t Size() const;
+
+    /** Write whole buffer to file.
+    @param [in] filename - Output filename.
+    @param [in] append   - Add text to the end of existing file or rewrite
+                           it.
+    @return @c true when file is written, @c false otherwise. */
+    bool Write(const std::string& filename, bool append = false) const;
+
+    /** Format integer number.
+    @param [in] val  - Number to format.
+    @param [out] out - Output characters, at least kMaxNumberLength.
+    @return Count of written characters. */
+    static size_t FormatInt(int64_t val, char* out);
+
+    /** Format floating point number with the shortest decimal representation
+    that is read back to the same value. Exponential form is used only for
+    very big and very small values.
+    @param [in] val  - Number to format.
+    @param [out] out - Output characters, at least kMaxNumberLength.
+    @return Count of written characters. */
+    static size_t FormatFloat(float val, char* out);
+
+ protected:
+    /** Text data. */
+    std::vector<char> data_;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_TEXT_BUFFER_H_
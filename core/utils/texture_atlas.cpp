@@ -0,0 +1,290 @@
+#include "texture_atlas.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+namespace prowogene {
+namespace utils {
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::vector;
+
+const char TextureAtlas::kExtension[] = "pta";
+
+static const char kSignature[4] = {'P', 'W', 'T', 'A'};
+
+static void PutU32(uint8_t* dst, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+static void PutU64(uint8_t* dst, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        dst[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+static uint32_t GetU32(const uint8_t* src) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+static uint64_t GetU64(const uint8_t* src) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+static bool IsCorrect(const AtlasLayout& layout) {
+    if (layout.count_x < 1 || layout.count_y < 1 || layout.tile_size < 1 ||
+            layout.layers < 1 || layout.levels < 1 || layout.levels > 31) {
+        return false;
+    }
+    if (layout.channels != 3 && layout.channels != 4) {
+        return false;
+    }
+    return (layout.tile_size >> (layout.levels - 1)) > 0;
+}
+
+static uint64_t GetEntryCount(const AtlasLayout& layout) {
+    return static_cast<uint64_t>(layout.layers) * layout.count_y *
+           layout.count_x * layout.levels;
+}
+
+static uint64_t GetTileBytes(const AtlasLayout& layout, int level) {
+    const uint64_t side = TextureAtlas::GetLevelSize(layout, level);
+    return side * side * layout.channels;
+}
+
+int TextureAtlas::GetLevelSize(const AtlasLayout& layout, int level) {
+    return std::max(1, layout.tile_size >> level);
+}
+
+int64_t TextureAtlas::GetEntryIndex(const AtlasLayout& layout,
+        int layer, int x, int y, int level) {
+    if (layer < 0 || layer >= layout.layers ||
+            x < 0 || x >= layout.count_x ||
+            y < 0 || y >= layout.count_y ||
+            level < 0 || level >= layout.levels) {
+        return -1;
+    }
+    int64_t idx = static_cast<int64_t>(layer) * layout.count_y + y;
+    idx = idx * layout.count_x + x;
+    return idx * layout.levels + level;
+}
+
+
+AtlasWriter::~AtlasWriter() {
+    Close();
+}
+
+bool AtlasWriter::Open(const string& filename, const AtlasLayout& layout) {
+    Close();
+    if (!IsCorrect(layout)) {
+        return false;
+    }
+    lock_guard<mutex> lock(mutex_);
+    file_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        return false;
+    }
+    layout_ = layout;
+
+    const size_t count = static_cast<size_t>(GetEntryCount(layout));
+    const uint64_t align = TextureAtlas::kTileAlignment;
+    uint64_t offset = TextureAtlas::kHeaderSize +
+                      count * TextureAtlas::kEntrySize;
+    offsets_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        offset = (offset + align - 1) / align * align;
+        offsets_[i] = offset;
+        offset += GetTileBytes(layout, static_cast<int>(i % layout.levels));
+    }
+    written_.assign(count, false);
+
+    // Empty offset table is written right away, so atlas is correct even
+    // if it's not closed.
+    vector<uint8_t> header(TextureAtlas::kHeaderSize +
+                           count * TextureAtlas::kEntrySize, 0);
+    memcpy(header.data(), kSignature, sizeof(kSignature));
+    PutU32(header.data() + 4,  TextureAtlas::kVersion);
+    PutU32(header.data() + 8,  layout.count_x);
+    PutU32(header.data() + 12, layout.count_y);
+    PutU32(header.data() + 16, layout.tile_size);
+    PutU32(header.data() + 20, layout.levels);
+    PutU32(header.data() + 24, layout.layers);
+    PutU32(header.data() + 28, layout.channels);
+    file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+    return file_.good();
+}
+
+bool AtlasWriter::Write(const Image& tile, int layer, int x, int y,
+        int level) {
+    const int64_t idx = TextureAtlas::GetEntryIndex(layout_, layer, x, y,
+                                                    level);
+    const int side = TextureAtlas::GetLevelSize(layout_, level);
+    if (idx < 0 || tile.Width() != side || tile.Height() != side) {
+        return false;
+    }
+
+    vector<uint8_t> data(static_cast<size_t>(GetTileBytes(layout_, level)));
+    const RgbaPixel* src = tile.Data();
+    if (layout_.channels == 4) {
+        memcpy(data.data(), src, data.size());
+    } else {
+        const size_t pixels_count = static_cast<size_t>(side) * side;
+        for (size_t i = 0; i < pixels_count; ++i) {
+            data[i * 3] =     src[i].red;
+            data[i * 3 + 1] = src[i].green;
+            data[i * 3 + 2] = src[i].blue;
+        }
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return false;
+    }
+    file_.seekp(offsets_[idx]);
+    file_.write(reinterpret_cast<const char*>(data.data()), data.size());
+    written_[idx] = file_.good();
+    return written_[idx];
+}
+
+bool AtlasWriter::Close() {
+    lock_guard<mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return false;
+    }
+    const size_t count = offsets_.size();
+    vector<uint8_t> table(count * TextureAtlas::kEntrySize, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (!written_[i]) {
+            continue;
+        }
+        const int level = static_cast<int>(i % layout_.levels);
+        uint8_t* entry = table.data() + i * TextureAtlas::kEntrySize;
+        PutU64(entry,     offsets_[i]);
+        PutU64(entry + 8, GetTileBytes(layout_, level));
+    }
+    file_.seekp(TextureAtlas::kHeaderSize);
+    file_.write(reinterpret_cast<const char*>(table.data()), table.size());
+    const bool is_written = file_.good();
+    file_.close();
+    offsets_.clear();
+    written_.clear();
+    return is_written && !file_.fail();
+}
+
+
+bool AtlasReader::Open(const string& filename) {
+    Close();
+    if (!file_.Open(filename) || file_.Size() < TextureAtlas::kHeaderSize) {
+        Close();
+        return false;
+    }
+    const uint8_t* data = file_.Data();
+    const uint64_t size = file_.Size();
+    AtlasLayout layout;
+    layout.count_x =   static_cast<int>(GetU32(data + 8));
+    layout.count_y =   static_cast<int>(GetU32(data + 12));
+    layout.tile_size = static_cast<int>(GetU32(data + 16));
+    layout.levels =    static_cast<int>(GetU32(data + 20));
+    layout.layers =    static_cast<int>(GetU32(data + 24));
+    layout.channels =  static_cast<int>(GetU32(data + 28));
+    if (memcmp(data, kSignature, sizeof(kSignature)) ||
+            GetU32(data + 4) != TextureAtlas::kVersion ||
+            !IsCorrect(layout)) {
+        Close();
+        return false;
+    }
+
+    // Entries count is checked before every multiplication, so it can't
+    // overflow even for broken header.
+    const uint64_t max_count = (size - TextureAtlas::kHeaderSize) /
+                               TextureAtlas::kEntrySize;
+    const int factors[] = {
+        layout.layers, layout.count_y, layout.count_x, layout.levels
+    };
+    uint64_t count = 1;
+    for (const int factor : factors) {
+        if (count > max_count / factor) {
+            Close();
+            return false;
+        }
+        count *= factor;
+    }
+
+    const uint64_t table_end = TextureAtlas::kHeaderSize +
+                               count * TextureAtlas::kEntrySize;
+    offsets_.resize(static_cast<size_t>(count));
+    for (size_t i = 0; i < offsets_.size(); ++i) {
+        const uint8_t* entry = data + TextureAtlas::kHeaderSize +
+                               i * TextureAtlas::kEntrySize;
+        const uint64_t offset = GetU64(entry);
+        const uint64_t tile_size = GetU64(entry + 8);
+        offsets_[i] = offset;
+        if (!offset && !tile_size) {
+            continue;
+        }
+        const int level = static_cast<int>(i % layout.levels);
+        if (tile_size != GetTileBytes(layout, level) || offset < table_end ||
+                offset > size || tile_size > size - offset) {
+            Close();
+            return false;
+        }
+    }
+    layout_ = layout;
+    return true;
+}
+
+void AtlasReader::Close() {
+    file_.Close();
+    layout_ = AtlasLayout();
+    offsets_.clear();
+}
+
+const AtlasLayout& AtlasReader::Layout() const {
+    return layout_;
+}
+
+const uint8_t* AtlasReader::TileData(int layer, int x, int y,
+        int level) const {
+    const int64_t idx = TextureAtlas::GetEntryIndex(layout_, layer, x, y,
+                                                    level);
+    if (idx < 0 || !offsets_[idx]) {
+        return nullptr;
+    }
+    return file_.Data() + offsets_[idx];
+}
+
+bool AtlasReader::ReadTile(int layer, int x, int y, int level,
+        Image& tile) const {
+    const uint8_t* src = TileData(layer, x, y, level);
+    if (!src) {
+        return false;
+    }
+    const int side = TextureAtlas::GetLevelSize(layout_, level);
+    tile.Resize(side, side);
+    RgbaPixel* dst = tile.Data();
+    const size_t pixels_count = static_cast<size_t>(side) * side;
+    if (layout_.channels == 4) {
+        memcpy(dst, src, pixels_count * sizeof(RgbaPixel));
+        return true;
+    }
+    for (size_t i = 0; i < pixels_count; ++i) {
+        dst[i] = RgbaPixel(src[i * 3], src[i * 3 + 1], src[i * 3 + 2], 255);
+    }
+    return true;
+}
+
+} // namespace utils
+} // namespace prowogene
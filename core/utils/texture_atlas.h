@@ -0,0 +1,172 @@
+#ifndef PROWOGENE_CORE_UTILS_TEXTURE_ATLAS_H_
+#define PROWOGENE_CORE_UTILS_TEXTURE_ATLAS_H_
+
+#include <stdint.h>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/image.h"
+#include "utils/mapped_file.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Grid of equally sized tiles stored in texture atlas. */
+struct AtlasLayout {
+    /** Tiles count per X coord. */
+    int count_x = 0;
+    /** Tiles count per Y coord. */
+    int count_y = 0;
+    /** Width and height of level 0 tile in pixels. */
+    int tile_size = 0;
+    /** Count of mip levels including level 0. Each next level is twice
+    smaller, but not less than 1 pixel. */
+    int levels = 1;
+    /** Count of layers, for example texture and normal map. */
+    int layers = 1;
+    /** Bytes per pixel, 3 for RGB or 4 for RGBA. */
+    int channels = 3;
+};
+
+
+/** @brief Single file container for tiles of all chunks.
+
+All numbers are little-endian. File starts with 32 bytes header:
+@c "PWTA" signature and 32bit unsigned version, count_x, count_y,
+tile_size, levels, layers and channels of AtlasLayout. Header is followed
+by offset table with pair of 64bit unsigned offset and size for every
+tile. Entry of tile is at index
+@c ((layer * count_y + y) * count_x + x) * levels + level , so all levels
+of one tile are neighbours. Absent tiles have zero offset and size. Tile
+data is raw pixel rows from top to bottom, every tile begins at offset
+aligned by 16 bytes, so file can be memory-mapped and tiles used in place. */
+class TextureAtlas {
+ public:
+    /** Filename extension of atlas. */
+    static const char kExtension[];
+    /** Version of atlas format. */
+    static const uint32_t kVersion = 1;
+    /** Size of atlas header in bytes. */
+    static const size_t kHeaderSize = 32;
+    /** Size of offset table entry in bytes. */
+    static const size_t kEntrySize = 16;
+    /** Alignment of tile data in bytes. */
+    static const size_t kTileAlignment = 16;
+
+    /** Get size of tile for mip level.
+    @param [in] layout - Atlas layout.
+    @param [in] level  - Mip level.
+    @return Width and height of tile in pixels. */
+    static int GetLevelSize(const AtlasLayout& layout, int level);
+
+    /** Get index of tile entry in offset table.
+    @param [in] layout - Atlas layout.
+    @param [in] layer  - Layer of tile.
+    @param [in] x      - X index of tile.
+    @param [in] y      - Y index of tile.
+    @param [in] level  - Mip level.
+    @return Index of entry, @c -1 if tile is out of layout. */
+    static int64_t GetEntryIndex(const AtlasLayout& layout,
+                                 int layer, int x, int y, int level);
+};
+
+
+/** @brief Texture atlas writer.
+
+Place of every tile is known when atlas is opened, so tiles can be written
+in any order from several threads at the same time. Offset table is
+written on close and contains only written tiles. */
+class AtlasWriter {
+ public:
+    /** Constructor. */
+    AtlasWriter() = default;
+
+    /** Destructor. Closes atlas. */
+    ~AtlasWriter();
+
+    AtlasWriter(const AtlasWriter&) = delete;
+    AtlasWriter& operator=(const AtlasWriter&) = delete;
+
+    /** Create atlas file. Previously opened atlas is closed.
+    @param [in] filename - Filename of atlas with extension.
+    @param [in] layout   - Atlas layout.
+    @return @c true if file is created, @c false otherwise. */
+    bool Open(const std::string& filename, const AtlasLayout& layout);
+
+    /** Write tile. Thread-safe.
+    @param [in] tile  - Tile image, its size must match the level.
+    @param [in] layer - Layer of tile.
+    @param [in] x     - X index of tile.
+    @param [in] y     - Y index of tile.
+    @param [in] level - Mip level.
+    @return @c true if tile is written, @c false otherwise. */
+    bool Write(const Image& tile, int layer, int x, int y, int level);
+
+    /** Write offset table and close file.
+    @return @c true if all written data is stored, @c false if writing is
+            failed or atlas isn't opened. */
+    bool Close();
+
+ protected:
+    /** Atlas file. */
+    std::ofstream         file_;
+    /** Atlas layout. */
+    AtlasLayout           layout_;
+    /** Offsets of tile data for all table entries. */
+    std::vector<uint64_t> offsets_;
+    /** Written flags for all table entries. */
+    std::vector<bool>     written_;
+    /** Guard for file and written flags. */
+    std::mutex            mutex_;
+};
+
+
+/** @brief Texture atlas reader. Atlas is memory-mapped, so only pages of
+used tiles are loaded. */
+class AtlasReader {
+ public:
+    /** Open atlas and validate header and offset table.
+    @param [in] filename - Filename of atlas with extension.
+    @return @c true if atlas is opened and valid, @c false otherwise. */
+    bool Open(const std::string& filename);
+
+    /** Close atlas. */
+    void Close();
+
+    /** Get atlas layout.
+    @return Layout. */
+    const AtlasLayout& Layout() const;
+
+    /** Get raw pixels of tile.
+    @param [in] layer - Layer of tile.
+    @param [in] x     - X index of tile.
+    @param [in] y     - Y index of tile.
+    @param [in] level - Mip level.
+    @return Pointer to the first pixel, @c nullptr if tile is absent. */
+    const uint8_t* TileData(int layer, int x, int y, int level) const;
+
+    /** Copy tile to image.
+    @param [in] layer - Layer of tile.
+    @param [in] x     - X index of tile.
+    @param [in] y     - Y index of tile.
+    @param [in] level - Mip level.
+    @param [out] tile - Tile image.
+    @return @c true if tile is read, @c false if it's absent. */
+    bool ReadTile(int layer, int x, int y, int level, Image& tile) const;
+
+ protected:
+    /** Mapped atlas file. */
+    MappedFile            file_;
+    /** Atlas layout. */
+    AtlasLayout           layout_;
+    /** Offsets of tile data for all table entries, zero for absent. */
+    std::vector<uint64_t> offsets_;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_TEXTURE_ATLAS_H_
@@ -0,0 +1,233 @@
+#include "texture_cache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <fstream>
+#include <new>
+
+#include "utils/mapped_file.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace prowogene {
+namespace utils {
+
+using std::ifstream;
+using std::ofstream;
+using std::string;
+using std::vector;
+
+static const char     kMagic[4] = { 'P', 'W', 'T', 'C' };
+static const uint32_t kVersion = 1;
+static const string   kExtension = ".pwtc";
+static const int      kReadBlockSize = 1 << 16;
+static const uint64_t kFnvPrime = 1099511628211ULL;
+
+template <typename Type>
+static bool ReadValue(const MappedFile& file, size_t& pos, Type& value) {
+    if (file.Size() - pos < sizeof(value)) {
+        return false;
+    }
+    memcpy(&value, file.Data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
+
+// Create single directory, its parent must exist.
+static bool MakeSingleDirectory(const string& path) {
+#ifdef _WIN32
+    const int result = _mkdir(path.c_str());
+#else
+    const int result = mkdir(path.c_str(), 0777);
+#endif
+    return !result || errno == EEXIST;
+}
+
+template <typename Type>
+static void WriteValue(ofstream& file, Type value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Size of array is checked against the rest of file before allocation, so
+// broken entry can't request arbitrary memory.
+template <typename Type>
+static bool ReadArray(const MappedFile& file, size_t& pos,
+                      Array2D<Type>& arr) {
+    int32_t width = 0;
+    int32_t height = 0;
+    if (!ReadValue(file, pos, width) || !ReadValue(file, pos, height) ||
+            width < 0 || height < 0) {
+        return false;
+    }
+    const uint64_t size = static_cast<uint64_t>(width) * height *
+                          sizeof(Type);
+    if (size > file.Size() - pos) {
+        return false;
+    }
+    arr.Resize(width, height);
+    if (size) {
+        memcpy(reinterpret_cast<uint8_t*>(arr.Data()), file.Data() + pos,
+               static_cast<size_t>(size));
+    }
+    pos += static_cast<size_t>(size);
+    return true;
+}
+
+template <typename Type>
+static void WriteArray(ofstream& file, const Array2D<Type>& arr) {
+    WriteValue<int32_t>(file, arr.Width());
+    WriteValue<int32_t>(file, arr.Height());
+    const size_t size = arr.Size() * sizeof(Type);
+    file.write(reinterpret_cast<const char*>(arr.Data()), size);
+}
+
+
+TextureCache::TextureCache(const string& directory) {
+    directory_ = directory;
+    if (!directory_.empty() && directory_.back() != '/' &&
+            directory_.back() != '\\') {
+        directory_ += '/';
+    }
+}
+
+bool TextureCache::MakeDirectory() const {
+    // Directory always ends with separator, every separator ends one level.
+    for (size_t pos = 1; pos < directory_.size(); ++pos) {
+        if ((directory_[pos] == '/' || directory_[pos] == '\\') &&
+                directory_[pos - 1] != ':' &&
+                !MakeSingleDirectory(directory_.substr(0, pos))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextureCache::GetKey(const vector<string>& files, const string& params,
+        string& key) const {
+    uint64_t hash = Hash(&kVersion, sizeof(kVersion));
+    hash = Hash(params.data(), params.size(), hash);
+    vector<char> block(kReadBlockSize);
+    for (const auto& filename : files) {
+        ifstream file(filename, ifstream::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        uint64_t file_size = 0;
+        while (file) {
+            file.read(block.data(), block.size());
+            const size_t count = static_cast<size_t>(file.gcount());
+            hash = Hash(block.data(), count, hash);
+            file_size += count;
+        }
+        // Size separates contents of neighbour files.
+        hash = Hash(&file_size, sizeof(file_size), hash);
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx",
+             static_cast<unsigned long long>(hash));
+    key = hex;
+    return true;
+}
+
+bool TextureCache::Load(const string& key, Image& texture,
+        vector<Image>& decals, Array2D<float>& heights) const {
+    MappedFile file;
+    if (!file.Open(GetPath(key)) || file.Size() < sizeof(kMagic)) {
+        return false;
+    }
+
+    size_t pos = sizeof(kMagic);
+    uint32_t version = 0;
+    uint32_t images_count = 0;
+    if (memcmp(file.Data(), kMagic, sizeof(kMagic)) ||
+            !ReadValue(file, pos, version) || version != kVersion ||
+            !ReadValue(file, pos, images_count) || !images_count) {
+        return false;
+    }
+    // Every image takes at least its width and height.
+    const size_t kMinImageSize = 2 * sizeof(int32_t);
+    if (images_count > (file.Size() - pos) / kMinImageSize) {
+        return false;
+    }
+
+    // Broken or too big entry is a miss, it's prepared again by caller.
+    Image loaded_texture;
+    vector<Image> loaded_decals;
+    Array2D<float> loaded_heights;
+    try {
+        if (!ReadArray(file, pos, loaded_texture)) {
+            return false;
+        }
+        loaded_decals.resize(images_count - 1);
+        for (auto& decal : loaded_decals) {
+            if (!ReadArray(file, pos, decal)) {
+                return false;
+            }
+        }
+        if (!ReadArray(file, pos, loaded_heights)) {
+            return false;
+        }
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    texture = std::move(loaded_texture);
+    decals = std::move(loaded_decals);
+    heights = std::move(loaded_heights);
+    return true;
+}
+
+void TextureCache::Store(const string& key, const Image& texture,
+        const vector<Image>& decals, const Array2D<float>& heights) const {
+    // Entry is written to unique temporary file and renamed after that, so
+    // parallel runs never read partially written entry.
+    const string path = GetPath(key);
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch();
+    const string tmp_path = path + "." + std::to_string(stamp.count()) +
+        "." + std::to_string(reinterpret_cast<uintptr_t>(this)) + ".tmp";
+    {
+        ofstream file(tmp_path, ofstream::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        file.write(kMagic, sizeof(kMagic));
+        WriteValue<uint32_t>(file, kVersion);
+        WriteValue<uint32_t>(file, static_cast<uint32_t>(decals.size() + 1));
+        WriteArray(file, texture);
+        for (const auto& decal : decals) {
+            WriteArray(file, decal);
+        }
+        WriteArray(file, heights);
+        if (!file.good()) {
+            file.close();
+            remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_path.c_str(), path.c_str())) {
+        remove(tmp_path.c_str());
+    }
+}
+
+uint64_t TextureCache::Hash(const void* data, size_t size, uint64_t hash) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+string TextureCache::GetPath(const string& key) const {
+    return directory_ + key + kExtension;
+}
+
+} // namespace utils
+} // namespace prowogene
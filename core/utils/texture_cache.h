@@ -0,0 +1,97 @@
+#ifndef PROWOGENE_CORE_UTILS_TEXTURE_CACHE_H_
+#define PROWOGENE_CORE_UTILS_TEXTURE_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "utils/array2d.h"
+#include "utils/image.h"
+
+namespace prowogene {
+namespace utils {
+
+/** @brief On-disk cache of preprocessed reference textures.
+
+Every entry keeps decoded and resized texture, it's decals and height array
+computed from texture. Entry is identified by hash of source files content
+and processing params, so changed source file or params never hit stale
+entry.
+
+Entry file layout (all values are in native byte order, every block is 4 byte
+aligned, so file can be mapped to memory and used without decoding):
+@code
+char[4]  magic "PWTC"
+uint32   format version
+uint32   images count (texture and it's decals)
+images count times:
+    int32 width, int32 height, width * height RGBA8 pixels (row by row)
+int32 width, int32 height, width * height float heights (row by row)
+@endcode */
+class TextureCache {
+ public:
+    /** Constructor.
+    @param [in] directory - Directory where entries are stored. Empty
+                            string means current directory. */
+    explicit TextureCache(const std::string& directory);
+
+    /** Create entries directory with all missing parents.
+    @return @c true if directory exists, @c false otherwise. */
+    bool MakeDirectory() const;
+
+    /** Get entry key for set of source files.
+    @param [in] files  - Source files of entry.
+    @param [in] params - Processing params that affect entry content.
+    @param [out] key   - Entry key.
+    @return @c true when all files are read, @c false otherwise. */
+    bool GetKey(const std::vector<std::string>& files,
+                const std::string& params,
+                std::string& key) const;
+
+    /** Load entry from cache. Entry is read through memory-mapped file,
+    outputs aren't changed on failure.
+    @param [in] key      - Entry key.
+    @param [out] texture - Preprocessed texture.
+    @param [out] decals  - Preprocessed decals.
+    @param [out] heights - Texture heights.
+    @return @c true when entry exists and is correct, @c false otherwise. */
+    bool Load(const std::string& key,
+              Image& texture,
+              std::vector<Image>& decals,
+              Array2D<float>& heights) const;
+
+    /** Save entry to cache. Failed writing is ignored, because it only
+    means that entry will be prepared again next time.
+    @param [in] key     - Entry key.
+    @param [in] texture - Preprocessed texture.
+    @param [in] decals  - Preprocessed decals.
+    @param [in] heights - Texture heights. */
+    void Store(const std::string& key,
+               const Image& texture,
+               const std::vector<Image>& decals,
+               const Array2D<float>& heights) const;
+
+    /** Get 64bit FNV-1a hash of data.
+    @param [in] data - Data to hash.
+    @param [in] size - Data size in bytes.
+    @param [in] hash - Hash of previous data when hashing by parts.
+    @return Hash value. */
+    static uint64_t Hash(const void* data, size_t size,
+                         uint64_t hash = 14695981039346656037ULL);
+
+ protected:
+    /** Get entry filename.
+    @param [in] key - Entry key.
+    @return Path to entry file. */
+    std::string GetPath(const std::string& key) const;
+
+
+    /** Entries directory. */
+    std::string directory_;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_TEXTURE_CACHE_H_
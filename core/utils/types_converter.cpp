@@ -24,6 +24,22 @@ static const string kKeyPointDefault = "default";
 static const string kKeyPointMax =     "maximal";
 static const string kKeyPointMin =     "minimal";
 
+static const string kLocationMapFormatRgb =     "rgb";
+static const string kLocationMapFormatIndexed = "indexed";
+static const string kLocationMapFormatRle =     "rle";
+
+static const string kMeshTopologyTriangles = "triangles";
+static const string kMeshTopologyStrip =     "triangle_strip";
+
+static const string kMipFilterBox =    "box";
+static const string kMipFilterKaiser = "kaiser";
+
+static const string kNormalSourceTexture =   "texture";
+static const string kNormalSourceHeightMap = "height_map";
+
+static const string kShadowMethodSimple =    "simple";
+static const string kShadowMethodHillshade = "hillshade";
+
 static const string kSurfaceDiamondSquare =  "diamond_square";
 static const string kSurfaceFlat =           "flat";
 static const string kSurfaceRadialGradient = "radial_gradient";
@@ -53,6 +69,32 @@ static const map<KeyPoint, string> kKeyPointString = {
     { KeyPoint::Default, kKeyPointDefault }
 };
 
+static const map<LocationMapFormat, string> kLocationMapFormatString = {
+    { LocationMapFormat::Rgb,     kLocationMapFormatRgb },
+    { LocationMapFormat::Indexed, kLocationMapFormatIndexed },
+    { LocationMapFormat::Rle,     kLocationMapFormatRle }
+};
+
+static const map<MeshTopology, string> kMeshTopologyString = {
+    { MeshTopology::Triangles,     kMeshTopologyTriangles },
+    { MeshTopology::TriangleStrip, kMeshTopologyStrip }
+};
+
+static const map<MipFilter, string> kMipFilterString = {
+    { MipFilter::Box,    kMipFilterBox },
+    { MipFilter::Kaiser, kMipFilterKaiser }
+};
+
+static const map<NormalSource, string> kNormalSourceString = {
+    { NormalSource::Texture,   kNormalSourceTexture },
+    { NormalSource::HeightMap, kNormalSourceHeightMap }
+};
+
+static const map<ShadowMethod, string> kShadowMethodString = {
+    { ShadowMethod::Simple,    kShadowMethodSimple },
+    { ShadowMethod::Hillshade, kShadowMethodHillshade }
+};
+
 static const map<Surface, string> kSurfaceString = {
     { Surface::DiamondSquare,  kSurfaceDiamondSquare },
     { Surface::Flat,           kSurfaceFlat },
@@ -111,6 +153,56 @@ KeyPoint TypesConverter::To<KeyPoint>(const string &str) {
     return KeyPoint::Default;
 }
 
+template <>
+LocationMapFormat TypesConverter::To<LocationMapFormat>(const string& str) {
+    for (const auto& elem : kLocationMapFormatString) {
+        if (elem.second == str) {
+            return elem.first;
+        }
+    }
+    return LocationMapFormat::Rgb;
+}
+
+template <>
+MeshTopology TypesConverter::To<MeshTopology>(const string& str) {
+    for (const auto& elem : kMeshTopologyString) {
+        if (elem.second == str) {
+            return elem.first;
+        }
+    }
+    return MeshTopology::Triangles;
+}
+
+template <>
+MipFilter TypesConverter::To<MipFilter>(const string& str) {
+    for (const auto& elem : kMipFilterString) {
+        if (elem.second == str) {
+            return elem.first;
+        }
+    }
+    return MipFilter::Box;
+}
+
+template <>
+NormalSource TypesConverter::To<NormalSource>(const string& str) {
+    for (const auto& elem : kNormalSourceString) {
+        if (elem.second == str) {
+            return elem.first;
+        }
+    }
+    return NormalSource::Texture;
+}
+
+template <>
+ShadowMethod TypesConverter::To<ShadowMethod>(const string& str) {
+    for (const auto& elem : kShadowMethodString) {
+        if (elem.second == str) {
+            return elem.first;
+        }
+    }
+    return ShadowMethod::Simple;
+}
+
 template <>
 Surface TypesConverter::To<Surface>(const string& str) {
     for (const auto& elem : kSurfaceString) {
@@ -161,6 +253,56 @@ string TypesConverter::ToString(KeyPoint val) {
     }
 }
 
+template <>
+string TypesConverter::ToString(LocationMapFormat val) {
+    auto str = kLocationMapFormatString.find(val);
+    if (str != kLocationMapFormatString.end()) {
+        return str->second;
+    } else {
+        return "";
+    }
+}
+
+template <>
+string TypesConverter::ToString(MeshTopology val) {
+    auto str = kMeshTopologyString.find(val);
+    if (str != kMeshTopologyString.end()) {
+        return str->second;
+    } else {
+        return "";
+    }
+}
+
+template <>
+string TypesConverter::ToString(MipFilter val) {
+    auto str = kMipFilterString.find(val);
+    if (str != kMipFilterString.end()) {
+        return str->second;
+    } else {
+        return "";
+    }
+}
+
+template <>
+string TypesConverter::ToString(NormalSource val) {
+    auto str = kNormalSourceString.find(val);
+    if (str != kNormalSourceString.end()) {
+        return str->second;
+    } else {
+        return "";
+    }
+}
+
+template <>
+string TypesConverter::ToString(ShadowMethod val) {
+    auto str = kShadowMethodString.find(val);
+    if (str != kShadowMethodString.end()) {
+        return str->second;
+    } else {
+        return "";
+    }
+}
+
 template <>
 string TypesConverter::ToString(Surface val) {
     auto str = kSurfaceString.find(val);
@@ -0,0 +1,102 @@
+#include "write_queue.h"
+
+namespace prowogene {
+namespace utils {
+
+using std::mutex;
+using std::thread;
+using std::unique_lock;
+
+WriteQueue::WriteQueue(int thread_count, int capacity, size_t byte_budget) {
+    capacity_ = capacity > 0 ? static_cast<size_t>(capacity) : 1;
+    byte_budget_ = byte_budget;
+    for (int i = 0; i < thread_count; ++i) {
+        threads_.push_back(thread(&WriteQueue::Run, this));
+    }
+}
+
+WriteQueue::~WriteQueue() {
+    {
+        unique_lock<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    task_added_.notify_all();
+    for (auto& th : threads_) {
+        if (th.joinable()) {
+            th.join();
+        }
+    }
+}
+
+void WriteQueue::Push(Task task, size_t bytes) {
+    if (threads_.empty()) {
+        task();
+        return;
+    }
+    {
+        unique_lock<mutex> lock(mutex_);
+        task_taken_.wait(lock, [this, bytes] {
+            const bool fits = !byte_budget_ || !bytes_in_flight_ ||
+                              bytes_in_flight_ + bytes <= byte_budget_;
+            return tasks_.size() < capacity_ && fits;
+        });
+        bytes_in_flight_ += bytes;
+        tasks_.emplace_back(std::move(task), bytes);
+    }
+    task_added_.notify_one();
+}
+
+void WriteQueue::Flush() {
+    unique_lock<mutex> lock(mutex_);
+    task_taken_.wait(lock, [this] {
+        return tasks_.empty() && !in_progress_;
+    });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void WriteQueue::Run() {
+    while (true) {
+        Task task;
+        size_t bytes = 0;
+        {
+            unique_lock<mutex> lock(mutex_);
+            task_added_.wait(lock, [this] {
+                return stop_ || !tasks_.empty();
+            });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front().first);
+            bytes = tasks_.front().second;
+            tasks_.pop_front();
+            ++in_progress_;
+        }
+        task_taken_.notify_all();
+
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // Data owned by task is released here, not when it's taken.
+        task = nullptr;
+        {
+            unique_lock<mutex> lock(mutex_);
+            --in_progress_;
+            bytes_in_flight_ -= bytes;
+            if (error && !error_) {
+                error_ = error;
+            }
+        }
+        task_taken_.notify_all();
+    }
+}
+
+} // namespace utils
+} // namespace prowogene
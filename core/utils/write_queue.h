@@ -0,0 +1,87 @@
+#ifndef PROWOGENE_CORE_UTILS_WRITE_QUEUE_H_
+#define PROWOGENE_CORE_UTILS_WRITE_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace prowogene {
+namespace utils {
+
+/** @brief Bounded queue of output tasks processed by dedicated I/O threads.
+
+Every task must own all data it needs (for example, image moved inside
+@c std::shared_ptr ), so computing threads can continue their work while
+files are encoded and written. When queue is full or size of data owned by
+queued and running tasks exceeds byte budget, producers are blocked until
+I/O threads take or complete some tasks (backpressure). */
+class WriteQueue {
+ public:
+    /** Output task. */
+    using Task = std::function<void()>;
+
+    /** Constructor.
+    @param [in] thread_count - Count of I/O threads. When it is less than 1,
+                               tasks are executed inside Push call.
+    @param [in] capacity     - Maximal count of tasks waiting for I/O
+                               threads. [1, ...).
+    @param [in] byte_budget  - Maximal size of data owned by queued and
+                               running tasks in bytes. Task bigger than
+                               budget is accepted when queue is empty.
+                               0 means no limit. */
+    WriteQueue(int thread_count, int capacity, size_t byte_budget = 0);
+
+    /** Destructor. Waits for all queued tasks. */
+    ~WriteQueue();
+
+    WriteQueue(const WriteQueue&) = delete;
+    WriteQueue& operator=(const WriteQueue&) = delete;
+
+    /** Add task to the end of queue. Blocks caller while queue is full or
+    byte budget is exceeded.
+    @param [in] task  - Task to execute.
+    @param [in] bytes - Size of data owned by task. */
+    void Push(Task task, size_t bytes = 0);
+
+    /** Wait until all queued tasks are completed. If some task has thrown
+    an exception, first of them is rethrown here. */
+    void Flush();
+
+ protected:
+    /** I/O thread main loop. */
+    void Run();
+
+
+    /** Tasks waiting for execution with sizes of their data. */
+    std::deque<std::pair<Task, size_t> > tasks_;
+    /** Maximal size of tasks_. */
+    size_t                   capacity_ = 1;
+    /** Maximal size of data owned by queued and running tasks. */
+    size_t                   byte_budget_ = 0;
+    /** Size of data owned by queued and running tasks. */
+    size_t                   bytes_in_flight_ = 0;
+    /** Count of tasks that are executing now. */
+    int                      in_progress_ = 0;
+    /** Stop flag for I/O threads. */
+    bool                     stop_ = false;
+    /** First exception thrown by task. */
+    std::exception_ptr       error_;
+    /** Guard for all queue state. */
+    std::mutex               mutex_;
+    /** Signaled when task is added or queue is stopping. */
+    std::condition_variable  task_added_;
+    /** Signaled when task is taken or completed. */
+    std::condition_variable  task_taken_;
+    /** I/O threads. */
+    std::vector<std::thread> threads_;
+};
+
+} // namespace utils
+} // namespace prowogene
+
+#endif // PROWOGENE_CORE_UTILS_WRITE_QUEUE_H_
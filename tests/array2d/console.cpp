@@ -10,6 +10,8 @@ using std::cout;
 using std::endl;
 using std::string;
 using prowogene::utils::Array2D;
+using prowogene::utils::MappedBuffer;
+using prowogene::utils::MappedBufferParams;
 
 bool Array2DConstructor() {
     Array2D<int> t;
@@ -78,12 +80,44 @@ bool Array2DIndexes() {
     return true;
 }
 
+bool Array2DMapped() {
+    MappedBufferParams params;
+    params.threshold = 1024;
+    MappedBuffer::SetParams(params);
+    Array2D<float> small(8, 8, 1.0f);
+    Array2D<float> t(300, 200, 2.5f);
+    Array2D<float> zeros(300, 200);
+    MappedBuffer::SetParams(MappedBufferParams());
+    if (small.IsMapped() || !t.IsMapped() || !zeros.IsMapped()) {
+        return false;
+    }
+    if (t.Size() != 300 * 200 || t(299, 199) != 2.5f || zeros(7, 5)) {
+        return false;
+    }
+    t(10, 20) = 4.0f;
+
+    params.threshold = 1024;
+    MappedBuffer::SetParams(params);
+    const Array2D<float> copy(t);
+    MappedBuffer::SetParams(MappedBufferParams());
+    Array2D<float> moved(std::move(t));
+    if (!copy.IsMapped() || copy(10, 20) != 4.0f || copy(0, 0) != 2.5f ||
+            !moved.IsMapped() || moved(10, 20) != 4.0f || t.Size()) {
+        return false;
+    }
+    const Array2D<float> heap_copy(copy);
+    moved.Clear();
+    return !heap_copy.IsMapped() && heap_copy(10, 20) == 4.0f &&
+           !moved.IsMapped() && !moved.Size();
+}
+
 typedef bool (*TestFuncPtr)();
 const std::map<string, TestFuncPtr> kTests = {
     {"array2d-constructor", Array2DConstructor},
     {"array2d-resize", Array2DResize},
     {"array2d-iterator", Array2DIterator},
-    {"array2d-indexes", Array2DIndexes}
+    {"array2d-indexes", Array2DIndexes},
+    {"array2d-mapped", Array2DMapped}
 };
 
 int main(int argc, const char **argv) {
@@ -0,0 +1,746 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "utils/deflate.h"
+#include "utils/png.h"
+#include "utils/random.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using prowogene::utils::Deflate;
+using prowogene::utils::Image;
+using prowogene::utils::Png;
+using prowogene::utils::Random;
+using prowogene::utils::RgbaPixel;
+
+// Minimal zlib decoder (RFC 1950, RFC 1951) that is independent of encoder
+// code, so output is checked by specification instead of by itself.
+static const int kMaxBits = 15;
+static const int kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const int kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const int kDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static const int kDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const int kCodeLenOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+enum BlockType {
+    kStored = 0,
+    kFixed = 1,
+    kDynamic = 2
+};
+
+struct Huffman {
+    vector<int> count;
+    vector<int> symbol;
+};
+
+class BitReader {
+ public:
+    BitReader(const vector<uint8_t>& data) : data_(data) { }
+
+    bool Bits(int need, int& value) {
+        while (count_ < need) {
+            if (pos_ >= data_.size()) {
+                return false;
+            }
+            buffer_ |= static_cast<uint32_t>(data_[pos_++]) << count_;
+            count_ += 8;
+        }
+        value = static_cast<int>(buffer_ & ((1u << need) - 1));
+        buffer_ >>= need;
+        count_ -= need;
+        return true;
+    }
+
+    void AlignToByte() {
+        buffer_ = 0;
+        count_ = 0;
+    }
+
+ protected:
+    const vector<uint8_t>& data_;
+    size_t                 pos_ = 0;
+    uint32_t               buffer_ = 0;
+    int                    count_ = 0;
+};
+
+static bool BuildHuffman(const int* lengths, int n, Huffman& h) {
+    h.count.assign(kMaxBits + 1, 0);
+    h.symbol.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        ++h.count[lengths[i]];
+    }
+    int left = 1;
+    for (int len = 1; len <= kMaxBits; ++len) {
+        left = (left << 1) - h.count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+    int offsets[kMaxBits + 1] = {0};
+    for (int len = 1; len < kMaxBits; ++len) {
+        offsets[len + 1] = offsets[len] + h.count[len];
+    }
+    for (int i = 0; i < n; ++i) {
+        if (lengths[i]) {
+            h.symbol[offsets[lengths[i]]++] = i;
+        }
+    }
+    return true;
+}
+
+static int DecodeSymbol(BitReader& reader, const Huffman& h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= kMaxBits; ++len) {
+        int bit = 0;
+        if (!reader.Bits(1, bit)) {
+            return -1;
+        }
+        code |= bit;
+        const int count = h.count[len];
+        if (code - first < count) {
+            return h.symbol[index + code - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static bool InflateCodes(BitReader& reader, const Huffman& lit,
+                         const Huffman& dist, vector<uint8_t>& out) {
+    while (true) {
+        const int symbol = DecodeSymbol(reader, lit);
+        if (symbol < 0 || symbol > 285) {
+            return false;
+        }
+        if (symbol < 256) {
+            out.push_back(static_cast<uint8_t>(symbol));
+            continue;
+        }
+        if (symbol == 256) {
+            return true;
+        }
+        int extra = 0;
+        if (!reader.Bits(kLengthExtra[symbol - 257], extra)) {
+            return false;
+        }
+        const int length = kLengthBase[symbol - 257] + extra;
+        const int dist_symbol = DecodeSymbol(reader, dist);
+        if (dist_symbol < 0 || dist_symbol >= 30 ||
+                !reader.Bits(kDistExtra[dist_symbol], extra)) {
+            return false;
+        }
+        const size_t distance = kDistBase[dist_symbol] + extra;
+        if (distance > out.size()) {
+            return false;
+        }
+        for (int i = 0; i < length; ++i) {
+            out.push_back(out[out.size() - distance]);
+        }
+    }
+}
+
+static bool InflateDynamic(BitReader& reader, vector<uint8_t>& out) {
+    int hlit = 0;
+    int hdist = 0;
+    int hclen = 0;
+    if (!reader.Bits(5, hlit) || !reader.Bits(5, hdist) ||
+            !reader.Bits(4, hclen)) {
+        return false;
+    }
+    hlit += 257;
+    hdist += 1;
+    hclen += 4;
+
+    int lengths[320] = {0};
+    for (int i = 0; i < hclen; ++i) {
+        if (!reader.Bits(3, lengths[kCodeLenOrder[i]])) {
+            return false;
+        }
+    }
+    Huffman code_len;
+    if (!BuildHuffman(lengths, 19, code_len)) {
+        return false;
+    }
+
+    int pos = 0;
+    while (pos < hlit + hdist) {
+        const int symbol = DecodeSymbol(reader, code_len);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[pos++] = symbol;
+            continue;
+        }
+        int repeat = 0;
+        int value = 0;
+        if (symbol == 16) {
+            if (!pos || !reader.Bits(2, repeat)) {
+                return false;
+            }
+            value = lengths[pos - 1];
+            repeat += 3;
+        } else if (symbol == 17) {
+            if (!reader.Bits(3, repeat)) {
+                return false;
+            }
+            repeat += 3;
+        } else {
+            if (!reader.Bits(7, repeat)) {
+                return false;
+            }
+            repeat += 11;
+        }
+        if (pos + repeat > hlit + hdist) {
+            return false;
+        }
+        while (repeat--) {
+            lengths[pos++] = value;
+        }
+    }
+
+    Huffman lit;
+    Huffman dist;
+    if (!BuildHuffman(lengths, hlit, lit) ||
+            !BuildHuffman(lengths + hlit, hdist, dist)) {
+        return false;
+    }
+    return InflateCodes(reader, lit, dist, out);
+}
+
+static bool InflateFixed(BitReader& reader, vector<uint8_t>& out) {
+    int lengths[288];
+    std::fill(lengths, lengths + 144, 8);
+    std::fill(lengths + 144, lengths + 256, 9);
+    std::fill(lengths + 256, lengths + 280, 7);
+    std::fill(lengths + 280, lengths + 288, 8);
+    int dist_lengths[30];
+    std::fill(dist_lengths, dist_lengths + 30, 5);
+    Huffman lit;
+    Huffman dist;
+    BuildHuffman(lengths, 288, lit);
+    BuildHuffman(dist_lengths, 30, dist);
+    return InflateCodes(reader, lit, dist, out);
+}
+
+static bool InflateStored(BitReader& reader, vector<uint8_t>& out) {
+    reader.AlignToByte();
+    int length = 0;
+    int inverted = 0;
+    if (!reader.Bits(16, length) || !reader.Bits(16, inverted) ||
+            (length ^ 0xFFFF) != inverted) {
+        return false;
+    }
+    for (int i = 0; i < length; ++i) {
+        int byte = 0;
+        if (!reader.Bits(8, byte)) {
+            return false;
+        }
+        out.push_back(static_cast<uint8_t>(byte));
+    }
+    return true;
+}
+
+static uint32_t ReferenceAdler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t i = 0; i < size; ++i) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static uint32_t ReferenceCrc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t GetU32BigEndian(const uint8_t* src) {
+    return (static_cast<uint32_t>(src[0]) << 24) |
+           (static_cast<uint32_t>(src[1]) << 16) |
+           (static_cast<uint32_t>(src[2]) << 8) |
+           static_cast<uint32_t>(src[3]);
+}
+
+// Decode zlib stream and check its header and Adler-32 trailer.
+static bool Inflate(const vector<uint8_t>& stream, vector<uint8_t>& out,
+                    vector<int>& block_types) {
+    if (stream.size() < 6 || (stream[0] & 0x0F) != 8 ||
+            ((stream[0] << 8) | stream[1]) % 31 || (stream[1] & 0x20)) {
+        return false;
+    }
+    const vector<uint8_t> body(stream.begin() + 2, stream.end());
+    BitReader reader(body);
+    out.clear();
+    block_types.clear();
+    int is_final = 0;
+    while (!is_final) {
+        int type = 0;
+        if (!reader.Bits(1, is_final) || !reader.Bits(2, type)) {
+            return false;
+        }
+        block_types.push_back(type);
+        bool is_ok = false;
+        if (type == kStored) {
+            is_ok = InflateStored(reader, out);
+        } else if (type == kFixed) {
+            is_ok = InflateFixed(reader, out);
+        } else if (type == kDynamic) {
+            is_ok = InflateDynamic(reader, out);
+        }
+        if (!is_ok) {
+            return false;
+        }
+    }
+    reader.AlignToByte();
+    int bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        if (!reader.Bits(8, bytes[i])) {
+            return false;
+        }
+    }
+    const uint8_t trailer[4] = {
+        static_cast<uint8_t>(bytes[0]), static_cast<uint8_t>(bytes[1]),
+        static_cast<uint8_t>(bytes[2]), static_cast<uint8_t>(bytes[3])
+    };
+    return GetU32BigEndian(trailer) ==
+           ReferenceAdler32(out.data(), out.size());
+}
+
+static vector<uint8_t> CompressWhole(const vector<uint8_t>& data) {
+    vector<uint8_t> stream;
+    Deflate::WriteHeader(stream);
+    Deflate::Compress(data.data(), 0, data.size(), true, stream);
+    Deflate::WriteTrailer(Deflate::Adler32(1, data.data(), data.size()),
+                          stream);
+    return stream;
+}
+
+static bool HasBlockType(const vector<int>& types, int type) {
+    return std::find(types.begin(), types.end(), type) != types.end();
+}
+
+// Compress data as single segment, decode it and check block types.
+static bool CheckRoundTrip(const vector<uint8_t>& data, int expected_type) {
+    vector<uint8_t> decoded;
+    vector<int> types;
+    if (!Inflate(CompressWhole(data), decoded, types)) {
+        cout << "Stream can't be decoded" << endl;
+        return false;
+    }
+    if (decoded != data) {
+        cout << "Decoded data differs" << endl;
+        return false;
+    }
+    if (!HasBlockType(types, expected_type)) {
+        cout << "No block of type " << expected_type << endl;
+        return false;
+    }
+    return true;
+}
+
+// Text of words with skewed letter frequencies.
+static vector<uint8_t> CreateText(size_t size, int seed) {
+    static const char* kWords[] = {
+        "height", "map", "river", "mountain", "sea", "beach", "forest",
+        "the", "a", "of", "and", "is", "texture", "chunk", "zephyr"
+    };
+    const int words_count = sizeof(kWords) / sizeof(kWords[0]);
+    Random rand(seed);
+    vector<uint8_t> text;
+    while (text.size() < size) {
+        const int a = rand.Next(0, words_count - 1);
+        const int b = rand.Next(0, words_count - 1);
+        const string word = kWords[std::min(a, b)];
+        text.insert(text.end(), word.begin(), word.end());
+        text.push_back(rand.Next(0, 7) ? ' ' : '\n');
+    }
+    text.resize(size);
+    return text;
+}
+
+static vector<uint8_t> CreateNoise(size_t size, int seed) {
+    Random rand(seed);
+    vector<uint8_t> noise(size);
+    for (auto& byte : noise) {
+        byte = static_cast<uint8_t>(rand.Next());
+    }
+    return noise;
+}
+
+
+bool DeflateStored() {
+    // Noise can't be compressed, also it's longer than single stored block.
+    return CheckRoundTrip(CreateNoise(150000, 1), kStored);
+}
+
+bool DeflateFixed() {
+    const string text = "prowogene prowogene prowogene";
+    return CheckRoundTrip(vector<uint8_t>(text.begin(), text.end()), kFixed);
+}
+
+bool DeflateDynamic() {
+    return CheckRoundTrip(CreateText(100000, 2), kDynamic);
+}
+
+bool DeflateEmpty() {
+    return CheckRoundTrip(vector<uint8_t>(), kFixed) ||
+           CheckRoundTrip(vector<uint8_t>(), kStored);
+}
+
+bool DeflateSegments() {
+    // Every segment starts with copy of previous data, so it's compressed
+    // well only when back references cross segment joins.
+    const vector<uint8_t> pattern = CreateNoise(3000, 3);
+    vector<uint8_t> data;
+    while (data.size() < 200000) {
+        data.insert(data.end(), pattern.begin(), pattern.end());
+    }
+    const size_t segment_size = 40000;
+
+    vector<uint8_t> stream;
+    Deflate::WriteHeader(stream);
+    for (size_t start = 0; start < data.size(); start += segment_size) {
+        const size_t size = std::min(segment_size, data.size() - start);
+        const size_t before = stream.size();
+        Deflate::Compress(data.data() + start,
+                          std::min(start, Deflate::kWindowSize), size,
+                          start + size == data.size(), stream);
+        if (start && stream.size() - before > size / 20) {
+            cout << "Segment at " << start << " doesn't use history" << endl;
+            return false;
+        }
+    }
+    Deflate::WriteTrailer(Deflate::Adler32(1, data.data(), data.size()),
+                          stream);
+
+    vector<uint8_t> decoded;
+    vector<int> types;
+    if (!Inflate(stream, decoded, types) || decoded != data) {
+        return false;
+    }
+    // Segments except the last one are aligned by empty stored block.
+    return HasBlockType(types, kStored);
+}
+
+bool DeflateAdler() {
+    const string wiki = "Wikipedia";
+    const uint8_t* wiki_data = reinterpret_cast<const uint8_t*>(wiki.data());
+    if (Deflate::Adler32(1, wiki_data, wiki.size()) != 0x11E60398) {
+        return false;
+    }
+    if (Deflate::Adler32(1, nullptr, 0) != 1) {
+        return false;
+    }
+
+    // Sums are reduced by runs, so checksum of long data of maximal bytes
+    // must also match, including split at any position.
+    vector<uint8_t> data(100000, 0xFF);
+    const vector<uint8_t> noise = CreateNoise(50000, 4);
+    data.insert(data.end(), noise.begin(), noise.end());
+    const uint32_t expected = ReferenceAdler32(data.data(), data.size());
+    if (Deflate::Adler32(1, data.data(), data.size()) != expected) {
+        return false;
+    }
+    for (size_t split : { size_t(1), size_t(5552), size_t(77777) }) {
+        uint32_t adler = Deflate::Adler32(1, data.data(), split);
+        adler = Deflate::Adler32(adler, data.data() + split,
+                                 data.size() - split);
+        if (adler != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class PngAccess : public Png {
+ public:
+    using Png::Crc32;
+};
+
+bool PngCrc() {
+    const string check = "123456789";
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(check.data());
+    if (PngAccess::Crc32(0, data, check.size()) != 0xCBF43926) {
+        return false;
+    }
+    const uint8_t iend[4] = { 'I', 'E', 'N', 'D' };
+    if (PngAccess::Crc32(0, iend, sizeof(iend)) != 0xAE426082) {
+        return false;
+    }
+    const vector<uint8_t> noise = CreateNoise(10000, 5);
+    const uint32_t crc = PngAccess::Crc32(
+        PngAccess::Crc32(0, noise.data(), 1234), noise.data() + 1234,
+        noise.size() - 1234);
+    return crc == ReferenceCrc32(noise.data(), noise.size());
+}
+
+static int Paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = abs(p - a);
+    const int pb = abs(p - b);
+    const int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Read PNG file, check chunk CRCs and return unfiltered rows.
+static bool ReadPng(const string& filename, int& width, int& height,
+                    int& bit_depth, int& color_type, vector<uint8_t>& rows) {
+    std::ifstream file(filename, std::ios::binary);
+    const vector<uint8_t> png((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+    const uint8_t kSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    if (png.size() < 8 || !std::equal(kSignature, kSignature + 8,
+                                      png.begin())) {
+        return false;
+    }
+    vector<uint8_t> idat;
+    bool is_ended = false;
+    size_t pos = 8;
+    while (!is_ended) {
+        if (pos + 12 > png.size()) {
+            return false;
+        }
+        const size_t length = GetU32BigEndian(png.data() + pos);
+        if (pos + 12 + length > png.size()) {
+            return false;
+        }
+        const uint8_t* type = png.data() + pos + 4;
+        const uint8_t* data = type + 4;
+        if (GetU32BigEndian(data + length) !=
+                ReferenceCrc32(type, length + 4)) {
+            cout << "Bad chunk CRC" << endl;
+            return false;
+        }
+        const string name(type, type + 4);
+        if (name == "IHDR") {
+            width = static_cast<int>(GetU32BigEndian(data));
+            height = static_cast<int>(GetU32BigEndian(data + 4));
+            bit_depth = data[8];
+            color_type = data[9];
+        } else if (name == "IDAT") {
+            idat.insert(idat.end(), data, data + length);
+        } else if (name == "IEND") {
+            is_ended = true;
+        }
+        pos += 12 + length;
+    }
+
+    vector<uint8_t> filtered;
+    vector<int> types;
+    if (!Inflate(idat, filtered, types)) {
+        cout << "IDAT can't be decoded" << endl;
+        return false;
+    }
+    const int channels = color_type == 6 ? 4 : (color_type == 2 ? 3 : 1);
+    const int bpp = channels * bit_depth / 8;
+    const size_t row_size = static_cast<size_t>(width) * bpp;
+    if (filtered.size() != (row_size + 1) * height) {
+        return false;
+    }
+    rows.assign(row_size * height, 0);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = filtered.data() + y * (row_size + 1);
+        uint8_t* row = rows.data() + y * row_size;
+        const uint8_t* prev = y ? row - row_size : nullptr;
+        for (size_t i = 0; i < row_size; ++i) {
+            const int a = i >= static_cast<size_t>(bpp) ? row[i - bpp] : 0;
+            const int b = prev ? prev[i] : 0;
+            const int c = (prev && i >= static_cast<size_t>(bpp)) ?
+                          prev[i - bpp] : 0;
+            int predicted = 0;
+            switch (src[0]) {
+            case 0:  predicted = 0; break;
+            case 1:  predicted = a; break;
+            case 2:  predicted = b; break;
+            case 3:  predicted = (a + b) / 2; break;
+            case 4:  predicted = Paeth(a, b, c); break;
+            default: return false;
+            }
+            row[i] = static_cast<uint8_t>(src[i + 1] + predicted);
+        }
+    }
+    return true;
+}
+
+// Smooth gradients with noise, so all filters and back references are
+// used. Image is big enough for several segments and groups of them.
+static Image CreateImage(int width, int height) {
+    Random rand(6);
+    Image image(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            image(x, y) = RgbaPixel(
+                static_cast<uint8_t>(x + rand.Next(0, 3)),
+                static_cast<uint8_t>(y),
+                static_cast<uint8_t>((x * y) >> 6),
+                static_cast<uint8_t>(255 - x / 4));
+        }
+    }
+    return image;
+}
+
+static bool CheckPngImage(int bits) {
+    const int width = 500;
+    const int height = 600;
+    const Image image = CreateImage(width, height);
+    const string filename = "deflate_test_" + std::to_string(bits) + ".png";
+    if (!Png::Encode(filename, image, bits, 2)) {
+        return false;
+    }
+
+    int read_width = 0;
+    int read_height = 0;
+    int bit_depth = 0;
+    int color_type = 0;
+    vector<uint8_t> rows;
+    if (!ReadPng(filename, read_width, read_height, bit_depth, color_type,
+                 rows)) {
+        return false;
+    }
+    const int channels = bits / 8;
+    if (read_width != width || read_height != height || bit_depth != 8 ||
+            color_type != (bits == 32 ? 6 : 2)) {
+        return false;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* pixel = rows.data() +
+                                   (static_cast<size_t>(y) * width + x) *
+                                   channels;
+            const RgbaPixel& src = image(x, y);
+            if (pixel[0] != src.red || pixel[1] != src.green ||
+                    pixel[2] != src.blue ||
+                    (channels == 4 && pixel[3] != src.alpha)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool PngRgb() {
+    return CheckPngImage(24);
+}
+
+bool PngRgba() {
+    return CheckPngImage(32);
+}
+
+bool PngGray16() {
+    const int width = 700;
+    const int height = 400;
+    const auto value = [](int x, int y) {
+        return static_cast<uint16_t>((x * 97 + y * 31 + (x ^ y)) & 0xFFFF);
+    };
+    const Png::RowSource source = [&value, width](int y, uint8_t* row) {
+        for (int x = 0; x < width; ++x) {
+            row[x * 2] = static_cast<uint8_t>(value(x, y) >> 8);
+            row[x * 2 + 1] = static_cast<uint8_t>(value(x, y) & 0xFF);
+        }
+    };
+    const string filename = "deflate_test_gray16.png";
+    if (!Png::Encode(filename, width, height, Png::kColorGray, 16, source,
+                     3)) {
+        return false;
+    }
+
+    int read_width = 0;
+    int read_height = 0;
+    int bit_depth = 0;
+    int color_type = 0;
+    vector<uint8_t> rows;
+    if (!ReadPng(filename, read_width, read_height, bit_depth, color_type,
+                 rows) || read_width != width || read_height != height ||
+            bit_depth != 16 || color_type != Png::kColorGray) {
+        return false;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* sample = rows.data() +
+                                    (static_cast<size_t>(y) * width + x) * 2;
+            if (((sample[0] << 8) | sample[1]) != value(x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+typedef bool(*TestFuncPtr)();
+
+const std::map<string, TestFuncPtr> kTests = {
+    {"deflate-stored", DeflateStored},
+    {"deflate-fixed", DeflateFixed},
+    {"deflate-dynamic", DeflateDynamic},
+    {"deflate-empty", DeflateEmpty},
+    {"deflate-segments", DeflateSegments},
+    {"deflate-adler", DeflateAdler},
+    {"png-crc", PngCrc},
+    {"png-rgb", PngRgb},
+    {"png-rgba", PngRgba},
+    {"png-gray16", PngGray16}
+};
+
+int main(int argc, const char **argv) {
+    if (argc != 2) {
+        std::cout << "No command line arguements" << std::endl;
+        return -1;
+    }
+
+    string test_name = argv[1];
+    auto test_func = kTests.find(test_name);
+    if (test_func == kTests.end()) {
+        return -1;
+    } else {
+        if (test_func->second()) {
+            std::cout << "Passed test \"" << test_name << "\"" << std::endl;
+            return 0;
+        } else {
+            std::cout << "Not passed test \"" << test_name << "\"" << std::endl;
+            return -1;
+        }
+    }
+}
@@ -0,0 +1,553 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/array2d.h"
+#include "utils/bmp.h"
+#include "utils/image.h"
+#include "utils/io_executor.h"
+#include "utils/random.h"
+#include "utils/rle_map.h"
+#include "utils/texture_atlas.h"
+#include "utils/write_queue.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using prowogene::utils::Array2D;
+using prowogene::utils::AtlasLayout;
+using prowogene::utils::AtlasReader;
+using prowogene::utils::AtlasWriter;
+using prowogene::utils::Bmp;
+using prowogene::utils::Image;
+using prowogene::utils::IOExecutor;
+using prowogene::utils::Random;
+using prowogene::utils::RgbaPixel;
+using prowogene::utils::RleMap;
+using prowogene::utils::TextureAtlas;
+using prowogene::utils::WriteQueue;
+
+static vector<RgbaPixel> CreatePalette(int size) {
+    vector<RgbaPixel> palette;
+    for (int i = 0; i < size; ++i) {
+        palette.push_back(RgbaPixel(static_cast<uint8_t>(i * 7),
+                                    static_cast<uint8_t>(255 - i),
+                                    static_cast<uint8_t>(i * 13 + 5), 255));
+    }
+    return palette;
+}
+
+// Indices with long runs crossing rows and short runs of noise.
+static vector<uint8_t> CreateIndices(int width, int height,
+                                     int colors_count) {
+    Random rand(1);
+    vector<uint8_t> indices(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (i < indices.size() / 2) {
+            indices[i] = static_cast<uint8_t>(i / 70000 % colors_count);
+        } else {
+            indices[i] = static_cast<uint8_t>(rand.Next(0, 3) ?
+                indices[i - 1] : rand.Next(0, colors_count - 1));
+        }
+    }
+    return indices;
+}
+
+static bool IsSameColor(const RgbaPixel& a, const RgbaPixel& b) {
+    return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+
+static bool IsSameImage(const Image& a, const Image& b, bool use_alpha) {
+    if (a.Width() != b.Width() || a.Height() != b.Height()) {
+        return false;
+    }
+    for (int y = 0; y < a.Height(); ++y) {
+        for (int x = 0; x < a.Width(); ++x) {
+            if (!IsSameColor(a(x, y), b(x, y)) ||
+                    (use_alpha && a(x, y).alpha != b(x, y).alpha)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool Truncate(const string& src, const string& dst, size_t size) {
+    std::ifstream in(src, std::ios::binary);
+    vector<char> data(size);
+    in.read(data.data(), size);
+    if (in.gcount() != static_cast<std::streamsize>(size)) {
+        return false;
+    }
+    std::ofstream out(dst, std::ios::binary);
+    out.write(data.data(), size);
+    return !out.fail();
+}
+
+
+bool RleMapRoundTrip() {
+    // Long rows make runs longer than kMaxRunLength.
+    const int width = 500;
+    const int height = 420;
+    const vector<RgbaPixel> palette = CreatePalette(200);
+    const vector<uint8_t> indices = CreateIndices(width, height, 200);
+    const string filename = "io_test.rle";
+    if (!RleMap::Encode(filename, indices.data(), width, height, palette)) {
+        return false;
+    }
+
+    Array2D<uint8_t> decoded;
+    vector<RgbaPixel> decoded_palette;
+    if (!RleMap::Decode(filename, decoded, decoded_palette)) {
+        return false;
+    }
+    if (decoded.Width() != width || decoded.Height() != height ||
+            decoded_palette.size() != palette.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < palette.size(); ++i) {
+        if (!IsSameColor(palette[i], decoded_palette[i]) ||
+                palette[i].alpha != decoded_palette[i].alpha) {
+            return false;
+        }
+    }
+    return std::equal(indices.begin(), indices.end(), decoded.Data());
+}
+
+bool RleMapBroken() {
+    const int width = 64;
+    const int height = 48;
+    const vector<RgbaPixel> palette = CreatePalette(16);
+    const vector<uint8_t> indices = CreateIndices(width, height, 16);
+    const string filename = "io_test_broken.rle";
+    if (!RleMap::Encode(filename, indices.data(), width, height, palette)) {
+        return false;
+    }
+
+    Array2D<uint8_t> decoded(3, 2, 7);
+    vector<RgbaPixel> decoded_palette(1);
+    for (size_t size : { size_t(10), size_t(20 + 16 * 4 - 1),
+                         size_t(20 + 16 * 4 + 5) }) {
+        const string cut = "io_test_cut.rle";
+        if (!Truncate(filename, cut, size)) {
+            return false;
+        }
+        if (RleMap::Decode(cut, decoded, decoded_palette)) {
+            cout << "Truncated map of " << size << " bytes is decoded" << endl;
+            return false;
+        }
+    }
+    // Outputs aren't changed on failure.
+    return decoded.Width() == 3 && decoded.Height() == 2 &&
+           decoded(0, 0) == 7 && decoded_palette.size() == 1;
+}
+
+bool BmpIndexedRoundTrip() {
+    // Width isn't multiple of 4, so rows are padded.
+    const int width = 37;
+    const int height = 23;
+    const vector<RgbaPixel> palette = CreatePalette(41);
+    const vector<uint8_t> indices = CreateIndices(width, height, 41);
+    const string filename = "io_test_indexed.bmp";
+    if (!Bmp::EncodeIndexed(filename, indices.data(), width, height,
+                            palette)) {
+        return false;
+    }
+
+    Image decoded;
+    if (!Bmp::Decode(filename, decoded)) {
+        return false;
+    }
+    if (decoded.Width() != width || decoded.Height() != height) {
+        return false;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t index = indices[static_cast<size_t>(y) * width + x];
+            if (!IsSameColor(decoded(x, y), palette[index])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Encode image by Bmp::Encode, decode it and check pixels.
+static bool CheckBmpRoundTrip(int bits, int width, int height) {
+    Random rand(bits + width);
+    Image image(width, height);
+    for (auto& pixel : image) {
+        pixel = RgbaPixel(static_cast<uint8_t>(rand.Next()),
+                          static_cast<uint8_t>(rand.Next()),
+                          static_cast<uint8_t>(rand.Next()),
+                          static_cast<uint8_t>(rand.Next()));
+    }
+    const string filename = "io_test_" + std::to_string(bits) + "_" +
+                            std::to_string(width) + ".bmp";
+    if (!Bmp::Encode(filename, image, bits)) {
+        return false;
+    }
+
+    Image decoded;
+    if (!Bmp::Decode(filename, decoded)) {
+        cout << bits << " bit BMP can't be decoded" << endl;
+        return false;
+    }
+    return IsSameImage(image, decoded, bits == 32);
+}
+
+bool Bmp24RoundTrip() {
+    // Odd widths need row padding, big image is written by several blocks.
+    if (!CheckBmpRoundTrip(24, 37, 23) || !CheckBmpRoundTrip(24, 1, 1) ||
+            !CheckBmpRoundTrip(24, 701, 600)) {
+        return false;
+    }
+    // Pixel data must fit in file.
+    const string cut = "io_test_cut.bmp";
+    Image decoded;
+    return Truncate("io_test_24_37.bmp", cut, 54 + 112 * 22) &&
+           !Bmp::Decode(cut, decoded);
+}
+
+bool Bmp32RoundTrip() {
+    return CheckBmpRoundTrip(32, 37, 23) && CheckBmpRoundTrip(32, 1, 1) &&
+           CheckBmpRoundTrip(32, 600, 500);
+}
+
+static Image CreateTile(int side, int seed) {
+    Random rand(seed);
+    Image tile(side, side);
+    for (auto& pixel : tile) {
+        pixel = RgbaPixel(static_cast<uint8_t>(rand.Next()),
+                          static_cast<uint8_t>(rand.Next()),
+                          static_cast<uint8_t>(rand.Next()),
+                          static_cast<uint8_t>(rand.Next()));
+    }
+    return tile;
+}
+
+static bool CheckAtlas(int channels) {
+    AtlasLayout layout;
+    layout.count_x = 3;
+    layout.count_y = 2;
+    layout.tile_size = 20;
+    layout.levels = 3;
+    layout.layers = 2;
+    layout.channels = channels;
+    const string filename = "io_test_" + std::to_string(channels) +
+                            TextureAtlas::kExtension;
+
+    // Every third tile is skipped, others are written by several threads.
+    std::map<int64_t, Image> tiles;
+    AtlasWriter writer;
+    if (!writer.Open(filename, layout)) {
+        return false;
+    }
+    std::atomic<bool> is_written(true);
+    vector<std::thread> threads;
+    for (int layer = 0; layer < layout.layers; ++layer) {
+        for (int level = 0; level < layout.levels; ++level) {
+            const int side = TextureAtlas::GetLevelSize(layout, level);
+            for (int y = 0; y < layout.count_y; ++y) {
+                for (int x = 0; x < layout.count_x; ++x) {
+                    const int64_t index = TextureAtlas::GetEntryIndex(
+                        layout, layer, x, y, level);
+                    if (index % 3 == 1) {
+                        continue;
+                    }
+                    tiles[index] = CreateTile(side, static_cast<int>(index));
+                }
+            }
+        }
+    }
+    for (int layer = 0; layer < layout.layers; ++layer) {
+        threads.push_back(std::thread([&, layer]() {
+            for (int level = 0; level < layout.levels; ++level) {
+                for (int y = 0; y < layout.count_y; ++y) {
+                    for (int x = 0; x < layout.count_x; ++x) {
+                        auto tile = tiles.find(TextureAtlas::GetEntryIndex(
+                            layout, layer, x, y, level));
+                        if (tile != tiles.end() &&
+                                !writer.Write(tile->second, layer, x, y,
+                                              level)) {
+                            is_written = false;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    // Tile of wrong size and tile out of layout are rejected.
+    if (!is_written || writer.Write(CreateTile(7, 0), 0, 0, 0, 0) ||
+            writer.Write(tiles.begin()->second, 0, layout.count_x, 0, 0)) {
+        return false;
+    }
+    if (!writer.Close() || writer.Close()) {
+        return false;
+    }
+
+    AtlasReader reader;
+    if (!reader.Open(filename)) {
+        return false;
+    }
+    const AtlasLayout& read = reader.Layout();
+    if (read.count_x != layout.count_x || read.count_y != layout.count_y ||
+            read.tile_size != layout.tile_size ||
+            read.levels != layout.levels || read.layers != layout.layers ||
+            read.channels != layout.channels) {
+        return false;
+    }
+    for (int layer = 0; layer < layout.layers; ++layer) {
+        for (int level = 0; level < layout.levels; ++level) {
+            for (int y = 0; y < layout.count_y; ++y) {
+                for (int x = 0; x < layout.count_x; ++x) {
+                    auto tile = tiles.find(TextureAtlas::GetEntryIndex(
+                        layout, layer, x, y, level));
+                    Image decoded;
+                    const bool is_read = reader.ReadTile(layer, x, y, level,
+                                                         decoded);
+                    if (tile == tiles.end()) {
+                        if (is_read ||
+                                reader.TileData(layer, x, y, level)) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    if (!is_read ||
+                            !IsSameImage(tile->second, decoded,
+                                        channels == 4)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    reader.Close();
+
+    // Atlas without complete offset table is rejected.
+    const string cut = "io_test_cut_" + std::to_string(channels) +
+                       TextureAtlas::kExtension;
+    if (!Truncate(filename, cut, TextureAtlas::kHeaderSize +
+                                 TextureAtlas::kEntrySize)) {
+        return false;
+    }
+    return !reader.Open(cut);
+}
+
+bool AtlasRgb() {
+    return CheckAtlas(3);
+}
+
+bool AtlasRgba() {
+    return CheckAtlas(4);
+}
+
+bool WriteQueueBudget() {
+    const size_t budget = 1000;
+    std::atomic<int64_t> bytes_in_flight(0);
+    std::atomic<int64_t> max_bytes(0);
+    std::atomic<int> completed(0);
+    {
+        WriteQueue queue(3, 8, budget);
+        Random rand(2);
+        for (int i = 0; i < 60; ++i) {
+            const int64_t bytes = rand.Next(50, 400);
+            queue.Push([&, bytes]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                bytes_in_flight -= bytes;
+                ++completed;
+            }, static_cast<size_t>(bytes));
+            // Counted after Push, so it never exceeds bytes of tasks that
+            // queue holds, even when task is already completed.
+            const int64_t current = bytes_in_flight += bytes;
+            int64_t prev = max_bytes;
+            while (current > prev &&
+                   !max_bytes.compare_exchange_weak(prev, current)) {
+            }
+        }
+        // Task bigger than budget is accepted when queue is empty.
+        queue.Push([&]() { ++completed; }, budget * 3);
+        queue.Flush();
+        if (completed != 61 || bytes_in_flight != 0) {
+            return false;
+        }
+    }
+    if (max_bytes > static_cast<int64_t>(budget)) {
+        cout << "Bytes in flight " << max_bytes << " exceed budget" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool WriteQueueError() {
+    WriteQueue queue(1, 4);
+    int completed = 0;
+    for (int i = 0; i < 10; ++i) {
+        queue.Push([&completed, i]() {
+            if (i == 3 || i == 6) {
+                throw std::runtime_error("task " + std::to_string(i));
+            }
+            ++completed;
+        });
+    }
+    try {
+        queue.Flush();
+        return false;
+    }
+    catch (const std::runtime_error& e) {
+        // Other tasks are executed anyway, first error is reported.
+        if (string(e.what()) != "task 3" || completed != 8) {
+            return false;
+        }
+    }
+    // Error is reported once.
+    queue.Flush();
+
+    WriteQueue inline_queue(0, 1);
+    try {
+        inline_queue.Push([]() { throw std::runtime_error("inline"); });
+        return false;
+    }
+    catch (const std::runtime_error&) {
+    }
+    return true;
+}
+
+bool IOExecutorResult() {
+    IOExecutor executor;
+    executor.Start(2, 2, 100);
+    vector<std::future<int> > results;
+    for (int i = 0; i < 20; ++i) {
+        results.push_back(executor.Submit([i]() { return i * i; }, 60));
+    }
+    std::atomic<int> calls(0);
+    std::future<void> done = executor.Submit([&calls]() { ++calls; });
+    for (int i = 0; i < 20; ++i) {
+        if (results[i].get() != i * i) {
+            return false;
+        }
+    }
+    done.get();
+    executor.Wait();
+    return calls == 1;
+}
+
+bool IOExecutorError() {
+    IOExecutor executor;
+    executor.Start(2, 4, 0);
+    const int owner = 0;
+    executor.SetOwner(&owner);
+    std::future<bool> failed = executor.Submit([]() -> bool {
+        throw std::runtime_error("write");
+    });
+    executor.SetOwner(nullptr);
+    std::future<bool> succeeded = executor.Submit([]() { return true; });
+
+    // Error is delivered both to its future and to Wait.
+    try {
+        failed.get();
+        return false;
+    }
+    catch (const std::runtime_error& e) {
+        if (string(e.what()) != "write") {
+            return false;
+        }
+    }
+    if (!succeeded.get()) {
+        return false;
+    }
+    const void* error_owner = nullptr;
+    try {
+        executor.Wait(&error_owner);
+        return false;
+    }
+    catch (const std::runtime_error& e) {
+        // Error is reported together with owner of failed task.
+        if (string(e.what()) != "write" || error_owner != &owner) {
+            return false;
+        }
+    }
+    // Wait clears error.
+    executor.Wait();
+    return true;
+}
+
+bool IOExecutorInline() {
+    IOExecutor executor;
+    int calls = 0;
+    std::future<int> result = executor.Submit([&calls]() {
+        return ++calls;
+    });
+    // Task is executed inside Submit call.
+    if (calls != 1 || result.get() != 1) {
+        return false;
+    }
+    try {
+        executor.Submit([]() { throw std::runtime_error("inline"); });
+        return false;
+    }
+    catch (const std::runtime_error&) {
+    }
+    executor.Wait();
+
+    // Restart without threads executes tasks inline again.
+    executor.Start(1, 1, 0);
+    executor.Submit([&calls]() { ++calls; });
+    executor.Start(0, 1, 0);
+    executor.Submit([&calls]() { ++calls; });
+    return calls == 3;
+}
+
+
+typedef bool(*TestFuncPtr)();
+
+const std::map<string, TestFuncPtr> kTests = {
+    {"rle-map", RleMapRoundTrip},
+    {"rle-map-broken", RleMapBroken},
+    {"bmp-indexed", BmpIndexedRoundTrip},
+    {"bmp-24", Bmp24RoundTrip},
+    {"bmp-32", Bmp32RoundTrip},
+    {"atlas-rgb", AtlasRgb},
+    {"atlas-rgba", AtlasRgba},
+    {"write-queue-budget", WriteQueueBudget},
+    {"write-queue-error", WriteQueueError},
+    {"io-executor-result", IOExecutorResult},
+    {"io-executor-error", IOExecutorError},
+    {"io-executor-inline", IOExecutorInline}
+};
+
+int main(int argc, const char **argv) {
+    if (argc != 2) {
+        std::cout << "No command line arguements" << std::endl;
+        return -1;
+    }
+
+    string test_name = argv[1];
+    auto test_func = kTests.find(test_name);
+    if (test_func == kTests.end()) {
+        return -1;
+    } else {
+        if (test_func->second()) {
+            std::cout << "Passed test \"" << test_name << "\"" << std::endl;
+            return 0;
+        } else {
+            std::cout << "Not passed test \"" << test_name << "\"" << std::endl;
+            return -1;
+        }
+    }
+}
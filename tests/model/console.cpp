@@ -0,0 +1,712 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "modules/model.h"
+#include "utils/json.h"
+#include "utils/random.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using prowogene::MeshTopology;
+using prowogene::modules::GeneralSettings;
+using prowogene::modules::ModelModule;
+using prowogene::modules::ModelSettings;
+using prowogene::modules::NamesSettings;
+using prowogene::modules::SystemSettings;
+using prowogene::modules::TextureSettings;
+using prowogene::utils::Array2D;
+using prowogene::utils::InputString;
+using prowogene::utils::JsonArray;
+using prowogene::utils::JsonObject;
+using prowogene::utils::JsonValue;
+using prowogene::utils::Model3d;
+using prowogene::utils::ModelIO;
+using prowogene::utils::ModelIOParams;
+using prowogene::utils::Random;
+using prowogene::utils::TextureCoord;
+using prowogene::utils::Vector3D;
+using prowogene::utils::Vertex;
+
+const int   kSeed = 123;
+const int   kSize = 128;
+const int   kChunkSize = 32;
+const int   kChunkCount = kSize / kChunkSize;
+const float kEps = 0.00001f;
+const float kNormalEps = 0.01f;
+const double kBenchSeconds = 0.2;
+
+/** @brief Model module with access to models creation. */
+class ModelTestModule : public ModelModule {
+ public:
+    using ModelModule::CreateArea;
+    using ModelModule::InitLodErrors;
+    using ModelModule::InitNormals;
+};
+
+/** @brief Model module with all it's settings and data. Output filenames
+start with test name, so tests can be run in parallel. */
+struct ModelTest {
+    ModelTest(const string& test_name, const string& format) {
+        height_map.Resize(kSize, kSize);
+        Random random(kSeed);
+        float phases[4];
+        for (float& phase : phases) {
+            phase = random.Next(0.0f, 6.28f);
+        }
+        for (int y = 0; y < kSize; ++y) {
+            for (int x = 0; x < kSize; ++x) {
+                const float wx = x * 6.28f / kSize;
+                const float wy = y * 6.28f / kSize;
+                height_map(x, y) = 0.5f +
+                    0.2f * std::sin(wx + phases[0]) * std::cos(wy) +
+                    0.1f * std::sin(3 * wx + wy + phases[1]) +
+                    0.05f * std::cos(7 * wy + phases[2]) +
+                    0.02f * std::sin(13 * wx - 11 * wy + phases[3]) +
+                    random.Next(0.0f, 0.01f);
+            }
+        }
+
+        general.seed = kSeed;
+        general.size = kSize;
+        general.chunk_size = kChunkSize;
+        model.chunks_enabled = true;
+        model.uv_enabled = true;
+        model.normals_enabled = true;
+        model.coord_format = "x y z";
+        system.thread_count = 2;
+        system.extensions.model = format;
+        names.chunk.prefix = test_name + "_chunk_";
+        names.minimap.model = test_name + "_minimap_model";
+        module.height_map_ = &height_map;
+        module.model_io_ = &model_io;
+    }
+
+    void Process() {
+        module.ApplySettings(&general);
+        module.ApplySettings(&model);
+        module.ApplySettings(&names);
+        module.ApplySettings(&system);
+        module.ApplySettings(&texture);
+        module.Process();
+        if (model.normals_enabled) {
+            module.InitNormals();
+        }
+    }
+
+    Model3d CreateChunk(int x, int y) {
+        if (model.lod.enabled) {
+            module.InitLodErrors(kChunkSize);
+        }
+        return module.CreateArea(x * kChunkSize, y * kChunkSize, kChunkSize);
+    }
+
+    string ChunkFilename(int x, int y) const {
+        return names.chunk.Apply(x, y, system.extensions.model);
+    }
+
+    Array2D<float>  height_map;
+    ModelIO         model_io;
+    GeneralSettings general;
+    ModelSettings   model;
+    NamesSettings   names;
+    SystemSettings  system;
+    TextureSettings texture;
+    ModelTestModule module;
+};
+
+
+bool ReadFile(const string& filename, vector<uint8_t>& data) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>());
+    return true;
+}
+
+int ObjIndex(const string& token) {
+    return std::stoi(token.substr(0, token.find('/'))) - 1;
+}
+
+bool ReadObj(const string& filename, Model3d& model) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    model = Model3d();
+    string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        string type;
+        stream >> type;
+        if (type == "v") {
+            Vertex vertex;
+            stream >> vertex.x >> vertex.y >> vertex.z;
+            model.vertexes.push_back(vertex);
+        } else if (type == "vt") {
+            TextureCoord uv;
+            stream >> uv.u >> uv.v;
+            model.uv.push_back(uv);
+        } else if (type == "vn") {
+            Vector3D normal;
+            stream >> normal.x >> normal.y >> normal.z;
+            model.normals.push_back(normal);
+        } else if (type == "f") {
+            string a, b, c;
+            stream >> a >> b >> c;
+            model.indices.push_back(ObjIndex(a));
+            model.indices.push_back(ObjIndex(b));
+            model.indices.push_back(ObjIndex(c));
+        }
+    }
+    return true;
+}
+
+template<typename Type>
+Type GetValue(const vector<uint8_t>& data, size_t offset) {
+    Type value;
+    memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+// Read accessor to floats, integers are normalized when it's needed.
+bool ReadAccessor(JsonObject& json, const vector<uint8_t>& bin, int idx,
+        vector<float>& values) {
+    JsonArray accessors = json["accessors"];
+    JsonArray views = json["bufferViews"];
+    if (idx < 0 || idx >= static_cast<int>(accessors.size())) {
+        return false;
+    }
+    JsonObject accessor = accessors[idx];
+    const int view_idx = accessor["bufferView"];
+    if (view_idx < 0 || view_idx >= static_cast<int>(views.size())) {
+        return false;
+    }
+    JsonObject view = views[view_idx];
+    const string type = accessor["type"];
+    const int components = type == "SCALAR" ? 1 : (type == "VEC2" ? 2 : 3);
+    const int component_type = accessor["componentType"];
+    const bool normalized = accessor["normalized"];
+    const size_t count = static_cast<int>(accessor["count"]);
+    const size_t offset = static_cast<int>(view["byteOffset"]);
+    const size_t component_size = component_type == 5120 ? 1 :
+                                  (component_type == 5123 ? 2 : 4);
+    size_t stride = static_cast<int>(view["byteStride"]);
+    if (!stride) {
+        stride = component_size * components;
+    }
+    if (count && offset + (count - 1) * stride +
+            component_size * components > bin.size()) {
+        return false;
+    }
+
+    values.resize(count * components);
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < components; ++c) {
+            const size_t pos = offset + i * stride + c * component_size;
+            float& value = values[i * components + c];
+            switch (component_type) {
+            case 5120:
+                value = GetValue<int8_t>(bin, pos);
+                value = normalized ? std::max(value / 127.0f, -1.0f) : value;
+                break;
+            case 5123:
+                value = GetValue<uint16_t>(bin, pos);
+                value = normalized ? value / 65535.0f : value;
+                break;
+            case 5125:
+                value = static_cast<float>(GetValue<uint32_t>(bin, pos));
+                break;
+            case 5126:
+                value = GetValue<float>(bin, pos);
+                break;
+            default:
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ReadGlb(const string& filename, Model3d& model) {
+    vector<uint8_t> data;
+    if (!ReadFile(filename, data) || data.size() < 20 ||
+            GetValue<uint32_t>(data, 0) != 0x46546C67 ||
+            GetValue<uint32_t>(data, 8) != data.size()) {
+        return false;
+    }
+    const size_t json_size = GetValue<uint32_t>(data, 12);
+    const size_t bin_offset = 20 + json_size + 8;
+    if (bin_offset > data.size()) {
+        return false;
+    }
+    JsonValue json_value;
+    json_value.Parse(string(data.begin() + 20,
+                            data.begin() + 20 + json_size),
+                     InputString::DATA);
+    JsonObject json = json_value;
+    const vector<uint8_t> bin(data.begin() + bin_offset, data.end());
+
+    model = Model3d();
+    JsonObject mesh = static_cast<JsonArray>(json["meshes"])[0];
+    JsonObject primitive = static_cast<JsonArray>(mesh["primitives"])[0];
+    JsonObject attributes = primitive["attributes"];
+    JsonObject node = static_cast<JsonArray>(json["nodes"])[0];
+    vector<float> values;
+    if (!ReadAccessor(json, bin, attributes["POSITION"], values)) {
+        return false;
+    }
+    const JsonArray scale = node["scale"];
+    const JsonArray translation = node["translation"];
+    for (size_t i = 0; i < values.size() / 3; ++i) {
+        float coords[3];
+        for (int c = 0; c < 3; ++c) {
+            coords[c] = values[i * 3 + c];
+            if (scale.size() == 3 && translation.size() == 3) {
+                coords[c] = coords[c] * static_cast<float>(scale[c]) +
+                            static_cast<float>(translation[c]);
+            }
+        }
+        model.vertexes.push_back({ coords[0], coords[1], coords[2] });
+    }
+    if (attributes.count("NORMAL") &&
+            ReadAccessor(json, bin, attributes["NORMAL"], values)) {
+        for (size_t i = 0; i < values.size() / 3; ++i) {
+            Vector3D normal;
+            normal.x = values[i * 3];
+            normal.y = values[i * 3 + 1];
+            normal.z = values[i * 3 + 2];
+            model.normals.push_back(normal);
+        }
+    }
+    if (attributes.count("TEXCOORD_0") &&
+            ReadAccessor(json, bin, attributes["TEXCOORD_0"], values)) {
+        for (size_t i = 0; i < values.size() / 2; ++i) {
+            model.uv.push_back({ values[i * 2], 1.0f - values[i * 2 + 1] });
+        }
+    }
+    if (!ReadAccessor(json, bin, primitive["indices"], values)) {
+        return false;
+    }
+    for (float index : values) {
+        model.indices.push_back(static_cast<uint32_t>(index));
+    }
+    return true;
+}
+
+bool ReadModel(const string& filename, Model3d& model) {
+    const string ext = filename.substr(filename.rfind('.') + 1);
+    if (ext == "obj") {
+        return ReadObj(filename, model);
+    } else if (ext == "glb") {
+        return ReadGlb(filename, model);
+    }
+    return false;
+}
+
+bool IsNear(float a, float b, float eps) {
+    return std::fabs(a - b) <= eps * std::max(1.0f, std::fabs(a));
+}
+
+bool IsNearNormal(const Vector3D& a, const Vector3D& b) {
+    const float len_a = std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+    const float len_b = std::sqrt(b.x * b.x + b.y * b.y + b.z * b.z);
+    if (len_a <= 0.0f || len_b <= 0.0f) {
+        return len_a == len_b;
+    }
+    return std::fabs(a.x / len_a - b.x / len_b) <= kNormalEps &&
+           std::fabs(a.y / len_a - b.y / len_b) <= kNormalEps &&
+           std::fabs(a.z / len_a - b.z / len_b) <= kNormalEps;
+}
+
+// Read model must have the same vertexes, attributes and triangles.
+bool CompareModels(const Model3d& expected, const Model3d& actual,
+        float eps) {
+    const size_t count = expected.vertexes.size();
+    if (actual.vertexes.size() != count || actual.uv.size() != count ||
+            actual.normals.size() != count) {
+        cout << "Wrong vertexes count" << endl;
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const Vertex& a = expected.vertexes[i];
+        const Vertex& b = actual.vertexes[i];
+        if (!IsNear(a.x, b.x, eps) || !IsNear(a.y, b.y, eps) ||
+                !IsNear(a.z, b.z, eps)) {
+            cout << "Wrong vertex " << i << endl;
+            return false;
+        }
+        if (!IsNear(expected.uv[i].u, actual.uv[i].u, eps) ||
+                !IsNear(expected.uv[i].v, actual.uv[i].v, eps)) {
+            cout << "Wrong UV " << i << endl;
+            return false;
+        }
+        if (!IsNearNormal(expected.normals[i], actual.normals[i])) {
+            cout << "Wrong normal " << i << endl;
+            return false;
+        }
+    }
+
+    vector<uint32_t> triangles;
+    expected.ForEachTriangle([&](uint32_t a, uint32_t b, uint32_t c) {
+        triangles.push_back(a);
+        triangles.push_back(b);
+        triangles.push_back(c);
+    });
+    if (triangles != actual.indices) {
+        cout << "Wrong triangles" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Vertexes of common border of neighbour chunks must be the same.
+bool CompareBorders(const Model3d& first, const Model3d& second,
+        bool is_vertical, float eps) {
+    auto get_border = [&](const Model3d& model, bool is_max) {
+        float border = is_max ? -1e30f : 1e30f;
+        for (const auto& vertex : model.vertexes) {
+            const float coord = is_vertical ? vertex.y : vertex.x;
+            border = is_max ? std::max(border, coord)
+                            : std::min(border, coord);
+        }
+        vector<std::pair<Vertex, Vector3D> > points;
+        for (size_t i = 0; i < model.vertexes.size(); ++i) {
+            const Vertex& vertex = model.vertexes[i];
+            const float coord = is_vertical ? vertex.y : vertex.x;
+            if (IsNear(coord, border, eps)) {
+                points.push_back({ vertex, model.normals[i] });
+            }
+        }
+        std::sort(points.begin(), points.end(),
+            [&](const std::pair<Vertex, Vector3D>& a,
+                    const std::pair<Vertex, Vector3D>& b) {
+                return is_vertical ? a.first.x < b.first.x
+                                   : a.first.y < b.first.y;
+            });
+        return points;
+    };
+
+    const auto first_border = get_border(first, true);
+    const auto second_border = get_border(second, false);
+    if (first_border.size() != second_border.size() ||
+            first_border.empty()) {
+        cout << "Different border points count" << endl;
+        return false;
+    }
+    for (size_t i = 0; i < first_border.size(); ++i) {
+        const Vertex& a = first_border[i].first;
+        const Vertex& b = second_border[i].first;
+        if (!IsNear(a.x, b.x, eps) || !IsNear(a.y, b.y, eps) ||
+                !IsNear(a.z, b.z, eps) ||
+                !IsNearNormal(first_border[i].second,
+                              second_border[i].second)) {
+            cout << "Crack between chunks" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CheckChunks(ModelTest& test, float eps) {
+    test.Process();
+    vector<Model3d> chunks(kChunkCount * kChunkCount);
+    for (int x = 0; x < kChunkCount; ++x) {
+        for (int y = 0; y < kChunkCount; ++y) {
+            Model3d& chunk = chunks[x * kChunkCount + y];
+            if (!ReadModel(test.ChunkFilename(x, y), chunk)) {
+                cout << "Can't read " << test.ChunkFilename(x, y) << endl;
+                return false;
+            }
+            if (!CompareModels(test.CreateChunk(x, y), chunk, eps)) {
+                return false;
+            }
+        }
+    }
+
+    for (int x = 0; x < kChunkCount; ++x) {
+        for (int y = 0; y < kChunkCount; ++y) {
+            const Model3d& chunk = chunks[x * kChunkCount + y];
+            if (x + 1 < kChunkCount && !CompareBorders(chunk,
+                    chunks[(x + 1) * kChunkCount + y], false, eps)) {
+                return false;
+            }
+            if (y + 1 < kChunkCount && !CompareBorders(chunk,
+                    chunks[x * kChunkCount + y + 1], true, eps)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ModelObj() {
+    ModelTest test("model-obj", "obj");
+    return CheckChunks(test, kEps);
+}
+
+bool ModelObjStrip() {
+    ModelTest test("model-obj-strip", "obj");
+    test.model.topology = MeshTopology::TriangleStrip;
+    return CheckChunks(test, kEps);
+}
+
+bool ModelObjLod() {
+    ModelTest test("model-obj-lod", "obj");
+    test.model.lod.enabled = true;
+    test.model.lod.max_error = 0.5f;
+    return CheckChunks(test, kEps);
+}
+
+bool ModelGlb() {
+    ModelTest test("model-glb", "glb");
+    return CheckChunks(test, kEps);
+}
+
+bool ModelGlbQuantized() {
+    ModelTest test("model-glb-quantized", "glb");
+    test.model.quantization_enabled = true;
+    return CheckChunks(test, 0.001f);
+}
+
+bool CheckComplexStream(const string& format) {
+    ModelTest test("model-stream-" + format, format);
+    test.model.chunks_enabled = false;
+    test.model.complex_enabled = true;
+    test.model.stream_band_size = 24;
+    test.Process();
+    Model3d complex;
+    if (!ReadModel(test.names.minimap.model + "." + format, complex)) {
+        return false;
+    }
+
+    // Faces of streamed model are written band by band.
+    Model3d expected = test.module.CreateArea(0, 0, kSize);
+    vector<uint32_t> expected_triangles;
+    expected.ForEachTriangle([&](uint32_t a, uint32_t b, uint32_t c) {
+        expected_triangles.insert(expected_triangles.end(), { a, b, c });
+    });
+    auto sort_triangles = [](const vector<uint32_t>& indices) {
+        vector<vector<uint32_t> > list;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            vector<uint32_t> triangle(indices.begin() + i,
+                                      indices.begin() + i + 3);
+            std::rotate(triangle.begin(),
+                        std::min_element(triangle.begin(), triangle.end()),
+                        triangle.end());
+            list.push_back(triangle);
+        }
+        std::sort(list.begin(), list.end());
+        return list;
+    };
+    if (sort_triangles(complex.indices) !=
+            sort_triangles(expected_triangles)) {
+        cout << "Wrong triangles" << endl;
+        return false;
+    }
+    complex.indices = expected_triangles;
+    return CompareModels(expected, complex, kEps);
+}
+
+bool ModelStreamObj() {
+    return CheckComplexStream("obj");
+}
+
+bool ModelStreamGlb() {
+    return CheckComplexStream("glb");
+}
+
+// UV are counted from map origin by default and from chunk texture corner
+// when local UV are used.
+bool ModelUV() {
+    for (bool is_local : { false, true }) {
+        ModelTest test(is_local ? "model-uv-local" : "model-uv", "obj");
+        test.model.chunks_enabled = false;
+        test.model.uv_local = is_local;
+        test.Process();
+        const Model3d chunk = test.CreateChunk(1, 2);
+        const float left = is_local ? 0.0f : 1.0f;
+        const float top = is_local ? 0.0f : 2.0f;
+        for (size_t i = 0; i < chunk.vertexes.size(); ++i) {
+            const int x = static_cast<int>(i) / (kChunkSize + 1);
+            const int y = static_cast<int>(i) % (kChunkSize + 1);
+            const float u = left + static_cast<float>(x) / kChunkSize;
+            const float v = 1.0f - top - static_cast<float>(y) / kChunkSize;
+            if (!IsNear(chunk.uv[i].u, u, kEps) ||
+                    !IsNear(chunk.uv[i].v, v, kEps)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Normals are unit length and don't depend on packing.
+bool ModelNormals() {
+    ModelTest plain("model-normals", "obj");
+    plain.model.chunks_enabled = false;
+    plain.Process();
+    ModelTest packed("model-normals-packed", "obj");
+    packed.model.chunks_enabled = false;
+    packed.model.normals_packed = true;
+    packed.Process();
+    const Model3d a = plain.CreateChunk(1, 2);
+    const Model3d b = packed.CreateChunk(1, 2);
+    if (a.normals.empty() || a.normals.size() != b.normals.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.normals.size(); ++i) {
+        const Vector3D& n = a.normals[i];
+        const Vector3D& m = b.normals[i];
+        const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (std::fabs(length - 1.0f) > kEps ||
+                std::fabs(n.x - m.x) > kNormalEps ||
+                std::fabs(n.y - m.y) > kNormalEps ||
+                std::fabs(n.z - m.z) > kNormalEps) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ModelHeightfield() {
+    ModelTest test("model-heightfield", "obj");
+    test.model.chunks_enabled = false;
+    test.model.heightfield.enabled = true;
+    test.model.heightfield.overlap = true;
+    // Levels of detail are used by chunk models only.
+    test.model.levels.count = 6;
+    test.Process();
+    for (int x = 0; x < kChunkCount; ++x) {
+        for (int y = 0; y < kChunkCount; ++y) {
+            vector<uint8_t> data;
+            if (!ReadFile(test.names.chunk.Apply(x, y, "hf"), data) ||
+                    data.size() < 32) {
+                return false;
+            }
+            const uint32_t width = GetValue<uint32_t>(data, 8);
+            const uint32_t height = GetValue<uint32_t>(data, 12);
+            const float height_scale = GetValue<float>(data, 28);
+            if (width != kChunkSize + 1 || height != kChunkSize + 1 ||
+                    data.size() != 32 + width * height * 2 ||
+                    height_scale != test.model.map_height) {
+                cout << "Wrong heightfield header" << endl;
+                return false;
+            }
+            for (uint32_t j = 0; j < height; ++j) {
+                for (uint32_t i = 0; i < width; ++i) {
+                    const size_t pos = 32 + (j * width + i) * 2;
+                    const float value =
+                        GetValue<uint16_t>(data, pos) / 65535.0f;
+                    const int map_x = (x * kChunkSize + i) % kSize;
+                    const int map_y = (y * kChunkSize + j) % kSize;
+                    if (std::fabs(value - test.height_map(map_x, map_y)) >
+                            1.0f / 65535.0f) {
+                        cout << "Wrong heightfield sample" << endl;
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Measure models saving speed, files are written to current directory.
+bool BenchFormat(const string& name, const string& format, bool quantize) {
+    const string test_name = "model-bench-" + format +
+                             (quantize ? "-quantized" : "");
+    ModelTest test(test_name, format);
+    test.Process();
+    vector<Model3d> chunks;
+    size_t triangles = 0;
+    for (int x = 0; x < kChunkCount; ++x) {
+        for (int y = 0; y < kChunkCount; ++y) {
+            chunks.push_back(test.CreateChunk(x, y));
+            triangles += chunks.back().TrianglesCount();
+        }
+    }
+
+    ModelIOParams params;
+    params.format = format;
+    params.add_normals = true;
+    params.add_uv = true;
+    params.quantize = quantize;
+    params.filename = test_name;
+    size_t bytes = 0;
+    size_t total_triangles = 0;
+    double seconds = 0.0;
+    while (seconds < kBenchSeconds) {
+        for (const auto& chunk : chunks) {
+            const auto start = std::chrono::steady_clock::now();
+            test.model_io.Save(chunk, params);
+            const auto end = std::chrono::steady_clock::now();
+            seconds += std::chrono::duration<double>(end - start).count();
+            std::ifstream file(params.filename + "." + format,
+                               std::ios::binary | std::ios::ate);
+            bytes += static_cast<size_t>(file.tellg());
+        }
+        total_triangles += triangles;
+    }
+    cout << name << ": " << bytes / seconds / 1048576.0 << " MB/s, " <<
+        total_triangles / seconds << " triangles/s" << endl;
+    return bytes > 0;
+}
+
+bool ModelBench() {
+    return BenchFormat("obj", "obj", false) &&
+           BenchFormat("glb", "glb", false) &&
+           BenchFormat("glb quantized", "glb", true);
+}
+
+typedef bool (*TestFuncPtr)();
+const std::map<string, TestFuncPtr> kTests = {
+    {"model-obj", ModelObj},
+    {"model-obj-strip", ModelObjStrip},
+    {"model-obj-lod", ModelObjLod},
+    {"model-glb", ModelGlb},
+    {"model-glb-quantized", ModelGlbQuantized},
+    {"model-stream-obj", ModelStreamObj},
+    {"model-stream-glb", ModelStreamGlb},
+    {"model-uv", ModelUV},
+    {"model-normals", ModelNormals},
+    {"model-heightfield", ModelHeightfield},
+    {"model-bench", ModelBench}
+};
+
+int main(int argc, const char **argv) {
+    if (argc != 2) {
+        std::cout << "No command line arguements" << std::endl;
+        return -1;
+    }
+
+    string test_name = argv[1];
+    auto test_func = kTests.find(test_name);
+    if (test_func == kTests.end()) {
+        return -1;
+    } else {
+        if (test_func->second()) {
+            std::cout << "Passed test \"" << test_name << "\"" << std::endl;
+            return 0;
+        } else {
+            std::cout << "Not passed test \"" << test_name << "\"" << std::endl;
+            return -1;
+        }
+    }
+}
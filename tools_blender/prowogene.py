@@ -4,6 +4,7 @@ import enum
 import json
 import os
 import pathlib
+import struct
 import subprocess
 
 
@@ -32,6 +33,9 @@ class ItemInfo:
         model: Path to the model file.
         texture: Path to the texture file.
         normal: Path to the normal map file.
+        atlas: Path to the texture atlas with texture and normal map.
+        tile_x: X index of texture and normal map tile in atlas.
+        tile_y: Y index of texture and normal map tile in atlas.
         x: X coordinate of object.
         y: Y coordinate of object.
         z: Z coordinate of object.
@@ -40,6 +44,9 @@ class ItemInfo:
     model = ''
     texture = ''
     normal = ''
+    atlas = ''
+    tile_x = 0
+    tile_y = 0
     x = 0.0
     y = 0.0
     z = 0.0
@@ -60,6 +67,116 @@ class ImportInfo:
     objects = []
 
 
+class TextureAtlas:
+    '''Reader of texture atlas with tiles of all chunks.
+
+    Attributes:
+        count_x: Tiles count per X coord.
+        count_y: Tiles count per Y coord.
+        tile_size: Width and height of level 0 tile in pixels.
+        levels: Count of mip levels including level 0.
+        layers: Count of layers, texture is 0 and normal map is 1.
+        channels: Bytes per pixel, 3 for RGB or 4 for RGBA.
+    '''
+    TEXTURE_LAYER = 0
+    NORMAL_LAYER = 1
+
+    __SIGNATURE = b'PWTA'
+    __VERSION = 1
+    __HEADER_FORMAT = '<4s7I'
+    __ENTRY_FORMAT = '<QQ'
+
+    def __init__(self, path):
+        '''Reads atlas header and offset table.
+
+        Args:
+            path: Path to atlas file.
+
+        Raises:
+            ValueError: File is not a texture atlas.
+        '''
+        self.path = path
+        with open(path, 'rb') as atlas_file:
+            header = atlas_file.read(struct.calcsize(self.__HEADER_FORMAT))
+            if len(header) != struct.calcsize(self.__HEADER_FORMAT):
+                raise ValueError('Texture atlas header is broken')
+            (signature, version, self.count_x, self.count_y, self.tile_size,
+             self.levels, self.layers,
+             self.channels) = struct.unpack(self.__HEADER_FORMAT, header)
+            if signature != self.__SIGNATURE or version != self.__VERSION:
+                raise ValueError('Unknown texture atlas format')
+            count = self.layers * self.count_y * self.count_x * self.levels
+            entry_size = struct.calcsize(self.__ENTRY_FORMAT)
+            table = atlas_file.read(count * entry_size)
+            if len(table) != count * entry_size:
+                raise ValueError('Texture atlas offset table is broken')
+        self.entries = list(struct.iter_unpack(self.__ENTRY_FORMAT, table))
+
+    def GetLevelSize(self, level):
+        '''Get tile size for mip level.
+
+        Args:
+            level: Mip level.
+
+        Returns:
+            Width and height of tile in pixels.
+        '''
+        return max(1, self.tile_size >> level)
+
+    def ReadTile(self, layer, x, y, level=0):
+        '''Read raw tile pixels.
+
+        Args:
+            layer: Layer of tile.
+            x: X index of tile.
+            y: Y index of tile.
+            level: Mip level.
+
+        Returns:
+            Bytes with pixel rows from top to bottom or None if tile is absent.
+        '''
+        index = ((layer * self.count_y + y) * self.count_x + x) * self.levels
+        offset, size = self.entries[index + level]
+        if size == 0:
+            return None
+        with open(self.path, 'rb') as atlas_file:
+            atlas_file.seek(offset)
+            return atlas_file.read(size)
+
+    def LoadImage(self, name, layer, x, y, level=0):
+        '''Create Blender image from tile.
+
+        Args:
+            name: Name of new image.
+            layer: Layer of tile.
+            x: X index of tile.
+            y: Y index of tile.
+            level: Mip level.
+
+        Returns:
+            Blender image or None if tile is absent.
+        '''
+        data = self.ReadTile(layer, x, y, level)
+        if data is None:
+            return None
+        side = self.GetLevelSize(level)
+        row_size = side * self.channels
+        pixels = []
+        # Blender image rows go from bottom to top.
+        for row in range(side - 1, -1, -1):
+            row_data = data[row * row_size:(row + 1) * row_size]
+            for pixel in range(side):
+                color = row_data[pixel * self.channels:
+                                 (pixel + 1) * self.channels]
+                alpha = color[3] if self.channels == 4 else 255
+                pixels.extend([color[0] / 255.0, color[1] / 255.0,
+                               color[2] / 255.0, alpha / 255.0])
+        image = bpy.data.images.new(name, side, side,
+                                    alpha=(self.channels == 4))
+        image.pixels = pixels
+        return image
+
+
 class ConfigWorker:
     '''Class for check configs and extract data from them.
 
@@ -175,6 +292,9 @@ class ConfigWorker:
                     len(chunk_config['data']) == 0):
                 print('No chunk data available')
                 return False
+            if not ConfigWorker.FileExistsOrEmpty(
+                    chunk_config.get('atlas', '')):
+                return False
 
             data_list = chunk_config['data']
             data_count = 0
@@ -257,12 +377,17 @@ class ConfigWorker:
             List of ItemInfo objects with both chunks and external models info.
         '''
         objects = []
+        atlas = config.get('atlas', '')
         for chunk_config in config['data']:
             chunk_info = ItemInfo()
             chunk_model = chunk_config['info']
             chunk_info.model = os.path.abspath(chunk_model['model'])
             chunk_info.texture = chunk_model['texture']
             chunk_info.normal = chunk_model['normal']
+            if atlas:
+                chunk_info.atlas = os.path.abspath(atlas)
+                chunk_info.tile_x = chunk_model['x']
+                chunk_info.tile_y = chunk_model['y']
             objects.append(chunk_info)
 
             for item in chunk_config['items']: